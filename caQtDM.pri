@@ -82,6 +82,10 @@ demo_plugin {
 bsread_Plugin {
         message(“bsread_plugin configuration”)
         CONFIG += Define_ControlsysTargetDir Define_Build_objDirs Define_ZMQ_Lib
+        # lz4 for compressed bsread streams (bitshuffle_lz4, lz4)
+        exists($(LZ4INC)/lz4.h) {
+                CONFIG += Define_LZ4_Lib
+        }
         
         unix:!macx:!ios:!android {
                 message(“bsread_plugin configuration unix:!macx:!ios:!android”)
@@ -773,6 +777,22 @@ Define_ZMQ_Lib{
 	}
 }
 
+Define_LZ4_Lib{
+        message("bsread_plugin with lz4 decompression")
+        DEFINES += BSREAD_LZ4
+        INCLUDEPATH += $$(LZ4INC)
+
+        unix:!macx {
+                 LIBS += -L$$(LZ4LIB) -Wl,-rpath,$$(LZ4LIB) -llz4
+	}
+        macx {
+                LIBS += $$(LZ4LIB)/liblz4.dylib
+        }
+        win32 {
+                LIBS += $$(LZ4LIB)/liblz4.lib
+	}
+}
+
 Define_Build_Python {
      PYTHONCALC: {
         warning("for image and visibility calculation, python will be build in")
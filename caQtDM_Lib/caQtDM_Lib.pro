@@ -56,7 +56,10 @@ SOURCES += caqtdm_lib.cpp \
     limitsDialog.cpp \
     sliderDialog.cpp \
     splashscreen.cpp \
-    loadPlugins.cpp
+    loadPlugins.cpp \
+    macroTemplate.cpp \
+    frameScheduler.cpp \
+    alarmTree.cpp
     
 HEADERS += caqtdm_lib.h\
         caQtDM_Lib_global.h \
@@ -78,8 +81,17 @@ HEADERS += caqtdm_lib.h\
     epicsExternals.h \
     inlines.h \
     loadPlugins.h \
+    macroTemplate.h \
+    frameScheduler.h \
+    alarmTree.h \
     caqtdm_lib_interface.h
 
+# MEDM adl files are converted in memory with the adl2ui parser
+VPATH += ../caQtDM_Viewer/parser
+INCLUDEPATH += ../caQtDM_Viewer/parser
+SOURCES += myParser.cpp XmlWriter.cpp parser.c QtProperties.c dmsearchfile.cpp
+HEADERS += myParser.h XmlWriter.h parser.h QtProperties.h dmsearchfile.h
+
 !MOBILE {
     SOURCES += myQProcess.cpp  processWindow.cpp
     HEADERS += myQProcess.h  processWindow.h
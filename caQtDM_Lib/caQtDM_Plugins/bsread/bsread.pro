@@ -15,6 +15,8 @@ INCLUDEPATH    += ../
 INCLUDEPATH    += ../../src
 HEADERS         = bsread_Plugin.h ../controlsinterface.h \
     bsread_decode.h \
+    bsread_poller.h \
+    bsread_decompress.h \
     bsread_channeldata.h \
     bsread_dispatchercontrol.h \
     bsread_wfhandling.h \
@@ -24,6 +26,8 @@ HEADERS         = bsread_Plugin.h ../controlsinterface.h \
     bsread_internalchannel.h
 SOURCES         = bsread_Plugin.cpp md5.cc \
     bsread_decode.cpp \
+    bsread_poller.cpp \
+    bsread_decompress.cpp \
     bsread_channeldata.cpp \
     bsread_dispatchercontrol.cpp \
     bsread_wfhandling.cpp \
@@ -53,6 +53,9 @@ bsreadPlugin::bsreadPlugin()
     zmqcontex = NULL;
     // INIT ZMQ Layer
     zmqcontex = zmq_ctx_new();
+    // one thread polls all bsread streams
+    PollerThread=new QThread(this);
+    Poller=new bsread_Poller(zmqcontex);
     connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(closeEvent()));
 
 }
@@ -83,12 +86,14 @@ void bsreadPlugin::updateInterface()
                 newValue = i.value();
                 break;
             }
-            // update some data
+            // update some data, in place changes are enclosed for the snapshots of the knobs
+            mutexknobdataP->BeginMutexKnobDataWrite(index);
             kData->edata.rvalue = newValue;
             kData->edata.fieldtype = caDOUBLE;
             kData->edata.connected = true;
             kData->edata.accessR = kData->edata.accessW = true;
             kData->edata.monitorCount++;
+            mutexknobdataP->EndMutexKnobDataWrite(index);
             mutexknobdataP->SetMutexKnobData(kData->index, *kData);
             mutexknobdataP->SetMutexKnobDataReceived(kData);
         }
@@ -116,6 +121,13 @@ int bsreadPlugin::initCommunicationLayer(MutexKnobData *data, MessageWindow *mes
 
 
     initValue = 0.0;
+
+    Poller->moveToThread(PollerThread);
+    connect(PollerThread, SIGNAL(started()), Poller, SLOT(process()));
+    // quit is thread safe, a queued call would wait for the main thread
+    connect(Poller, SIGNAL(finished()), PollerThread, SLOT(quit()), Qt::DirectConnection);
+    PollerThread->start();
+
     QString DispacherConfig = (QString)  qgetenv("BSREAD_DISPATCHER");
     if (DispacherConfig.length()>0){
         if (Dispatcher){
@@ -125,6 +137,7 @@ int bsreadPlugin::initCommunicationLayer(MutexKnobData *data, MessageWindow *mes
             Dispatcher->setOptions(options);
 
             Dispatcher->setZmqcontex(zmqcontex);
+            Dispatcher->setPoller(Poller);
             Dispatcher->setMutexknobdataP(data);
             if (DispatcherThread){
                 Dispatcher->moveToThread(DispatcherThread);
@@ -152,16 +165,9 @@ int bsreadPlugin::initCommunicationLayer(MutexKnobData *data, MessageWindow *mes
                     bsreadconnections.append(new bsread_Decode(zmqcontex,BSREAD_ZMQ_ADDRS.at(i),ZMQ_CONNECTION_TYPE));
                 else
                     bsreadconnections.append(new bsread_Decode(zmqcontex,BSREAD_ZMQ_ADDRS.at(i)));
-                bsreadThreads.append(new QThread(this));
                 bsreadconnections.last()->setKnobData(mutexknobdataP);
-                bsreadconnections.last()->moveToThread(bsreadThreads.last());
-                connect(bsreadThreads.last(), SIGNAL(started()), bsreadconnections.last(), SLOT(process()));
-                connect(bsreadconnections.last(), SIGNAL(finished()), bsreadThreads.last(), SLOT(quit()));
-                connect(bsreadThreads.last(), SIGNAL(finished()), bsreadThreads.last(), SLOT(deleteLater()));
-                connect(bsreadconnections.last(), SIGNAL(finished()), bsreadconnections.last(), SLOT(deleteLater()));
-                bsreadThreads.last()->start();
+                Poller->addDecoder(bsreadconnections.last());
                 msg="Connection started: ";
-                disconnect(bsreadconnections.last());
                 msg.append(BSREAD_ZMQ_ADDRS.at(i));
                 if(messagewindowP != (MessageWindow *) 0) messagewindowP->postMsgEvent(QtDebugMsg,(char*) msg.toLatin1().constData());
             }
@@ -305,6 +311,14 @@ int bsreadPlugin::pvDisconnect(knobData *kData) {
 }
 
 // flush any io
+// message rate and latency of the streams
+bool bsreadPlugin::pvGetStatistics(QString &statistics)
+{
+    if (!Poller) return false;
+    statistics=Poller->getStatistics();
+    return !statistics.isEmpty();
+}
+
 int bsreadPlugin::FlushIO() {
     //qDebug() << "bsreadPlugin:FlushIO";
     return true;
@@ -332,14 +346,12 @@ void bsreadPlugin::closeEvent(){
         DispatcherThread->wait();
         //qDebug() << "end DispatcherThread ";
     }
-    if (bsreadThreads.count()>0){
-        bsreadconnections.last()->setTerminate();
-        bsreadThreads.last()->exit();
-        bsreadThreads.last()->wait(300);
-        if (bsreadThreads.last()->isRunning()){
-            bsreadThreads.last()->exit();
-            bsreadThreads.last()->wait(3000);
-        }
+    if (PollerThread){
+        // closes the sockets of all remaining streams; the poller and the connections
+        // may only be deleted when the thread is gone
+        Poller->setTerminate();
+        PollerThread->quit();
+        PollerThread->wait();
     }
     if (DispatcherThread){
         delete(DispatcherThread);
@@ -347,6 +359,13 @@ void bsreadPlugin::closeEvent(){
     if (Dispatcher){
         delete(Dispatcher);
     }
+    while (bsreadconnections.count()>0){
+        delete(bsreadconnections.takeFirst());
+    }
+    if (Poller){
+        delete(Poller);
+        Poller=NULL;
+    }
 #if ZMQ_VERSION<ZMQ_MAKE_VERSION(4,2,0)
     if (zmqcontex) zmq_ctx_destroy(zmqcontex);
 #else
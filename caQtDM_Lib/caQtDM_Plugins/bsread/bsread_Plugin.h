@@ -37,6 +37,7 @@
 #include "controlsinterface.h"
 #include "bsread_decode.h"
 #include "bsread_dispatchercontrol.h"
+#include "bsread_poller.h"
 
 class Q_DECL_EXPORT bsreadPlugin : public QObject, ControlsInterface
 {
@@ -65,6 +66,7 @@ public:
     int pvReconnect(knobData *kData);
     int pvDisconnect(knobData *kData);
     int FlushIO();
+    bool pvGetStatistics(QString &statistics);
     int TerminateIO();
 
 private slots:
@@ -87,7 +89,8 @@ private:
     QThread *DispatcherThread;
     bsread_dispatchercontrol *Dispatcher;
     QList<bsread_Decode*> bsreadconnections;
-    QList<QThread*> bsreadThreads;
+    QThread *PollerThread;
+    bsread_Poller *Poller;
 };
 
 #endif
@@ -32,6 +32,7 @@ bsread_channeldata::bsread_channeldata(QObject *parent) : QObject(parent)
     offset=0;
     modulo=1;
     endianess=bs_little;
+    compression=bs_uncompressed;
     bsdata.wf_data=NULL;
     bsdata.wf_data_size=0;
     precision=4;
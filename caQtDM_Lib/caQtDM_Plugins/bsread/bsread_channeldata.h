@@ -27,6 +27,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QByteArray>
 #include <QAtomicInt>
 
 enum bsread_types{
@@ -36,6 +37,10 @@ enum bsread_types{
 enum bsread_endian{
     bs_little,bs_big,bs_other
 };
+
+enum bsread_compression{
+    bs_uncompressed,bs_bitshuffle_lz4,bs_lz4
+};
 typedef struct _bs_data{
    QString bs_string;
    double bs_float64;
@@ -67,6 +72,8 @@ public:
     int precision;
     QString units;
     bsread_endian endianess;
+    bsread_compression compression;
+    QByteArray decompressed;
     double timestamp;
     bs_data bsdata;
 signals:
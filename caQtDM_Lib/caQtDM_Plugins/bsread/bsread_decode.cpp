@@ -37,6 +37,7 @@
 #include "JSONValue.h"
 #include "bsread_channeldata.h"
 #include "bsread_wfhandling.h"
+#include "bsread_decompress.h"
 
 enum Alarms {NO_ALARM=0, MINOR_ALARM, MAJOR_ALARM, INVALID_ALARM, NOTCONNECTED=99};
 
@@ -47,7 +48,21 @@ bsread_Decode::bsread_Decode(void * Context,QString ConnectionPoint)
    StreamConnectionType="push_pull";
    context=Context;
    UpdaterPool=NULL;
-   BlockPool=NULL;
+   BlockPool=new QThreadPool(this);
+   dh_compression=bs_uncompressed;
+   zmqsocket=NULL;
+   bsread_KnobDataP=NULL;
+   terminate=false;
+   running_decode=false;
+   global_timestamp_sec=0;
+   global_timestamp_ns=0;
+   channelcounter=0;
+   monitorBindingValid=false;
+   messageCount=0;
+   latencyCount=0;
+   latencySum=0.0;
+   latencyMax=0.0;
+   statisticsTimer.start();
 }
 bsread_Decode::bsread_Decode(void * Context,QString ConnectionPoint,QString ConnectionType)
 {
@@ -55,7 +70,21 @@ bsread_Decode::bsread_Decode(void * Context,QString ConnectionPoint,QString Conn
    StreamConnectionType=ConnectionType;
    context=Context;
    UpdaterPool=NULL;
-   BlockPool=NULL;
+   BlockPool=new QThreadPool(this);
+   dh_compression=bs_uncompressed;
+   zmqsocket=NULL;
+   bsread_KnobDataP=NULL;
+   terminate=false;
+   running_decode=false;
+   global_timestamp_sec=0;
+   global_timestamp_ns=0;
+   channelcounter=0;
+   monitorBindingValid=false;
+   messageCount=0;
+   latencyCount=0;
+   latencySum=0.0;
+   latencyMax=0.0;
+   statisticsTimer.start();
 }
 
 
@@ -64,9 +93,7 @@ bsread_Decode::bsread_Decode(void * Context,QString ConnectionPoint,QString Conn
 
 bsread_Decode::~bsread_Decode()
 {
-    QMutexLocker locker(&mutex);
     setTerminate();
-    bsread_Delay();
     //delete(UpdaterPool);
     //delete(BlockPool);
 }
@@ -112,132 +139,162 @@ void bsread_Decode::bsread_createConnection(int rc)
 
 }
 
-void bsread_Decode::process()
+// called by the poller thread, the socket is only used from there
+bool bsread_Decode::openConnection()
+{
+    int rc=0;
+    terminate=false;
+    last_hash="This will never be seen";
+
+    //qDebug() << "bsreadDecode: ConnectionPoint :"<< StreamConnectionPoint << StreamConnectionType ;
+    bsread_createConnection(rc);
+    if (!zmqsocket) {
+        printf ("error in zmq_connect: %s(%s)\n", zmq_strerror (errno),StreamConnectionPoint.toLatin1().constData());
+        running_decode=false;
+        return false;
+    }
+    running_decode=true;
+    channelcounter=0;
+    statisticsLocker.lock();
+    statisticsTimer.start();
+    messageCount=0;
+    latencyCount=0;
+    latencySum=0.0;
+    latencyMax=0.0;
+    statisticsLocker.unlock();
+    return true;
+}
+
+void bsread_Decode::closeConnection()
+{
+    if (zmqsocket){
+        bsread_DataTimeOut();
+        zmq_close(zmqsocket);
+        zmqsocket=NULL;
+        emit finished();
+        qDebug() << "bsread ZMQ Receiver terminate";
+    }
+    running_decode=false;
+}
+
+// reads at most maxMessages complete multipart messages without blocking, called when zmq_poll reported data
+void bsread_Decode::receiveMessages(int maxMessages)
 {
     int rc;
     zmq_msg_t msg;
     int64_t more;
-    int64_t notReceivedCounter=0;
-    QString last_hash="This will never be seen";
     size_t more_size = sizeof (more);
     size_t msg_size;
 
-    rc = zmq_msg_init (&msg);
-    terminate=false;
+    if (!zmqsocket) return;
+    zmq_msg_init (&msg);
 
+    for (int count=0; count<maxMessages && !terminate; count++){
+        rc = zmq_msg_recv (&msg,zmqsocket,ZMQ_DONTWAIT);
+        if (rc < 0) break;
 
-    //qDebug() << "bsreadDecode: ConnectionPoint :"<< StreamConnectionPoint << StreamConnectionType ;
-    //qDebug() << "bsreadDecode: start ThreadID" << QThread::currentThreadId();
+        setMainHeader((char*)zmq_msg_data(&msg),zmq_msg_size (&msg));
 
-    bsread_createConnection(rc);
-    if (rc != 0) {
-        printf ("error in zmq_connect: %s(%s)\n", zmq_strerror (errno),StreamConnectionPoint.toLatin1().constData());
-        //qDebug() << "bsreadPlugin: ConnectionPoint faild";
-        running_decode=false;
-    }else{
-        running_decode=true;
-        channelcounter=0;
+        if (main_htype.contains("bsr_m")){
+            zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
+            if (more){
 
-        while (!terminate){
-            rc = zmq_msg_recv (&msg,zmqsocket,ZMQ_DONTWAIT);
-            if (rc > 0) {
-                notReceivedCounter=0;
-                setMainHeader((char*)zmq_msg_data(&msg),zmq_msg_size (&msg));
-
-                if (main_htype.contains("bsr_m")){
+                rc = zmq_msg_recv (&msg,zmqsocket,0);
+                if (rc < 0) {
+                    printf ("error in zmq_recvmsg(Header): %s\n", zmq_strerror (errno));
+                }
+                if (QString::compare(last_hash, hash, Qt::CaseInsensitive)){
+                    if (dh_compression==bs_uncompressed){
+                        setHeader((char*)zmq_msg_data(&msg),zmq_msg_size (&msg));
+                    }else{
+                        QByteArray header;
+                        if (bsread_Decompress::decompress(dh_compression,1,(const char*)zmq_msg_data(&msg),zmq_msg_size (&msg),&header,NULL)){
+                            setHeader(header.data(),(size_t)header.size());
+                        }else{
+                            printf ("bsread: data header decompression failed(%s)\n", StreamConnectionPoint.toLatin1().constData());
+                        }
+                    }
+                    last_hash=hash;
+                }
+                bsread_TransferHeaderData();
+                zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
+                while(more){
+                    rc = zmq_msg_recv (&msg,zmqsocket,0);
+                    if (rc < 0) {
+                        printf ("error in zmq_recvmsg(Data): %s\n", zmq_strerror (errno));
+                    }
+                    msg_size=zmq_msg_size(&msg);
+                    bsread_SetChannelData(zmq_msg_data(&msg),msg_size);
                     zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
-                    if (more){
 
+                    if (more){
                         rc = zmq_msg_recv (&msg,zmqsocket,0);
                         if (rc < 0) {
-                            printf ("error in zmq_recvmsg(Header): %s\n", zmq_strerror (errno));
-                        }
-                        if (QString::compare(last_hash, hash, Qt::CaseInsensitive)){
-                            setHeader((char*)zmq_msg_data(&msg),zmq_msg_size (&msg));
-                            last_hash=hash;
+                            printf ("error in zmq_recvmsg(Timestamp): %s\n", zmq_strerror (errno));
                         }
-                        bsread_TransferHeaderData();
+                        msg_size=zmq_msg_size(&msg);
+                        bsread_SetChannelTimeStamp(zmq_msg_data(&msg));
                         zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
-                        while(more){
-                            rc = zmq_msg_recv (&msg,zmqsocket,0);
-                            if (rc < 0) {
-                                printf ("error in zmq_recvmsg(Data): %s\n", zmq_strerror (errno));
-                            }
-                            msg_size=zmq_msg_size(&msg);
-                            bsread_SetChannelData(zmq_msg_data(&msg),msg_size);
-                            //qDebug() <<msg_size;
-                            zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
-
-                            if (more){
-                                rc = zmq_msg_recv (&msg,zmqsocket,0);
-                                if (rc < 0) {
-                                    printf ("error in zmq_recvmsg(Timestamp): %s\n", zmq_strerror (errno));
-                                }
-                                msg_size=zmq_msg_size(&msg);
-                                bsread_SetChannelTimeStamp(zmq_msg_data(&msg));
-                                zmq_getsockopt (zmqsocket, ZMQ_RCVMORE, &more, &more_size);
-                                //qDebug() <<msg_size;
-                            }
-
-                        }
-                        //qDebug() <<"---------------------------";
-                        bsread_EndofData();
-                    }else{
-                     if (main_htype.contains("bsr_reconnect")){
-                         //StreamConnectionPoint=main_reconnect_adress;
-                         bsread_createConnection(rc);
-                         if (rc != 0) {
-                             printf ("error in bsr_reconnect: %s(%s)\n", zmq_strerror (errno),StreamConnectionPoint.toLatin1().constData());
-                             terminate=true;
-                         }
-
-                     }
-                     if (main_htype.contains("bsr_stop")){
-                        terminate=true;
-                     }
-
-
-
-
-
                     }
 
-
-                }
-            }else{
-                if (terminate){
-                    break;
-                }else{
-                    bsread_Delay();
                 }
-                if (zmq_errno()==EAGAIN){
-                    bsread_Delay();
-                    notReceivedCounter++;
-                    if (notReceivedCounter>200){
-                        //qDebug() << "bsread ZMQ Data Timeout";
-                        //bsread_DataTimeOut();
-                        notReceivedCounter=0;
-                    }
+                bsread_EndofData();
+                bsread_UpdateStatistics();
+            }
+        }else{
+            if (main_htype.contains("bsr_reconnect")){
+                //StreamConnectionPoint=main_reconnect_adress;
+                zmq_close(zmqsocket);
+                zmqsocket=NULL;
+                bsread_createConnection(0);
+                if (!zmqsocket) {
+                    printf ("error in bsr_reconnect: %s(%s)\n", zmq_strerror (errno),StreamConnectionPoint.toLatin1().constData());
+                    terminate=true;
                 }
-
-                //printf ("error in zmq_recvmsg(Main Massage): %s\n", zmq_strerror (errno));
-
+                // the poller has to pick up the new socket
+                break;
+            }
+            if (main_htype.contains("bsr_stop")){
+                terminate=true;
             }
-
         }
+    }
+    zmq_msg_close(&msg);
+}
 
-        bsread_DataTimeOut();
-        zmq_msg_close(&msg);
-        zmq_close(zmqsocket);
-
-
+void bsread_Decode::bsread_UpdateStatistics()
+{
+    qint64 now=QDateTime::currentMSecsSinceEpoch();
+    double latency=(double)now-((double)global_timestamp_sec*1000.0+(double)global_timestamp_ns/1000000.0);
+    QMutexLocker locker(&statisticsLocker);
+    messageCount++;
+    // streams without a global timestamp do not contribute to the latency
+    if (global_timestamp_sec>0 && latency>=0.0){
+        latencySum+=latency;
+        latencyCount++;
+        if (latency>latencyMax) latencyMax=latency;
     }
+}
 
-    emit finished();
-    //qDebug() << "bsreadDecode: finished ThreadID" << QThread::currentThreadId();
-    qDebug() << "bsread ZMQ Receiver terminate";
+// message rate and latency (ms) since the last call
+void bsread_Decode::getStatistics(double *rate, double *avgLatency, double *maxLatency)
+{
+    QMutexLocker locker(&statisticsLocker);
+    qint64 elapsed=statisticsTimer.restart();
+    *rate=(elapsed>0) ? (double)messageCount*1000.0/(double)elapsed : 0.0;
+    *avgLatency=(latencyCount>0) ? latencySum/(double)latencyCount : 0.0;
+    *maxLatency=latencyMax;
+    messageCount=0;
+    latencyCount=0;
+    latencySum=0.0;
+    latencyMax=0.0;
+}
 
+bool bsread_Decode::getTerminate() const
+{
+    return terminate;
 }
+
 QString bsread_Decode::getStreamConnectionPoint() const
 {
     return StreamConnectionPoint;
@@ -249,15 +306,124 @@ size_t bsread_Decode::getMessage_size() const
 }
 QString bsread_Decode::getMainHeader() const
 {
-    return MainHeader;
+    return QString::fromLatin1(MainHeaderRaw.constData(),MainHeaderRaw.size());
+}
+
+// position after "key": in [json,end), or NULL
+static const char *bsread_FindKey(const char *json, const char *end, const char *key)
+{
+    size_t keylen=strlen(key);
+    const char *p=json;
+    while (p+keylen+2<end){
+        p=(const char *) memchr(p,'"',end-p);
+        if (!p || p+keylen+2>=end) return NULL;
+        if (p[keylen+1]=='"' && memcmp(p+1,key,keylen)==0){
+            const char *q=p+keylen+2;
+            while (q<end && (*q==' ' || *q=='\t' || *q=='\n' || *q=='\r')) q++;
+            if (q<end && *q==':'){
+                q++;
+                while (q<end && (*q==' ' || *q=='\t' || *q=='\n' || *q=='\r')) q++;
+                return q;
+            }
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static bool bsread_ReadNumber(const char *p, const char *end, double *value)
+{
+    char buffer[40];
+    char *stop;
+    int len=0;
+    if (!p) return false;
+    while (p+len<end && len<(int)sizeof(buffer)-1 && strchr("0123456789+-.eE",p[len])) len++;
+    if (len==0) return false;
+    memcpy(buffer,p,len);
+    buffer[len]='\0';
+    *value=strtod(buffer,&stop);
+    return stop!=buffer;
+}
+
+static bool bsread_ReadString(const char *p, const char *end, const char **value, int *len)
+{
+    const char *q;
+    if (!p || p>=end || *p!='"') return false;
+    for (q=p+1;q<end && *q!='"';q++){
+        if (*q=='\\') return false;  // escaped strings are left to the json parser
+    }
+    if (q>=end) return false;
+    *value=p+1;
+    *len=(int)(q-p-1);
+    return true;
+}
+
+/*
+ * the main header comes with every message and only carries a few fixed keys,
+ * so they are picked directly from the raw buffer instead of running the json parser.
+ * hash and htype are only converted to QString when they change.
+ */
+bool bsread_Decode::bsread_ParseMainHeaderFast(const char *value, size_t size)
+{
+    const char *end=value+size;
+    const char *str, *object, *objectEnd;
+    int len;
+    double number;
+
+    if (!bsread_ReadString(bsread_FindKey(value,end,"htype"),end,&str,&len)) return false;
+    if (len!=htypeRaw.size() || memcmp(str,htypeRaw.constData(),len)!=0){
+        htypeRaw=QByteArray(str,len);
+        main_htype=QString::fromLatin1(str,len);
+    }
+    // control messages like bsr_reconnect or bsr_stop carry no data
+    if (!htypeRaw.startsWith("bsr_m")) return true;
+
+    if (!bsread_ReadString(bsread_FindKey(value,end,"hash"),end,&str,&len)) return false;
+    if (len!=hashRaw.size() || memcmp(str,hashRaw.constData(),len)!=0){
+        hashRaw=QByteArray(str,len);
+        hash=QString::fromLatin1(str,len);
+    }
+
+    // the data header itself may be compressed
+    dh_compression=bs_uncompressed;
+    if (bsread_ReadString(bsread_FindKey(value,end,"dh_compression"),end,&str,&len) && !(len==4 && memcmp(str,"none",4)==0)){
+        dh_compression=bsread_Decompress::compressionType(QString::fromLatin1(str,len));
+    }
+
+    if (!bsread_ReadNumber(bsread_FindKey(value,end,"pulse_id"),end,&number)) return false;
+    pulse_id=number;
+
+    object=bsread_FindKey(value,end,"global_timestamp");
+    if (object){
+        if (*object!='{') return false;
+        objectEnd=(const char *) memchr(object,'}',end-object);
+        if (!objectEnd) return false;
+        if (bsread_ReadNumber(bsread_FindKey(object,objectEnd,"sec"),objectEnd,&number)) global_timestamp_sec=(long)number;
+        if (bsread_ReadNumber(bsread_FindKey(object,objectEnd,"ns"),objectEnd,&number)) global_timestamp_ns=(long)number;
+        if (bsread_ReadNumber(bsread_FindKey(object,objectEnd,"epoch"),objectEnd,&number)) global_timestamp_epoch=(long)number;
+        if (bsread_ReadNumber(bsread_FindKey(object,objectEnd,"ns_offset"),objectEnd,&number)) global_timestamp_ns_offset=(long)number;
+    }
+    return true;
 }
 
 bool bsread_Decode::setMainHeader(char *value,size_t size)
 {
-    JSONObject jsonobj;
-    QString RawData=QString(value);
-    MainHeader = RawData.left((int)size);
+    // copy into the already allocated buffer, the zmq message is reused for the next part
+    MainHeaderRaw.resize((int)size);
+    memcpy(MainHeaderRaw.data(),value,size);
     channelcounter=0;
+    if (!bsread_ParseMainHeaderFast(value,size)){
+        bsread_ParseMainHeaderJSON();
+        hashRaw=hash.toLatin1();
+        htypeRaw=main_htype.toLatin1();
+    }
+    return true;
+}
+// complete parse, used when the fast extraction does not understand the header
+bool bsread_Decode::bsread_ParseMainHeaderJSON()
+{
+    JSONObject jsonobj;
+    QString MainHeader=QString::fromLatin1(MainHeaderRaw.constData(),MainHeaderRaw.size());
     JSONValue *MainMessageJ = JSON::Parse(MainHeader.toStdString().c_str());
     if (MainMessageJ!=NULL){
         if(!MainMessageJ->IsObject()) {
@@ -273,6 +439,10 @@ bool bsread_Decode::setMainHeader(char *value,size_t size)
                 pulse_id=jsonobj[L"pulse_id"]->AsNumber();
                 //qDebug() << "pulse_id :" << pulse_id;
             }
+            dh_compression=bs_uncompressed;
+            if (jsonobj.find(L"dh_compression") != jsonobj.end() && jsonobj[L"dh_compression"]->IsString()) {
+                dh_compression=bsread_Decompress::compressionType(QString::fromWCharArray(jsonobj[L"dh_compression"]->AsString().c_str()));
+            }
             if (jsonobj.find(L"htype") != jsonobj.end() && jsonobj[L"htype"]->IsString()) {
                 main_htype=QString::fromWCharArray(jsonobj[L"htype"]->AsString().c_str());
             }
@@ -315,6 +485,10 @@ void bsread_Decode::setHeader(char *value,size_t size){
 
     Channels.clear();
     ChannelSearch.clear();
+    PartChannels.clear();
+    PartDecoders.clear();
+    PartPlainDecoders.clear();
+    monitorBindingValid=false;
     //Header Channel
     bsread_InitHeaderChannels();
     //qDebug() << "Integer :" << ChannelHeader.toStdString().c_str();
@@ -387,6 +561,9 @@ void bsread_Decode::setHeader(char *value,size_t size){
                         chdata->modulo=jsonobj3[L"modulo"]->AsNumber();
                     }
 
+                    if (jsonobj3.find(L"compression") != jsonobj3.end() && jsonobj3[L"compression"]->IsString()) {
+                        chdata->compression=bsread_Decompress::compressionType(QString::fromWCharArray(jsonobj3[L"compression"]->AsString().c_str()));
+                    }
                     if (jsonobj3.find(L"encoding") != jsonobj3.end() && jsonobj3[L"encoding"]->IsString()) {
                         QString encoding=QString::fromWCharArray(jsonobj3[L"encoding"]->AsString().c_str());
 
@@ -453,6 +630,15 @@ void bsread_Decode::setHeader(char *value,size_t size){
 
                     }
 
+                    // every channel sends one data and one timestamp part, bind the decoder for it now
+                    PartChannels.append(chdata);
+                    PartPlainDecoders.append(bsread_BindPartDecoder(chdata));
+                    if (chdata->compression!=bs_uncompressed){
+                        PartDecoders.append(&bsread_Decode::bsread_DecodeCompressed);
+                    }else{
+                        PartDecoders.append(PartPlainDecoders.last());
+                    }
+
 
                 }
 
@@ -610,7 +796,6 @@ void bsread_Decode::bsread_SetData(bsread_channeldata* Data,void *message,size_t
         if (datasize==1){
             if (size>0){
               bsdata_assign_single(Data, message,&datatypesize);
-              channelcounter++;
               Data->valid=true;
             }else{
               Data->valid=false;
@@ -635,7 +820,6 @@ void bsread_Decode::bsread_SetData(bsread_channeldata* Data,void *message,size_t
                 }
                 Data->valid=true;
 
-                channelcounter++;
                 //qDebug() << "Data->bsdata.wf_data_size :" << Data->bsdata.wf_data_size << "  " <<size <<"  " <<datasize <<"  " << datatypesize;
             }else{
                 Data->valid=false;
@@ -676,8 +860,6 @@ void bsread_Decode::bsread_SetData(bsread_channeldata* Data,void *message,size_t
                     Data->bsdata.wf_data_size=datasize;
                 }
                 Data->valid=true;
-                channelcounter++;
-                channelcounter++;
                 //qDebug() << "Data->bsdata.wf_data_size :" << Data->bsdata.wf_data_size << "  " <<size <<"  " <<datasize <<"  " << datatypesize;
             }else{
                 Data->valid=false;
@@ -694,21 +876,60 @@ void bsread_Decode::bsread_SetData(bsread_channeldata* Data,void *message,size_t
 
 }
 
+// scalars and arrays with a single element
+void bsread_Decode::bsread_DecodeScalar(bsread_channeldata* Data,void *message,size_t size){
+    int datatypesize;
+    if (size>0){
+        bsdata_assign_single(Data, message,&datatypesize);
+        Data->valid=true;
+    }else{
+        Data->valid=false;
+    }
+}
+
+void bsread_Decode::bsread_DecodeSkip(bsread_channeldata* Data,void *message,size_t size){
+    Q_UNUSED(message);
+    Q_UNUSED(size);
+    Data->valid=false;
+}
+
+// uncompresses the part into the buffer of the channel and hands it to the decoder for uncompressed data
+void bsread_Decode::bsread_DecodeCompressed(bsread_channeldata* Data,void *message,size_t size){
+    if (size==0){
+        Data->valid=false;
+        return;
+    }
+    if (!bsread_Decompress::decompress(Data->compression,bsread_Decompress::elementSize(Data->type),
+                                       (const char*)message,size,&Data->decompressed,BlockPool)){
+        Data->valid=false;
+        return;
+    }
+    (this->*PartPlainDecoders.at(channelcounter))(Data,Data->decompressed.data(),(size_t)Data->decompressed.size());
+}
+
+bsread_Decode::bsread_PartDecoder bsread_Decode::bsread_BindPartDecoder(bsread_channeldata *Data)
+{
+    int elements=1;
+    if (Data->type==bs_none) return &bsread_Decode::bsread_DecodeSkip;
+    foreach(int dim, Data->shape) elements*=dim;
+    if (Data->shape.count()<=2 && elements==1) return &bsread_Decode::bsread_DecodeScalar;
+    return &bsread_Decode::bsread_SetData;
+}
+
+// channelcounter is the index of the data part in the message, it selects the decoder bound by setHeader
 void bsread_Decode::bsread_SetChannelData(void *message,size_t size)
 {
-    if ((message)&&(Channels.size()>channelcounter)){
-      bsread_SetData(Channels.at(channelcounter),message,size);
+    if ((message)&&(PartDecoders.size()>channelcounter)){
+        (this->*PartDecoders.at(channelcounter))(PartChannels.at(channelcounter),message,size);
     }
 }
 
 void bsread_Decode::bsread_SetChannelTimeStamp(void * timestamp)
 {
-    if ((timestamp)&&(Channels.size()>channelcounter)){
-        Channels.at(channelcounter)->timestamp=*(double*) timestamp;
-
-
-        channelcounter++;
+    if ((timestamp)&&(PartChannels.size()>channelcounter)){
+        PartChannels.at(channelcounter)->timestamp=*(double*) timestamp;
     }
+    channelcounter++;
 }
 
 void bsread_Decode::bsread_InitHeaderChannels()
@@ -720,6 +941,7 @@ void bsread_Decode::bsread_InitHeaderChannels()
     chdata->type=bs_string;
     chdata->name="bsread:hash";
     chdata->valid=true;
+    HeaderChannels[0]=chdata;
     ChannelSearch.insert(chdata->name, chdata);
 
     chdata=new bsread_channeldata();
@@ -727,6 +949,7 @@ void bsread_Decode::bsread_InitHeaderChannels()
     chdata->type=bs_float64;
     chdata->name="bsread:pulse_id";
     chdata->valid=true;
+    HeaderChannels[1]=chdata;
     ChannelSearch.insert(chdata->name, chdata);
 
     chdata=new bsread_channeldata();
@@ -734,6 +957,7 @@ void bsread_Decode::bsread_InitHeaderChannels()
     chdata->type=bs_string;
     chdata->name="bsread:htype";
     chdata->valid=true;
+    HeaderChannels[2]=chdata;
     ChannelSearch.insert(chdata->name, chdata);
 /*
     chdata=new bsread_channeldata();
@@ -747,6 +971,7 @@ void bsread_Decode::bsread_InitHeaderChannels()
     chdata->type=bs_float64;
     chdata->name="bsread:global_timestamp_ns";
     chdata->valid=true;
+    HeaderChannels[3]=chdata;
     ChannelSearch.insert(chdata->name, chdata);
 
     chdata=new bsread_channeldata();
@@ -754,6 +979,7 @@ void bsread_Decode::bsread_InitHeaderChannels()
     chdata->type=bs_float64;
     chdata->name="bsread:global_timestamp_sec";
     chdata->valid=true;
+    HeaderChannels[4]=chdata;
     ChannelSearch.insert(chdata->name, chdata);
 
 /*
@@ -768,22 +994,28 @@ void bsread_Decode::bsread_InitHeaderChannels()
 void bsread_Decode::bsread_TransferHeaderData()
 {
     if (Channels.size()>4){
-        Channels.at(channelcounter)->bsdata.bs_string=hash;
-        channelcounter++;
-        Channels.at(channelcounter)->bsdata.bs_float64=pulse_id;
-        channelcounter++;
-        Channels.at(channelcounter)->bsdata.bs_string=main_htype;
-        channelcounter++;
-        //Channels.at(channelcounter)->bsdata.bs_float64=global_timestamp_epoch;
-        //channelcounter++;
-        Channels.at(channelcounter)->bsdata.bs_float64=global_timestamp_ns;
-        channelcounter++;
-        Channels.at(channelcounter)->bsdata.bs_float64=global_timestamp_sec;
-        channelcounter++;
-        //Channels.at(channelcounter)->bsdata.bs_float64=global_timestamp_ns_offset;
-        //channelcounter++;
+        HeaderChannels[0]->bsdata.bs_string=hash;
+        HeaderChannels[1]->bsdata.bs_float64=pulse_id;
+        HeaderChannels[2]->bsdata.bs_string=main_htype;
+        HeaderChannels[3]->bsdata.bs_float64=global_timestamp_ns;
+        HeaderChannels[4]->bsdata.bs_float64=global_timestamp_sec;
+    }
+}
 
+// resolve the channel of every monitored pv once per header or monitor change, not per message
+void bsread_Decode::bsread_BindMonitors()
+{
+    MonitorChannels.resize(listOfIndexes.size());
+    for (int j=0;j<listOfIndexes.size();j++){
+        knobData* kData = bsread_KnobDataP->GetMutexKnobDataPtr(listOfIndexes.at(j));
+        if((kData != (knobData *) 0) && (kData->index != -1)) {
+            MonitorChannels[j]=ChannelSearch.value(QString(kData->pv),NULL);
+        }else{
+            MonitorChannels[j]=NULL;
+        }
     }
+    fecString=StreamConnectionPoint.leftJustified(39, ' ').toLatin1();
+    monitorBindingValid=true;
 }
 
 
@@ -804,21 +1036,15 @@ void bsread_Decode::bsread_EndofData()
     //Update Knobdata
     //qDebug() << "bsreadPlugin:Update Knobdata";
     if (listOfIndexes.size()>0){
-        foreach(int index, listOfIndexes) {
-            knobData* kData = bsread_KnobDataP->GetMutexKnobDataPtr(index);
+        if (!monitorBindingValid) bsread_BindMonitors();
+        for (int j=0;j<listOfIndexes.size();j++) {
+            knobData* kData = bsread_KnobDataP->GetMutexKnobDataPtr(listOfIndexes.at(j));
             if((kData != (knobData *) 0) && (kData->index != -1)) {
-                QString key = kData->pv;
-                //qDebug() << kData->pv;
-                QString ioc_string=StreamConnectionPoint.leftJustified(39, ' ');
-                strcpy(kData->edata.fec,ioc_string.toLatin1().constData());
-                // find this pv in our internal values list
-                // and update its value
-                bsreadPV=NULL;
-                QMap<QString,bsread_channeldata*>::iterator i = ChannelSearch.find(key);
-                while (i !=ChannelSearch.end() && i.key() == key) {
-                    bsreadPV = i.value();
-                    break;//?????
-                }
+                // the knob is changed in place, readers of snapshots have to see it as a whole
+                bsread_KnobDataP->BeginMutexKnobDataWrite(listOfIndexes.at(j));
+                qstrncpy(kData->edata.fec,fecString.constData(),sizeof(kData->edata.fec));
+                // channel of this pv, resolved by bsread_BindMonitors
+                bsreadPV=MonitorChannels.at(j);
                 // update some data
                 // bs_string,bs_float64,bs_float32,bs_int64,bs_int32,bs_uint64,bs_uint32,bs_int16,bs_uint16,bs_int8,bs_uint8
 
@@ -1000,6 +1226,7 @@ void bsread_Decode::bsread_EndofData()
 
                 kData->edata.accessR = true;
                 kData->edata.accessW = false;
+                bsread_KnobDataP->EndMutexKnobDataWrite(listOfIndexes.at(j));
             }
         }
        //qDebug() << "ActiveThreads: "<< QThreadPool::globalInstance()->activeThreadCount();
@@ -1046,7 +1273,9 @@ void bsread_Decode::bsread_DataTimeOut(){
             //qDebug() << "Index :" << kData->pv << kData->index;
             if (kData->index>=0){
                 bsread_KnobDataP->DataLock(kData);
+                bsread_KnobDataP->BeginMutexKnobDataWrite(index);
                 kData->edata.connected = false;
+                bsread_KnobDataP->EndMutexKnobDataWrite(index);
                 bsread_KnobDataP->SetMutexKnobData(kData->index, *kData);
                 bsread_KnobDataP->SetMutexKnobDataReceived(kData);
                 bsread_KnobDataP->DataUnlock(kData);
@@ -1054,18 +1283,12 @@ void bsread_Decode::bsread_DataTimeOut(){
         }
     }
 }
-void bsread_Decode::bsread_Delay(){
-    QMutex LocalLocker;
-    QWaitCondition LocalDelay;
-    LocalLocker.lock();
-    LocalDelay.wait(&LocalLocker,5);
-    LocalLocker.unlock();
-}
 bool bsread_Decode::bsread_DataMonitorConnection(QString channel,int index){
     QMutexLocker locker(&mutex);
 
     listOfIndexes.append(index);
     listOfRequestedChannels.append(channel);
+    monitorBindingValid=false;
     //qDebug() << "Index :" << channel << index;
 
     return true;
@@ -1089,7 +1312,9 @@ bool bsread_Decode::bsread_DataMonitorUnConnect(knobData *kData){
     //qDebug() << "Index :" << kData->pv << kData->index;
     listOfIndexes.removeAll(kData->index);
     listOfRequestedChannels.removeAll(kData->pv);
+    monitorBindingValid=false;
     hash="";
+    hashRaw.clear();
     return true;
 }
 
@@ -28,7 +28,11 @@
 #include <QThread>
 #include <QThreadPool>
 #include <QList>
+#include <QVector>
+#include <QByteArray>
 #include <QAtomicInt>
+#include <QMutex>
+#include <QElapsedTimer>
 #include "knobData.h"
 #include "mutexKnobData.h"
 #include "bsread_channeldata.h"
@@ -59,11 +63,15 @@ public:
     bool bsread_DataMonitorConnection(knobData *kData);
     bool bsread_DataMonitorUnConnect(knobData *kData);
     void setTerminate();
+    bool getTerminate() const;
     void bsread_createConnection(int rc);
     QString getStreamConnectionPoint() const;
 
-public slots:
-    void process();
+    bool openConnection();
+    void receiveMessages(int maxMessages);
+    void closeConnection();
+    void getStatistics(double *rate, double *avgLatency, double *maxLatency);
+
 signals:
     void finished();
 private:
@@ -76,21 +84,37 @@ private:
     QString ConnectionPoint;
     MutexKnobData * bsread_KnobDataP;
     size_t message_size;
-    QString MainHeader;
+    QByteArray MainHeaderRaw;
+    QByteArray hashRaw;
+    QByteArray htypeRaw;
     long global_timestamp_epoch;
     long global_timestamp_ns;
     long global_timestamp_sec;
     long global_timestamp_ns_offset;
     double pulse_id;
     QString main_htype;
+    bsread_compression dh_compression;
     QString main_reconnect_adress;
     QString data_htype;
     QString hash;
+    QString last_hash;
     QString ChannelHeader;
     int channelcounter;
     QList<bsread_channeldata*> Channels;
     QMap<QString,bsread_channeldata*> ChannelSearch;
 
+    // decoder per data part of a message, compiled from the data header when its hash changes
+    typedef void (bsread_Decode::*bsread_PartDecoder)(bsread_channeldata *Data, void *message, size_t size);
+    QVector<bsread_channeldata*> PartChannels;
+    QVector<bsread_PartDecoder> PartDecoders;
+    QVector<bsread_PartDecoder> PartPlainDecoders;
+    bsread_channeldata *HeaderChannels[5];
+
+    // channel of each entry of listOfIndexes
+    QVector<bsread_channeldata*> MonitorChannels;
+    bool monitorBindingValid;
+    QByteArray fecString;
+
     QThreadPool* UpdaterPool;
     QThreadPool* BlockPool;
 
@@ -109,7 +133,21 @@ private:
 
 
     void bsread_DataTimeOut();
-    void bsread_Delay();
+    bool bsread_ParseMainHeaderFast(const char *value, size_t size);
+    bool bsread_ParseMainHeaderJSON();
+    bsread_PartDecoder bsread_BindPartDecoder(bsread_channeldata *Data);
+    void bsread_DecodeScalar(bsread_channeldata *Data, void *message, size_t size);
+    void bsread_DecodeCompressed(bsread_channeldata *Data, void *message, size_t size);
+    void bsread_DecodeSkip(bsread_channeldata *Data, void *message, size_t size);
+    void bsread_BindMonitors();
+    void bsread_UpdateStatistics();
+
+    QMutex statisticsLocker;
+    QElapsedTimer statisticsTimer;
+    long messageCount;
+    long latencyCount;
+    double latencySum;
+    double latencyMax;
     void bsread_SetData(bsread_channeldata *Data, void *message, size_t size);
     void WaveformManagment(knobData *kData, bsread_channeldata *bsreadPV);
     void bsdata_assign_single(void *message, bsread_channeldata* Data);
@@ -0,0 +1,251 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2015
+ *
+ *  Author:
+ *    Helge Brands
+ *  Contact details:
+ *    helge.brands@psi.ch
+ */
+#include <QtEndian>
+#include <QVector>
+#include <QRunnable>
+#include <QDebug>
+#include <string.h>
+#ifdef BSREAD_LZ4
+#include <lz4.h>
+#endif
+#include "bsread_decompress.h"
+
+// definitions of the bitshuffle library, blocks hold a multiple of 8 elements
+#define BSHUF_BLOCKED_MULT 8
+#define BSHUF_TARGET_BLOCK_SIZE_B 8192
+#define BSHUF_MIN_RECOMMEND_BLOCK 128
+
+// below this number of blocks the decompression is done in the calling thread
+#define PARALLEL_MIN_BLOCKS 16
+
+#ifdef BSREAD_LZ4
+typedef struct _bshuf_block{
+    size_t inOffset;
+    size_t inSize;
+    size_t outOffset;
+    size_t elements;
+}bshuf_block;
+
+// undo the bit transposition of a block of 'size' elements (size is a multiple of 8)
+static void bshuf_untrans_bit_elem(const char *in, char *out, char *tmp, size_t size, size_t elemSize)
+{
+    size_t nbyteRow=size/8;
+    size_t nbyte=elemSize*size;
+    quint64 x,t;
+
+    for (size_t jj=0;jj<elemSize;jj++){
+        for (size_t ii=0;ii<nbyteRow;ii++){
+            for (size_t kk=0;kk<8;kk++){
+                tmp[ii*8*elemSize+jj*8+kk]=in[(jj*8+kk)*nbyteRow+ii];
+            }
+        }
+    }
+    for (size_t jj=0;jj<8*elemSize;jj+=8){
+        for (size_t ii=0;ii+8*elemSize-1<nbyte;ii+=8*elemSize){
+            x=qFromLittleEndian<quint64>((const uchar *) &tmp[ii+jj]);
+            t=(x^(x>>7))&Q_UINT64_C(0x00AA00AA00AA00AA);
+            x=x^t^(t<<7);
+            t=(x^(x>>14))&Q_UINT64_C(0x0000CCCC0000CCCC);
+            x=x^t^(t<<14);
+            t=(x^(x>>28))&Q_UINT64_C(0x00000000F0F0F0F0);
+            x=x^t^(t<<28);
+            for (int kk=0;kk<8;kk++){
+                out[ii+jj/8+kk*elemSize]=(char) x;
+                x=x>>8;
+            }
+        }
+    }
+}
+
+// decompresses a range of blocks, several of them run in parallel on the BlockPool
+class bsread_DecompressBlocks : public QRunnable
+{
+public:
+    bsread_DecompressBlocks(const bshuf_block *Blocks, int Count, int ElementSize, const char *In, char *Out){
+        blocks=Blocks;
+        count=Count;
+        elementSize=ElementSize;
+        in=In;
+        out=Out;
+        ok=true;
+        setAutoDelete(false);
+    }
+    void run(){
+        size_t maxBytes=0;
+        for (int i=0;i<count;i++) maxBytes=qMax(maxBytes,blocks[i].elements*elementSize);
+        QByteArray lz4Buffer((int) maxBytes,0);
+        QByteArray transBuffer((int) maxBytes,0);
+        for (int i=0;i<count;i++){
+            size_t bytes=blocks[i].elements*elementSize;
+            int rc=LZ4_decompress_safe(in+blocks[i].inOffset,lz4Buffer.data(),(int) blocks[i].inSize,(int) bytes);
+            if (rc!=(int) bytes){
+                ok=false;
+                return;
+            }
+            bshuf_untrans_bit_elem(lz4Buffer.constData(),out+blocks[i].outOffset,transBuffer.data(),blocks[i].elements,elementSize);
+        }
+    }
+    bool ok;
+private:
+    const bshuf_block *blocks;
+    int count;
+    int elementSize;
+    const char *in;
+    char *out;
+};
+#endif
+
+bool bsread_Decompress::isSupported()
+{
+#ifdef BSREAD_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+bsread_compression bsread_Decompress::compressionType(const QString &name)
+{
+    if (name=="bitshuffle_lz4") return bs_bitshuffle_lz4;
+    if (name=="lz4") return bs_lz4;
+    return bs_uncompressed;
+}
+
+int bsread_Decompress::elementSize(bsread_types type)
+{
+    switch (type){
+    case bs_float64:
+    case bs_int64:
+    case bs_uint64: return 8;
+    case bs_float32:
+    case bs_int32:
+    case bs_uint32: return 4;
+    case bs_int16:
+    case bs_uint16: return 2;
+    default: return 1;
+    }
+}
+
+bool bsread_Decompress::decompress(bsread_compression compression, int elementSize, const char *in, size_t inSize,
+                                   QByteArray *out, QThreadPool *pool)
+{
+    switch (compression){
+    case bs_bitshuffle_lz4: return decompressBitshuffleLZ4(elementSize,in,inSize,out,pool);
+    case bs_lz4: return decompressLZ4(in,inSize,out);
+    default: break;
+    }
+    return false;
+}
+
+// lz4: 4 byte big endian uncompressed size followed by one lz4 block
+bool bsread_Decompress::decompressLZ4(const char *in, size_t inSize, QByteArray *out)
+{
+#ifdef BSREAD_LZ4
+    if (inSize<4) return false;
+    quint32 outSize=qFromBigEndian<quint32>((const uchar *) in);
+    if (out->size()!=(int) outSize) out->resize((int) outSize);
+    int rc=LZ4_decompress_safe(in+4,out->data(),(int)(inSize-4),(int) outSize);
+    return rc==(int) outSize;
+#else
+    Q_UNUSED(in);
+    Q_UNUSED(inSize);
+    Q_UNUSED(out);
+    return false;
+#endif
+}
+
+/*
+ * bitshuffle_lz4: 8 byte big endian uncompressed size, 4 byte big endian block size in bytes,
+ * then per block a 4 byte big endian compressed size and the lz4 data of the bit transposed elements;
+ * the elements not filling a multiple of 8 are appended uncompressed.
+ */
+bool bsread_Decompress::decompressBitshuffleLZ4(int elementSize, const char *in, size_t inSize, QByteArray *out, QThreadPool *pool)
+{
+#ifdef BSREAD_LZ4
+    QVector<bshuf_block> blocks;
+    size_t elements, blockSize, position, outPosition, leftover;
+
+    if (inSize<12 || elementSize<1) return false;
+    quint64 outSize=qFromBigEndian<quint64>((const uchar *) in);
+    blockSize=qFromBigEndian<quint32>((const uchar *) in+8)/elementSize;
+    if (blockSize==0){
+        blockSize=BSHUF_TARGET_BLOCK_SIZE_B/elementSize;
+        blockSize=(blockSize/BSHUF_BLOCKED_MULT)*BSHUF_BLOCKED_MULT;
+        blockSize=qMax(blockSize,(size_t) BSHUF_MIN_RECOMMEND_BLOCK);
+    }
+    if (blockSize%BSHUF_BLOCKED_MULT) return false;
+    if (outSize%elementSize) return false;
+    elements=(size_t)(outSize/elementSize);
+    if (out->size()!=(int) outSize) out->resize((int) outSize);
+
+    // the block offsets are only known by walking through the size prefixes
+    position=12;
+    outPosition=0;
+    while (elements-outPosition/elementSize>=BSHUF_BLOCKED_MULT){
+        bshuf_block block;
+        block.elements=qMin(blockSize,elements-outPosition/elementSize);
+        block.elements-=block.elements%BSHUF_BLOCKED_MULT;
+        if (position+4>inSize) return false;
+        block.inSize=qFromBigEndian<quint32>((const uchar *) in+position);
+        block.inOffset=position+4;
+        block.outOffset=outPosition;
+        position=block.inOffset+block.inSize;
+        if (position>inSize) return false;
+        outPosition+=block.elements*elementSize;
+        blocks.append(block);
+    }
+    leftover=(size_t) outSize-outPosition;
+    if (position+leftover>inSize) return false;
+    if (leftover>0) memcpy(out->data()+outPosition,in+position,leftover);
+
+    if (blocks.count()<PARALLEL_MIN_BLOCKS || !pool){
+        bsread_DecompressBlocks task(blocks.constData(),blocks.count(),elementSize,in,out->data());
+        task.run();
+        return task.ok;
+    }
+
+    QVector<bsread_DecompressBlocks*> tasks;
+    int threads=qMax(1,pool->maxThreadCount());
+    int perTask=(blocks.count()+threads-1)/threads;
+    for (int first=0;first<blocks.count();first+=perTask){
+        tasks.append(new bsread_DecompressBlocks(blocks.constData()+first,qMin(perTask,blocks.count()-first),elementSize,in,out->data()));
+        pool->start(tasks.last());
+    }
+    pool->waitForDone();
+    bool ok=true;
+    foreach(bsread_DecompressBlocks *task, tasks){
+        ok=ok&&task->ok;
+        delete(task);
+    }
+    return ok;
+#else
+    Q_UNUSED(elementSize);
+    Q_UNUSED(in);
+    Q_UNUSED(inSize);
+    Q_UNUSED(out);
+    Q_UNUSED(pool);
+    return false;
+#endif
+}
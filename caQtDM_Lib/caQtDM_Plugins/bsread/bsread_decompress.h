@@ -0,0 +1,51 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2015
+ *
+ *  Author:
+ *    Helge Brands
+ *  Contact details:
+ *    helge.brands@psi.ch
+ */
+#ifndef BSREAD_DECOMPRESS_H
+#define BSREAD_DECOMPRESS_H
+
+#include <QString>
+#include <QByteArray>
+#include <QThreadPool>
+#include "bsread_channeldata.h"
+
+/*
+ * decompression of bsread data parts; lz4 support is only available when the plugin
+ * was built with BSREAD_LZ4 (see caQtDM.pri), otherwise decompress() always fails
+ * and compressed channels are marked invalid.
+ */
+class bsread_Decompress
+{
+public:
+    static bool isSupported();
+    static bsread_compression compressionType(const QString &name);
+    static int elementSize(bsread_types type);
+    static bool decompress(bsread_compression compression, int elementSize, const char *in, size_t inSize,
+                           QByteArray *out, QThreadPool *pool);
+private:
+    static bool decompressLZ4(const char *in, size_t inSize, QByteArray *out);
+    static bool decompressBitshuffleLZ4(int elementSize, const char *in, size_t inSize, QByteArray *out, QThreadPool *pool);
+};
+
+#endif // BSREAD_DECOMPRESS_H
@@ -28,6 +28,7 @@
 #include <QDebug>
 #include <QBuffer>
 #include "bsread_dispatchercontrol.h"
+#include "bsread_decompress.h"
 #include "JSON.h"
 #include "JSONValue.h"
 
@@ -37,6 +38,7 @@ bsread_dispatchercontrol::bsread_dispatchercontrol()
     loop = new QEventLoop(this);
     connect(qApp, SIGNAL(aboutToQuit()),this, SLOT(closeEvent()));
     mutexknobdataP = NULL;
+    poller = NULL;
     //Special Channels
     bsreadChannels.append("bsread:hash");
     bsreadChannels.append("bsread:pulse_id");
@@ -49,6 +51,7 @@ bsread_dispatchercontrol::bsread_dispatchercontrol()
     DispatcherChannels.append("bsread:bsinconsistency");
     DispatcherChannels.append("bsread:bsmapping");
     DispatcherChannels.append("bsread:bsstrategy");
+    DispatcherChannels.append("bsread:bscompression");
 
     bsread_internalchannel *opt;
 
@@ -87,6 +90,14 @@ bsread_dispatchercontrol::bsread_dispatchercontrol()
     opt->setString("complete-all");
     DispatcherChannels_Connected.insert(opt->getPv_name(),opt);
 
+    opt=new bsread_internalchannel(this,"bsread:bscompression","bscompression");
+    opt->setData(NULL,bsread_internalchannel::in_enum);
+    opt->addEnumString("none");
+    opt->addEnumString("bitshuffle_lz4");
+    opt->addEnumString("lz4");
+    opt->setString("none");
+    DispatcherChannels_Connected.insert(opt->getPv_name(),opt);
+
 
 }
 bsread_dispatchercontrol::~bsread_dispatchercontrol()
@@ -123,6 +134,7 @@ void bsread_dispatchercontrol::process()
         processOption(optionsP,"bsinconsistency");
         processOption(optionsP,"bsmapping");
         processOption(optionsP,"bsstrategy");
+        processOption(optionsP,"bscompression");
 
     }
 
@@ -145,6 +157,12 @@ void bsread_dispatchercontrol::process()
         init_reconnection=init_reconnection||get_internalChannel("bsread:bsmapping")->getProc();
         QString l_bsstrategy=get_internalChannel("bsread:bsstrategy")->getString();
         init_reconnection=init_reconnection||get_internalChannel("bsread:bsstrategy")->getProc();
+        QString l_bscompression=get_internalChannel("bsread:bscompression")->getString();
+        init_reconnection=init_reconnection||get_internalChannel("bsread:bscompression")->getProc();
+        if (l_bscompression!="none" && !bsread_Decompress::isSupported()){
+            // plugin built without lz4, the stream would not be readable
+            l_bscompression="none";
+        }
 
 
         QString StreamDispatcher=Dispatcher;
@@ -268,7 +286,7 @@ void bsread_dispatchercontrol::process()
                 }
             }
             data.remove(data.length()-1,1);
-            data.append("],\"sendIncompleteMessages\":true,\"compression\":\"none\",");
+            data.append("],\"sendIncompleteMessages\":true,\"compression\":\""+l_bscompression+"\",");
             data.append("\"mapping\":{\"incomplete\":\""+l_bsmapping+"\"},");
             data.append("\"channelValidation\":{\"inconsistency\":\""+l_bsinconsistency+"\"}}");
             data.append("\"sendBehavior\":{\"strategy\":\""+l_bsstrategy+"\"}}");
@@ -416,6 +434,7 @@ int bsread_dispatchercontrol::filldispatcherchannels2(bsread_internalchannel *ch
     if (mutexknobdataP){
          knobData* kData = mutexknobdataP->GetMutexKnobDataPtr(index);
          if (kData){
+             mutexknobdataP->BeginMutexKnobDataWrite(index);
              if (channel->getType()==bsread_internalchannel::in_string){
                  //qDebug() << " FILL Channel:" << channel->getPv_name() << index;
                  kData->edata.fieldtype=caSTRING;
@@ -456,6 +475,7 @@ int bsread_dispatchercontrol::filldispatcherchannels2(bsread_internalchannel *ch
              kData->edata.accessR = true;
              kData->edata.accessW = true;
              kData->edata.monitorCount++;
+             mutexknobdataP->EndMutexKnobDataWrite(index);
              mutexknobdataP->SetMutexKnobData(kData->index, *kData);
              mutexknobdataP->SetMutexKnobDataReceived(kData);
 
@@ -562,6 +582,11 @@ void bsread_dispatchercontrol::setZmqcontex(void *value)
     zmqcontex = value;
 }
 
+void bsread_dispatchercontrol::setPoller(bsread_Poller *value)
+{
+    poller = value;
+}
+
 
 int bsread_dispatchercontrol::rem_Channel(QString channel,int index)
 {
@@ -626,6 +651,7 @@ int bsread_dispatchercontrol::set_Channel(char *pv, double rdata, int32_t idata,
        knobData* kData = mutexknobdataP->GetMutexKnobDataPtr(bsreadPV->getIndex(d));
        if (kData){
            //qDebug() << "Ping:" << d;
+           mutexknobdataP->BeginMutexKnobDataWrite(bsreadPV->getIndex(d));
            switch (bsreadPV->getType()){
                case bsread_internalchannel::in_string:{
                  strncpy((char *)kData->edata.dataB, sdata, kData->edata.dataSize);
@@ -639,6 +665,7 @@ int bsread_dispatchercontrol::set_Channel(char *pv, double rdata, int32_t idata,
            }
            kData->edata.connected = true;
            kData->edata.monitorCount++;
+           mutexknobdataP->EndMutexKnobDataWrite(bsreadPV->getIndex(d));
 
            mutexknobdataP->SetMutexKnobData(kData->index, *kData);
            mutexknobdataP->SetMutexKnobDataReceived(kData);
@@ -698,7 +725,6 @@ void bsread_dispatchercontrol::finishReplyConnect()
                 stream=QString::fromWCharArray(jsonobj[L"stream"]->AsString().c_str());
                 streams.append(stream);
                 bsreadconnections.append(new bsread_Decode(zmqcontex,stream,streamType));
-                bsreadThreads.append(new QThread(this));
 
                 bsreadconnections.last()->setKnobData(mutexknobdataP);
 
@@ -712,14 +738,9 @@ void bsread_dispatchercontrol::finishReplyConnect()
                     }
 
 
-                bsreadconnections.last()->moveToThread(bsreadThreads.last());
                 //qDebug() << "Create bsread_Decode:" <<bsreadconnections.last();
-                connect(bsreadThreads.last(), SIGNAL(started()), bsreadconnections.last(), SLOT(process()));
-                connect(bsreadconnections.last(), SIGNAL(finished()), bsreadThreads.last(), SLOT(quit()));
-                //connect(bsreadThreads.last(), SIGNAL(finished()), bsreadThreads.last(), SLOT(deleteLater()));
-                //connect(bsreadconnections.last(), SIGNAL(finished()), bsreadconnections.last(), SLOT(deleteLater()));
-
-                bsreadThreads.last()->start();
+                // the stream is served by the shared poller thread
+                poller->addDecoder(bsreadconnections.last());
                 cleanStreamConnections(1);
                 // Remove internal data processing flags
                 QMap<QString, QPointer<bsread_internalchannel> >::iterator i;
@@ -780,13 +801,10 @@ void bsread_dispatchercontrol::cleanStreamConnections(int check){
 
         deleteStream(&connection);
 
-        bsreadThreads.first()->quit();
-        bsreadThreads.first()->wait();
-        delete(bsreadThreads.first());
+        poller->removeDecoder(bsreadconnections.first());
         delete(bsreadconnections.first());
 
         bsreadconnections.removeFirst();
-        bsreadThreads.removeFirst();
     }
 
 }
@@ -807,12 +825,9 @@ void bsread_dispatchercontrol::closeEvent(){
     while (bsreadconnections.count()!=0){
        //qDebug() << "closeEvent Delete bsread_Decode:" <<bsreadconnections.first();
         bsreadconnections.first()->setTerminate();
-       bsreadThreads.first()->quit();
-       bsreadThreads.first()->wait();
-       delete(bsreadThreads.first());
+       poller->removeDecoder(bsreadconnections.first());
        delete(bsreadconnections.first());
        bsreadconnections.removeFirst();
-       bsreadThreads.removeFirst();
    }
 }
 
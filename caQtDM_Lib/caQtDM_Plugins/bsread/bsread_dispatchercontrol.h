@@ -35,6 +35,7 @@
 #include <QUrl>
 #include "bsread_internalchannel.h"
 #include "bsread_decode.h"
+#include "bsread_poller.h"
 #include "controlsinterface.h"
 
 typedef struct{
@@ -66,6 +67,7 @@ public:
 
 
     void setZmqcontex(void *value);
+    void setPoller(bsread_Poller *value);
     void setMutexknobdataP(MutexKnobData *value);
 
     void setTerminate();
@@ -131,7 +133,7 @@ protected:
   void * zmqcontex;
   MutexKnobData *mutexknobdataP;
   QList<bsread_Decode*> bsreadconnections;
-  QList<QThread*> bsreadThreads;
+  bsread_Poller *poller;
 
 
 };
@@ -0,0 +1,216 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2015
+ *
+ *  Author:
+ *    Helge Brands
+ *  Contact details:
+ *    helge.brands@psi.ch
+ */
+#include <QDebug>
+#include <QVector>
+#include "zmq.h"
+#include "bsread_poller.h"
+
+// upper limit of messages taken from one stream per wakeup, so that one busy stream can not starve the others
+#define MAX_MESSAGES_PER_WAKEUP 20
+
+bsread_Poller::bsread_Poller(void * Context)
+{
+    int value=0;
+    context=Context;
+    terminate=false;
+    running=false;
+
+    QString wakeupAddress=QString("inproc://bsread_poller_%1").arg((quintptr)this,0,16);
+    wakeupReceiver=zmq_socket(context, ZMQ_PAIR);
+    zmq_setsockopt(wakeupReceiver,ZMQ_LINGER,&value,sizeof(value));
+    if (zmq_bind(wakeupReceiver,wakeupAddress.toLatin1().constData())!=0){
+        printf ("error in zmq_bind: %s(%s)\n", zmq_strerror (errno),wakeupAddress.toLatin1().constData());
+    }
+    wakeupSender=zmq_socket(context, ZMQ_PAIR);
+    zmq_setsockopt(wakeupSender,ZMQ_LINGER,&value,sizeof(value));
+    if (zmq_connect(wakeupSender,wakeupAddress.toLatin1().constData())!=0){
+        printf ("error in zmq_connect: %s(%s)\n", zmq_strerror (errno),wakeupAddress.toLatin1().constData());
+    }
+}
+
+bsread_Poller::~bsread_Poller()
+{
+    QMutexLocker locker(&mutex);
+    if (wakeupSender) zmq_close(wakeupSender);
+    wakeupSender=NULL;
+    // receiver is closed by the poller thread, unless it never ran
+    if (wakeupReceiver) zmq_close(wakeupReceiver);
+    wakeupReceiver=NULL;
+}
+
+// has to be called with the mutex locked
+void bsread_Poller::wakeup()
+{
+    if (!wakeupSender) return;
+    // when the pipe is full a wakeup is already pending
+    zmq_send(wakeupSender,"",0,ZMQ_DONTWAIT);
+}
+
+void bsread_Poller::addDecoder(bsread_Decode *decoder)
+{
+    QMutexLocker locker(&mutex);
+    removePipeline.removeAll(decoder);
+    addPipeline.append(decoder);
+    wakeup();
+}
+
+// blocks until the poller thread closed the socket of the stream, after that the decoder may be deleted
+void bsread_Poller::removeDecoder(bsread_Decode *decoder)
+{
+    QMutexLocker locker(&mutex);
+    addPipeline.removeAll(decoder);
+    if (!running){
+        decoders.removeAll(decoder);
+        decoder->closeConnection();
+        return;
+    }
+    removePipeline.append(decoder);
+    wakeup();
+    while (running && removePipeline.contains(decoder)){
+        requestDone.wait(&mutex);
+    }
+}
+
+void bsread_Poller::setTerminate()
+{
+    QMutexLocker locker(&mutex);
+    terminate=true;
+    wakeup();
+}
+
+QString bsread_Poller::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    double rate=0.0,avgLatency=0.0,maxLatency=0.0;
+    double sumRate=0.0,sumLatency=0.0,worstLatency=0.0;
+    int streams=0;
+    foreach(bsread_Decode *decoder, decoders){
+        decoder->getStatistics(&rate,&avgLatency,&maxLatency);
+        sumRate+=rate;
+        sumLatency+=avgLatency*rate;
+        if (maxLatency>worstLatency) worstLatency=maxLatency;
+        streams++;
+    }
+    if (streams==0) return QString();
+    return QString("bsread streams=%1, %2 msg/s, latency avg=%3ms max=%4ms").arg(streams)
+            .arg(sumRate,0,'f',1).arg((sumRate>0.0) ? sumLatency/sumRate : 0.0,0,'f',1).arg(worstLatency,0,'f',1);
+}
+
+// returns true when the list of served streams changed
+bool bsread_Poller::handleRequests()
+{
+    bool changed=false;
+    QMutexLocker locker(&mutex);
+    while (!addPipeline.isEmpty()){
+        bsread_Decode *decoder=addPipeline.takeFirst();
+        if (decoder->openConnection()){
+            decoders.append(decoder);
+            changed=true;
+        }
+    }
+    while (!removePipeline.isEmpty()){
+        bsread_Decode *decoder=removePipeline.takeFirst();
+        if (decoders.removeAll(decoder)>0) changed=true;
+        decoder->closeConnection();
+    }
+    // streams that received a bsr_stop
+    for (int i=decoders.count()-1;i>=0;i--){
+        if (decoders.at(i)->getTerminate()){
+            decoders.at(i)->closeConnection();
+            decoders.removeAt(i);
+            changed=true;
+        }
+    }
+    requestDone.wakeAll();
+    return changed;
+}
+
+void bsread_Poller::process()
+{
+    QVector<zmq_pollitem_t> items;
+    QList<bsread_Decode*> polled;
+    bool changed=true;
+    char buffer[8];
+
+    {
+        QMutexLocker locker(&mutex);
+        running=true;
+    }
+    //qDebug() << "bsreadPoller: start ThreadID" << QThread::currentThreadId();
+
+    while (true){
+        if (handleRequests()) changed=true;
+        {
+            QMutexLocker locker(&mutex);
+            if (terminate) break;
+        }
+        if (changed){
+            // decoders is only changed by this thread
+            polled=decoders;
+            items.resize(polled.count()+1);
+            items[0].socket=wakeupReceiver;
+            items[0].fd=0;
+            items[0].events=ZMQ_POLLIN;
+            items[0].revents=0;
+            changed=false;
+        }
+        for (int i=0;i<polled.count();i++){
+            // the socket of a stream changes on bsr_reconnect
+            items[i+1].socket=polled.at(i)->getZmqsocket();
+            items[i+1].fd=0;
+            items[i+1].events=ZMQ_POLLIN;
+            items[i+1].revents=0;
+        }
+
+        int rc=zmq_poll(items.data(),items.count(),-1);
+        if (rc<0){
+            if (zmq_errno()==ETERM) break;
+            continue;
+        }
+        if (items[0].revents & ZMQ_POLLIN){
+            while (zmq_recv(wakeupReceiver,buffer,sizeof(buffer),ZMQ_DONTWAIT)>=0);
+        }
+        for (int i=0;i<polled.count();i++){
+            if (items[i+1].revents & ZMQ_POLLIN){
+                polled.at(i)->receiveMessages(MAX_MESSAGES_PER_WAKEUP);
+                if (polled.at(i)->getTerminate()) changed=true;
+            }
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    foreach(bsread_Decode *decoder, decoders) decoder->closeConnection();
+    foreach(bsread_Decode *decoder, removePipeline) decoder->closeConnection();
+    decoders.clear();
+    removePipeline.clear();
+    if (wakeupReceiver) zmq_close(wakeupReceiver);
+    wakeupReceiver=NULL;
+    running=false;
+    requestDone.wakeAll();
+    locker.unlock();
+
+    emit finished();
+    qDebug() << "bsread ZMQ Poller terminate";
+}
@@ -0,0 +1,72 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2015
+ *
+ *  Author:
+ *    Helge Brands
+ *  Contact details:
+ *    helge.brands@psi.ch
+ */
+#ifndef BSREAD_POLLER_H
+#define BSREAD_POLLER_H
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include "bsread_decode.h"
+
+/*
+ * one poller thread serves the zmq sockets of many bsread_Decode streams:
+ * it blocks in zmq_poll until data arrives on one of them, or until it is
+ * woken up through an inproc socket for adding/removing streams or termination.
+ * The sockets are created, used and closed only in the poller thread.
+ */
+class bsread_Poller : public QObject
+{
+    Q_OBJECT
+public:
+    bsread_Poller(void * Context);
+    ~bsread_Poller();
+
+    void addDecoder(bsread_Decode *decoder);
+    void removeDecoder(bsread_Decode *decoder);
+    void setTerminate();
+    QString getStatistics();
+
+public slots:
+    void process();
+signals:
+    void finished();
+private:
+    bool handleRequests();
+    void wakeup();
+
+    void * context;
+    void * wakeupSender;
+    void * wakeupReceiver;
+    bool terminate;
+    bool running;
+    QMutex mutex;
+    QWaitCondition requestDone;
+    QList<bsread_Decode*> decoders;
+    QList<bsread_Decode*> addPipeline;
+    QList<bsread_Decode*> removePipeline;
+};
+
+#endif // BSREAD_POLLER_H
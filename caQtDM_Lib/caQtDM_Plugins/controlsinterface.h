@@ -73,6 +73,12 @@ public:
     virtual int pvDisconnect(knobData *kData) = 0;
     virtual int FlushIO() = 0;
     virtual int TerminateIO() = 0;
+
+    // short statistics text of the plugin, shown in the status bar
+    virtual bool pvGetStatistics(QString &statistics) {
+        Q_UNUSED(statistics);
+        return false;
+    }
 };
 
 QT_BEGIN_NAMESPACE
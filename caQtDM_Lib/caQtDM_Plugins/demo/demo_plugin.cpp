@@ -65,12 +65,14 @@ void DemoPlugin::updateInterface()
                 newValue = i.value();
                 break;
             }
-            // update some data
+            // update some data, in place changes are enclosed for the snapshots of the knobs
+            mutexknobdataP->BeginMutexKnobDataWrite(index);
             kData->edata.rvalue = newValue;
             kData->edata.fieldtype = caDOUBLE;
             kData->edata.connected = true;
             kData->edata.accessR = kData->edata.accessW = true;
             kData->edata.monitorCount++;
+            mutexknobdataP->EndMutexKnobDataWrite(index);
             mutexknobdataP->SetMutexKnobData(kData->index, *kData);
             mutexknobdataP->SetMutexKnobDataReceived(kData);
         }
@@ -40,28 +40,54 @@ cout << "CallbackThread::~CallbackThread() returning\n";
 
 void CallbackThread::run()
 {
-    CallbackRequesterPtr callbackRequester;
     while(true) 
     {
-        epicsThreadSleep(.2);
+        // wake up as soon as something is queued, the timeout only bounds the stop latency
+        queueEvent.wait(.2);
         if(runStop.tryWait()) {
             runReturn.signal();
             return;
         }    
-        {
-             epics::pvData::Lock xx(mutex);
-             if(monitorQueue.empty()) continue;
-             callbackRequester = monitorQueue.front();
-             monitorQueue.pop();
-        }
-        while(callbackRequester) {
+        while(true) {
+            CallbackRequesterPtr callbackRequester;
+            {
+                epics::pvData::Lock xx(mutex);
+                if(monitorQueue.empty()) break;
+                queueEntry entry = monitorQueue.front();
+                monitorQueue.pop();
+                callbackRequester = entry.requester;
+                // from now on a new request for this requester has to be queued again
+                callbackRequester->callbackQueued = false;
+                epicsTimeStamp now;
+                epicsTimeGetCurrent(&now);
+                double latency = epicsTimeDiffInSeconds(&now, &entry.queued);
+                latencySum += latency;
+                if(latency > maxLatency) maxLatency = latency;
+                processed++;
+            }
             callbackRequester->callback();
-            epics::pvData::Lock xx(mutex);
-            if(monitorQueue.empty()) break;
-            callbackRequester = monitorQueue.front();
-            monitorQueue.pop();
         }
     }
 }
 
+callbackStatistics CallbackThread::getStatistics(bool reset)
+{
+    callbackStatistics statistics;
+    epics::pvData::Lock xx(mutex);
+    statistics.queueDepth = monitorQueue.size();
+    statistics.maxQueueDepth = maxQueueDepth;
+    statistics.processed = processed;
+    statistics.coalesced = coalesced;
+    statistics.avgLatency = (processed > 0) ? latencySum / (double) processed : 0.0;
+    statistics.maxLatency = maxLatency;
+    if(reset) {
+        maxQueueDepth = monitorQueue.size();
+        processed = 0;
+        coalesced = 0;
+        latencySum = 0.0;
+        maxLatency = 0.0;
+    }
+    return statistics;
+}
+
 }}
@@ -28,6 +28,7 @@
 
 #include <queue>
 #include <epicsThread.h>
+#include <epicsTime.h>
 #include <pv/event.h>
 
 
@@ -43,21 +44,54 @@ typedef std::tr1::shared_ptr<CallbackRequester> CallbackRequesterPtr;
 class epicsShareClass CallbackRequester
 {
 public:
+    CallbackRequester() : callbackQueued(false) {}
     virtual ~CallbackRequester(){}
     virtual void callback() = 0;
+private:
+    friend class CallbackThread;
+    bool callbackQueued;        // guarded by the mutex of the CallbackThread
 };
 
 class CallbackThread;
 typedef std::tr1::shared_ptr<CallbackThread> CallbackThreadPtr;
 
+/*
+ * statistics of the callback queue, latency is the time in seconds
+ * between queueing a request and the start of its callback
+ */
+typedef struct _callbackStatistics {
+    size_t queueDepth;
+    size_t maxQueueDepth;
+    size_t processed;
+    size_t coalesced;
+    double avgLatency;
+    double maxLatency;
+} callbackStatistics;
+
+/*
+ * a requester is queued at most once: queueing it again while it is still
+ * waiting is coalesced into the pending entry, the queue is therefore bounded
+ * by the number of requesters and superseded requests are never run twice
+ */
 class epicsShareClass  CallbackThread :
     public epicsThreadRunable
 {
-    std::queue<CallbackRequesterPtr> monitorQueue;
+    typedef struct _queueEntry {
+        CallbackRequesterPtr requester;
+        epicsTimeStamp queued;
+    } queueEntry;
+
+    std::queue<queueEntry> monitorQueue;
     std::tr1::shared_ptr<epicsThread> thread;
     epics::pvData::Mutex mutex;
     epics::pvData::Event runStop;
     epics::pvData::Event runReturn;
+    epics::pvData::Event queueEvent;
+    size_t maxQueueDepth;
+    size_t processed;
+    size_t coalesced;
+    double latencySum;
+    double maxLatency;
 public:
     POINTER_DEFINITIONS(CallbackThread);
     ~CallbackThread();
@@ -71,11 +105,31 @@ public:
             epicsThreadPriorityLow));
          thread->start();
     }
-    void queueRequest(CallbackRequesterPtr const & callbackRequester)
+    // returns false when the request was coalesced with an already pending one
+    bool queueRequest(CallbackRequesterPtr const & callbackRequester)
+    {
+        {
+            epics::pvData::Lock xx(mutex);
+            if(callbackRequester->callbackQueued) {
+                coalesced++;
+                return false;
+            }
+            callbackRequester->callbackQueued = true;
+            queueEntry entry;
+            entry.requester = callbackRequester;
+            epicsTimeGetCurrent(&entry.queued);
+            monitorQueue.push(entry);
+            if(monitorQueue.size() > maxQueueDepth) maxQueueDepth = monitorQueue.size();
+        }
+        queueEvent.signal();
+        return true;
+    }
+    void addCoalesced(size_t count)
     {
         epics::pvData::Lock xx(mutex);
-        monitorQueue.push(callbackRequester);
+        coalesced += count;
     }
+    callbackStatistics getStatistics(bool reset);
     static CallbackThreadPtr create()
     {
          CallbackThreadPtr t(new CallbackThread());
@@ -85,10 +139,16 @@ public:
     void stop()
     {
         runStop.signal();
+        queueEvent.signal();
         runReturn.wait();
     }
 private:
     CallbackThread()
+    : maxQueueDepth(0),
+      processed(0),
+      coalesced(0),
+      latencySum(0.0),
+      maxLatency(0.0)
     {}
 };
 
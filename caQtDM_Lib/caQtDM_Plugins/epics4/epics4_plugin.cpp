@@ -148,6 +148,9 @@ class PVAMonitorRequester;
 typedef std::tr1::shared_ptr<PVAMonitorRequester> PVAMonitorRequesterPtr;
 typedef std::tr1::weak_ptr<PVAMonitorRequester> PVAMonitorRequesterWPtr;
 
+class PVAMonitorCallback;
+typedef std::tr1::shared_ptr<PVAMonitorCallback> PVAMonitorCallbackPtr;
+
 class epicsShareClass PVAInterface :
     public CallbackRequester,
     public std::tr1::enable_shared_from_this<PVAInterface>
@@ -169,6 +172,15 @@ private:
          enum_t,
          createMonitor_t
     };
+
+    // offset range [offset, nextOffset) of a monitored field, resolved once per monitor
+    struct FieldOffset {
+        bool valid;
+        size_t offset;
+        size_t nextOffset;
+        FieldOffset() : valid(false), offset(0), nextOffset(0) {}
+    };
+
     PVAChannelPtr pvaChannel;
     bool gotFirstConnection;
     bool putFinished;
@@ -198,6 +210,20 @@ private:
     PVAChannelPutRequesterPtr pvaChannelPutRequester;
     BitSetPtr putBitSet;
     PVAMonitorRequesterPtr pvaMonitorRequester;
+    PVAMonitorCallbackPtr pvaMonitorCallback;
+    int monitorQueueSize;
+    bool monitorPipeline;
+    bool monitorLayoutValid;
+    FieldOffset alarmField;
+    FieldOffset timeStampField;
+    FieldOffset valueField;
+    FieldOffset enumIndexField;
+
+    void cacheFieldOffsets(PVStructurePtr const & pvStructure);
+    static FieldOffset getFieldOffset(PVStructurePtr const & pvStructure, const string & name);
+    static bool fieldChanged(BitSetPtr const & changed, FieldOffset const & field);
+    void getAlarmData(PVStructurePtr const & pvStructure);
+    void getTimeStampData(PVStructurePtr const & pvStructure);
 public:
     POINTER_DEFINITIONS(PVAInterface);
     PVAInterface(
@@ -205,7 +231,9 @@ public:
         MutexKnobData *mutexKnobData,
         int index,
         Epics4RequesterPtr const & requester,
-        CallbackThreadPtr const & callbackThread);
+        CallbackThreadPtr const & callbackThread,
+        int monitorQueueSize,
+        bool monitorPipeline);
     virtual ~PVAInterface();
     void destroy();
     void clearMonitor();
@@ -236,6 +264,7 @@ public:
         Structure::const_shared_pointer const & structure);
     void unlisten(MonitorPtr const & monitor);
     void monitorEvent(MonitorPtr const & monitor);
+    void processMonitorQueue();
     // for pvaChannelPut
     void channelPutConnect(
         const Status& status,
@@ -471,6 +500,27 @@ public:
     }
 };
 
+// queued on the callback thread by monitorEvent, decodes all pending monitor elements
+class epicsShareClass PVAMonitorCallback : public CallbackRequester
+{
+    PVAInterfaceWPtr pvaInterface;
+public:
+    PVAMonitorCallback(
+        PVAInterfacePtr const & pvaInterface)
+    : pvaInterface(pvaInterface)
+    {}
+    virtual ~PVAMonitorCallback() {
+        if(Epics4Plugin::getDebug()) std::cout << "~PVAMonitorCallback" << std::endl;
+    }
+
+    virtual void callback()
+    {
+        PVAInterfacePtr interface(pvaInterface.lock());
+        if(!interface) return;
+        interface->processMonitorQueue();
+    }
+};
+
 
 PVAChannel::PVAChannel(
          const string & fullName,
@@ -630,7 +680,9 @@ PVAInterface::PVAInterface(
         MutexKnobData *mutexKnobData,
         int index,
         Epics4RequesterPtr const & requester,
-        CallbackThreadPtr const & callbackThread)
+        CallbackThreadPtr const & callbackThread,
+        int monitorQueueSize,
+        bool monitorPipeline)
 : pvaChannel(pvaChannel),
   gotFirstConnection(false),
   putFinished(true),
@@ -644,7 +696,10 @@ PVAInterface::PVAInterface(
   gotFirstConnect(false),
   normativeType(ntunknown_t),
   callbackType(unknown_t),
-  convert(getConvert())
+  convert(getConvert()),
+  monitorQueueSize(monitorQueueSize),
+  monitorPipeline(monitorPipeline),
+  monitorLayoutValid(false)
 {
      if(Epics4Plugin::getDebug()) cout << "PVAInterface::PVAInterface()\n";
 }
@@ -799,10 +854,13 @@ void PVAInterface::monitorConnect(
         Monitor::shared_pointer const & monitor,
         Structure::const_shared_pointer const & structure)
 {
-    Q_UNUSED(structure);
     if(Epics4Plugin::getDebug()) cout << " PVAInterface::monitorConnect\n";
     if(status.isOK()) {
+       // the layout of the monitored structure is fixed for the lifetime of the monitor,
+       // so resolve the offsets of the fields we decode only once
+       if(structure) cacheFieldOffsets(getPVDataCreate()->createPVStructure(structure));
        Lock lock(mutex);
+       this->monitor = monitor;
        if(!monitorStarted) {
            monitor->start();
            monitorStarted = true;
@@ -823,44 +881,125 @@ void PVAInterface::unlisten(MonitorPtr const & monitor)
 
 void PVAInterface::monitorEvent(MonitorPtr const & monitor)
 {
+    Q_UNUSED(monitor);
     if(Epics4Plugin::getDebug()) cout << " PVAInterface::monitorEvent\n";
+    // decoding is done on the callback thread, when a decode is already pending for
+    // this channel the new elements will be picked up by it
+    if(pvaMonitorCallback) callbackThread->queueRequest(pvaMonitorCallback);
+}
+
+void PVAInterface::processMonitorQueue()
+{
+    MonitorPtr pvaMonitor;
+    {
+        Lock lock(mutex);
+        pvaMonitor = monitor;
+    }
+    if(!pvaMonitor) return;
+
+    std::vector<MonitorElementPtr> elements;
     while(true) {
-        MonitorElementPtr monitorElement(monitor->poll());
+        MonitorElementPtr monitorElement(pvaMonitor->poll());
         if(!monitorElement) break;
-        PVStructurePtr pvStructure = monitorElement->pvStructurePtr;
+        elements.push_back(monitorElement);
+    }
+    if(elements.empty()) return;
+    if(!monitorLayoutValid) cacheFieldOffsets(elements[0]->pvStructurePtr);
+
+    // for every field only the newest element that changed it has to be decoded,
+    // older values are superseded
+    int alarmElement = -1;
+    int timeStampElement = -1;
+    int valueElement = -1;
+    for(size_t i = 0; i < elements.size(); ++i) {
+        BitSetPtr changed = elements[i]->changedBitSet;
+        if(fieldChanged(changed, alarmField)) alarmElement = (int) i;
+        if(fieldChanged(changed, timeStampField)) timeStampElement = (int) i;
+        if(fieldChanged(changed, valueField)) valueElement = (int) i;
+    }
+    if(elements.size() > 1) callbackThread->addCoalesced(elements.size() - 1);
+
+    if(alarmElement >= 0 || timeStampElement >= 0 || valueElement >= 0) {
         kData = mutexKnobData->GetMutexKnobData(index);
-        if(kData.index == -1) return;
-        mutexKnobData->DataLock(&kData);
-        bool gotAlarm = false;
-        if(structure->getField("alarm")) gotAlarm = true;
-        if(gotAlarm) {
-            PVFieldPtr pvField = pvStructure->getSubField<PVStructure>("alarm");
-            Alarm alarm;
-            PVAlarm pvAlarm;
-            pvAlarm.attach(pvField);
-            pvAlarm.get(alarm);
-            kData.edata.severity = alarm.getSeverity();
-        }
-        bool gotTimeStamp = false;
-        if(structure->getField("alarm")) gotTimeStamp = true;
-        if(gotTimeStamp) {
-            PVFieldPtr pvField = pvStructure->getSubField<PVStructure>("timeStamp");
-            PVTimeStamp pvTimeStamp;
-            pvTimeStamp.attach(pvField);
-            pvTimeStamp.get(timeStamp);
-        }
-        switch (normativeType) {
-            case ntscalar_t : getScalarData(pvStructure); break;
-            case ntenum_t : getEnumData(pvStructure); break;
-            case ntscalararray_t : getScalarArrayData(pvStructure); break;
-            default: throw std::runtime_error("PVAInterface::event logic error");
+        if(kData.index != -1) {
+            mutexKnobData->DataLock(&kData);
+            if(alarmElement >= 0) getAlarmData(elements[alarmElement]->pvStructurePtr);
+            if(timeStampElement >= 0) getTimeStampData(elements[timeStampElement]->pvStructurePtr);
+            if(valueElement >= 0) {
+                PVStructurePtr pvStructure = elements[valueElement]->pvStructurePtr;
+                switch (normativeType) {
+                    case ntscalar_t : getScalarData(pvStructure); break;
+                    case ntenum_t : getEnumData(pvStructure); break;
+                    case ntscalararray_t : getScalarArrayData(pvStructure); break;
+                    default: break;
+                }
+            } else {
+                // severity change without new value has to be displayed too
+                kData.edata.monitorCount++;
+            }
+            //qDebug() << "update" << kData.pv << kData.index << kData.pluginFlavor << kData.dispName <<kData.edata.rvalue << kData.edata.ivalue;
+            mutexKnobData->SetMutexKnobDataReceived(&kData);
+
+            mutexKnobData->DataUnlock(&kData);
         }
-        //qDebug() << "update" << kData.pv << kData.index << kData.pluginFlavor << kData.dispName <<kData.edata.rvalue << kData.edata.ivalue;
-        mutexKnobData->SetMutexKnobDataReceived(&kData);
+    }
 
-        mutexKnobData->DataUnlock(&kData);
-        monitor->release(monitorElement);
+    // releasing the elements acknowledges them to the server when pipelining
+    for(size_t i = 0; i < elements.size(); ++i) pvaMonitor->release(elements[i]);
+}
+
+PVAInterface::FieldOffset PVAInterface::getFieldOffset(PVStructurePtr const & pvStructure, const string & name)
+{
+    FieldOffset field;
+    PVFieldPtr pvField = pvStructure->getSubField(name);
+    if(pvField) {
+        field.valid = true;
+        field.offset = pvField->getFieldOffset();
+        field.nextOffset = pvField->getNextFieldOffset();
     }
+    return field;
+}
+
+void PVAInterface::cacheFieldOffsets(PVStructurePtr const & pvStructure)
+{
+    if(!pvStructure) return;
+    alarmField = getFieldOffset(pvStructure, "alarm");
+    timeStampField = getFieldOffset(pvStructure, "timeStamp");
+    valueField = getFieldOffset(pvStructure, "value");
+    enumIndexField = getFieldOffset(pvStructure, "value.index");
+    monitorLayoutValid = true;
+}
+
+bool PVAInterface::fieldChanged(BitSetPtr const & changed, FieldOffset const & field)
+{
+    if(!field.valid) return false;
+    if(!changed) return true;
+    // bit 0 is the top level structure, everything changed
+    if(changed->get(0)) return true;
+    int32 bit = changed->nextSetBit((uint32) field.offset);
+    return (bit >= 0 && (size_t) bit < field.nextOffset);
+}
+
+void PVAInterface::getAlarmData(PVStructurePtr const & pvStructure)
+{
+    PVFieldPtr pvField = pvStructure->getSubField(alarmField.offset);
+    if(!pvField) return;
+    Alarm alarm;
+    PVAlarm pvAlarm;
+    if(pvAlarm.attach(pvField)) {
+        pvAlarm.get(alarm);
+        int sev = alarm.getSeverity();
+        kData.edata.severity = sev;
+        kData.edata.status = (sev==0 ? 0 : 17);
+    }
+}
+
+void PVAInterface::getTimeStampData(PVStructurePtr const & pvStructure)
+{
+    PVFieldPtr pvField = pvStructure->getSubField(timeStampField.offset);
+    if(!pvField) return;
+    PVTimeStamp pvTimeStamp;
+    if(pvTimeStamp.attach(pvField)) pvTimeStamp.get(timeStamp);
 }
 
 void PVAInterface::channelPutConnect(
@@ -1137,9 +1276,27 @@ void PVAInterface::createMonitor()
     if(Epics4Plugin::getDebug()) cout << "PVAInterface::createMonitor()\n";
     try {
        if(normativeType==ntunknown_t) return;
-       string request("value,alarm,timeStamp");
-       if(normativeType==ntenum_t) request = "alarm,timeStamp,value.index";
+       string fields("value,alarm,timeStamp");
+       if(normativeType==ntenum_t) fields = "alarm,timeStamp,value.index";
+       string request("field(" + fields + ")");
+       string options;
+       if(monitorQueueSize > 0) {
+           char asc[40];
+           snprintf(asc, 40, "queueSize=%d", monitorQueueSize);
+           options += asc;
+       }
+       if(monitorPipeline) {
+           if(!options.empty()) options += ",";
+           options += "pipeline=true";
+       }
+       if(!options.empty()) request = "record[" + options + "]" + request;
+       if(Epics4Plugin::getDebug()) cout << "PVAInterface::createMonitor() request " << request << endl;
        PVStructurePtr pvRequest = createRequest->createRequest(request);
+       if(!pvRequest) {
+           message(createRequest->getMessage() + " createRequest failed", errorMessage);
+           return;
+       }
+       pvaMonitorCallback = PVAMonitorCallbackPtr(new PVAMonitorCallback(shared_from_this()));
        pvaMonitorRequester = PVAMonitorRequesterPtr(new PVAMonitorRequester(shared_from_this()));
        monitor = pvaChannel->getChannel()->createMonitor(pvaMonitorRequester,pvRequest);
        gotFirstConnect = true;
@@ -1159,24 +1316,11 @@ void PVAInterface::gotMonitor()
 void PVAInterface::getScalarData(PVStructurePtr const & pvStructure)
 {
     if(Epics4Plugin::getDebug()) cout << "getScalarData " << kData.pv << endl;
-    PVScalarPtr pvScalar = pvStructure->getSubField<PVScalar>("value");
+    PVScalarPtr pvScalar = std::tr1::dynamic_pointer_cast<PVScalar>(pvStructure->getSubField(valueField.offset));
     if(!pvScalar) {
         cout << "PVAInterface::getScalarData pvStructure \n" << pvStructure << endl; return;
     }
-    
-    PVFieldPtr pvAlarmField = pvStructure->getSubField<PVStructure>("alarm");
-    if(pvAlarmField) {
-       Alarm alarm;
-       PVAlarm pvAlarm; 
-       bool result;
-       result = pvAlarm.attach(pvAlarmField);
-       if(result) {
-            pvAlarm.get(alarm);
-            int sev = alarm.getSeverity();
-            kData.edata.severity = sev;
-            kData.edata.status = (sev==0 ? 0 : 17);
-       }
-    }
+
     ScalarType scalarType = pvScalar->getScalar()->getScalarType();
 
     switch (scalarType) {
@@ -1260,20 +1404,9 @@ void PVAInterface::getScalarData(PVStructurePtr const & pvStructure)
 
 void PVAInterface::getEnumData(PVStructurePtr const & pvStructure)
 {
-    PVFieldPtr pvAlarmField = pvStructure->getSubField<PVStructure>("alarm");
-    if(pvAlarmField) {
-       Alarm alarm;
-       PVAlarm pvAlarm; 
-       bool result;
-       result = pvAlarm.attach(pvAlarmField);
-       if(result) {
-            pvAlarm.get(alarm);
-            int sev = alarm.getSeverity();
-            kData.edata.severity = sev;
-            kData.edata.status = (sev==0 ? 0 : 17);
-       }
-    }
-     int32 index = pvStructure->getSubField<PVInt>("value.index")->get();
+    PVIntPtr pvIndex = std::tr1::dynamic_pointer_cast<PVInt>(pvStructure->getSubField(enumIndexField.offset));
+    if(!pvIndex) return;
+     int32 index = pvIndex->get();
      kData.edata.ivalue = index;
      kData.edata.rvalue = index;
      kData.edata.valueCount = 1;
@@ -1299,7 +1432,8 @@ void PVAInterface::fillData(pureData const &array, size_t length, knobData* kPtr
 void PVAInterface::getScalarArrayData(PVStructurePtr const & pvStructure)
 {
 
-    PVScalarArrayPtr pva = pvStructure->getSubField<PVScalarArray>("value");
+    PVScalarArrayPtr pva = std::tr1::dynamic_pointer_cast<PVScalarArray>(pvStructure->getSubField(valueField.offset));
+    if(!pva) return;
     ScalarArrayConstPtr scalar = pva->getScalarArray();
     ScalarType scalarType = scalar->getElementType();
     int length = pva->getLength();
@@ -1747,6 +1881,12 @@ int Epics4Plugin::pvAddMonitor(int index, knobData *kData, int rate, int skip)
     if(pvaInterfaceGlue) throw std::runtime_error("Epics4Plugin::pvAddMonitor already added");
     string channelName(kData->pv);
     string providerName(kData->pluginFlavor);
+
+    // monitor request options were split off the channel name: queueSize=4&pipeline=true
+    int queueSize = 0;
+    bool pipeline = false;
+    string monitorOptions(kData->pluginOptions);
+    if(!monitorOptions.empty()) parseMonitorOptions(monitorOptions, queueSize, pipeline);
     string fullname(providerName+"://"+channelName);
 
     if(Epics4Plugin::getDebug()) {
@@ -1776,7 +1916,7 @@ int Epics4Plugin::pvAddMonitor(int index, knobData *kData, int rate, int skip)
         if(Epics4Plugin::getDebug())cout << "created new and called connect\n";
     }
     PVAInterfacePtr pvaInterface(
-         new PVAInterface(pvaChannel, mutexKnobData,index,requester,callbackThread));
+         new PVAInterface(pvaChannel, mutexKnobData,index,requester,callbackThread,queueSize,pipeline));
     pvaInterfaceGlue = new PVAInterfaceGlue(pvaInterface);
     kData->edata.info = pvaInterfaceGlue;
     C_SetMutexKnobData(mutexKnobData, index, *kData);
@@ -1786,6 +1926,40 @@ int Epics4Plugin::pvAddMonitor(int index, knobData *kData, int rate, int skip)
 }
 
 
+void Epics4Plugin::parseMonitorOptions(const string & options, int & queueSize, bool & pipeline)
+{
+    size_t start = 0;
+    while(start < options.length()) {
+        size_t end = options.find('&', start);
+        if(end == string::npos) end = options.length();
+        string option = options.substr(start, end - start);
+        string::size_type eq = option.find('=');
+        if(eq != string::npos) {
+            string key = option.substr(0, eq);
+            string value = option.substr(eq+1);
+            if(key == "queueSize") {
+                queueSize = atoi(value.c_str());
+                if(queueSize < 0) queueSize = 0;
+            } else if(key == "pipeline") {
+                pipeline = (value == "true" || value == "1");
+            } else {
+                requester->message("unknown monitor option " + key, warningMessage);
+            }
+        }
+        start = end + 1;
+    }
+}
+
+bool Epics4Plugin::pvGetStatistics(QString &statistics)
+{
+    if(!callbackThread) return false;
+    callbackStatistics stat = callbackThread->getStatistics(true);
+    statistics = QString("pva queue=%1 (max %2), coalesced=%3, latency avg=%4ms max=%5ms")
+            .arg(stat.queueDepth).arg(stat.maxQueueDepth).arg(stat.coalesced)
+            .arg(stat.avgLatency * 1000.0, 0, 'f', 1).arg(stat.maxLatency * 1000.0, 0, 'f', 1);
+    return true;
+}
+
 int Epics4Plugin::pvClearMonitor(knobData *kData) {
     if(Epics4Plugin::getDebug()) cout << "Epics4Plugin:pvClearMonitor\n";
     if (kData->edata.info == (void *) 0)
@@ -119,11 +119,13 @@ public:
     int pvDisconnect(knobData *kData);
     int FlushIO();
     int TerminateIO();
+    bool pvGetStatistics(QString &statistics);
     static void setDebug(bool value) {debug = value;}
     static bool getDebug() {return debug;}
 
 
   private:
+    void parseMonitorOptions(const std::string & options, int & queueSize, bool & pipeline);
     static bool debug;
     std::map<std::string,epics::caqtdm::epics4::PVAChannelWPtr> pvaChannelMap;
     epics::caqtdm::epics4::Epics4RequesterPtr requester;
@@ -0,0 +1,215 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <QTabWidget>
+#include <QTabBar>
+#include <QTimer>
+#include "alarmdefs.h"
+#include "caframe.h"
+#include "cainclude.h"
+
+#include "alarmTree.h"
+
+AlarmTree::AlarmTree(QObject *parent, QWidget *root) : QObject(parent)
+{
+    this->root = root;
+}
+
+AlarmTree::~AlarmTree()
+{
+    qDeleteAll(nodes);
+    nodes.clear();
+}
+
+/**
+ * find the containers that want an alarm summary, also called for includes loaded later on
+ */
+void AlarmTree::addContainers(QWidget *parent)
+{
+    QList<QWidget *> all = parent->findChildren<QWidget *>();
+    foreach(QWidget *w, all) {
+        if(!w->property("alarmSummary").toBool()) continue;
+        if(QTabWidget *tabWidget = qobject_cast<QTabWidget *>(w)) {
+            for(int i=0; i < tabWidget->count(); i++) addNode(tabWidget->widget(i), tabWidget, tabWidget->widget(i));
+        } else if(qobject_cast<caFrame *>(w) != (caFrame *) 0 || qobject_cast<caInclude *>(w) != (caInclude *) 0) {
+            addNode(w, w, (QWidget *) 0);
+        }
+    }
+}
+
+void AlarmTree::addNode(QWidget *key, QWidget *container, QWidget *page)
+{
+    // a destroyed container may have left its node behind with the same address
+    alarmNode *node = nodes.value(key, (alarmNode *) 0);
+    if(node != (alarmNode *) 0 && !node->container.isNull()) return;
+    if(node == (alarmNode *) 0) {
+        node = new alarmNode;
+        node->dirty = false;
+        nodes.insert(key, node);
+    }
+    node->container = container;
+    node->page = page;
+    for(int i=0; i < SeverityLevels; i++) node->counts[i] = 0;
+    node->shown = NO_ALARM;
+    if(QTabWidget *tabWidget = qobject_cast<QTabWidget *>(container)) {
+        node->tabColor = tabWidget->tabBar()->tabTextColor(tabWidget->indexOf(page));
+    }
+}
+
+/**
+ * not connected counts like invalid
+ */
+int AlarmTree::Level(short severity)
+{
+    if(severity >= NO_ALARM && severity <= INVALID_ALARM) return severity;
+    return INVALID_ALARM;
+}
+
+int AlarmTree::Worst(const alarmNode *node)
+{
+    for(int i = SeverityLevels - 1; i > NO_ALARM; i--) {
+        if(node->counts[i] > 0) return i;
+    }
+    return NO_ALARM;
+}
+
+void AlarmTree::changeCount(alarmNode *node, int level, int delta)
+{
+    node->counts[level] += delta;
+    if(!node->dirty && Worst(node) != node->shown) {
+        node->dirty = true;
+        if(dirtyNodes.isEmpty()) QTimer::singleShot(0, this, SLOT(applyIndicators()));
+        dirtyNodes.append(node);
+    }
+}
+
+/**
+ * a channel changed its severity, the containers of its widget are found once
+ */
+void AlarmTree::setSeverity(int indx, QWidget *w, short severity)
+{
+    if(nodes.isEmpty()) return;
+
+    QHash<int, alarmMember>::iterator it = members.find(indx);
+    if(it == members.end()) {
+        alarmMember member;
+        member.widget = w;
+        member.level = -1;
+        QWidget *widget = w->parentWidget();
+        while(widget != (QWidget *) 0 && widget != root) {
+            QHash<QWidget *, alarmNode *>::const_iterator node = nodes.constFind(widget);
+            if(node != nodes.constEnd()) member.nodes.append(node.value());
+            widget = widget->parentWidget();
+        }
+        it = members.insert(indx, member);
+
+        // a destroyed widget takes its channels out of the counts
+        QHash<QObject *, QList<int> >::iterator widget = widgetMembers.find(w);
+        if(widget == widgetMembers.end()) {
+            connect(w, SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)));
+            widgetMembers.insert(w, QList<int>() << indx);
+        } else {
+            widget.value().append(indx);
+        }
+    }
+
+    alarmMember &member = it.value();
+    int level = Level(severity);
+    if(level == member.level) return;
+    foreach(alarmNode *node, member.nodes) {
+        if(member.level >= 0) changeCount(node, member.level, -1);
+        changeCount(node, level, 1);
+    }
+    member.level = level;
+}
+
+/**
+ * the knob was cleared or its index is going to be used for another channel
+ */
+void AlarmTree::removeMember(int indx)
+{
+    QHash<int, alarmMember>::iterator it = members.find(indx);
+    if(it == members.end()) return;
+    if(it.value().level >= 0) {
+        foreach(alarmNode *node, it.value().nodes) changeCount(node, it.value().level, -1);
+    }
+    QHash<QObject *, QList<int> >::iterator widget = widgetMembers.find(it.value().widget);
+    if(widget != widgetMembers.end()) {
+        widget.value().removeOne(indx);
+        if(widget.value().isEmpty()) {
+            disconnect(widget.key(), SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)));
+            widgetMembers.erase(widget);
+        }
+    }
+    members.erase(it);
+}
+
+void AlarmTree::widgetDestroyed(QObject *widget)
+{
+    QList<int> indexes = widgetMembers.take(widget);
+    foreach(int indx, indexes) {
+        QHash<int, alarmMember>::iterator it = members.find(indx);
+        if(it == members.end() || it.value().widget != widget) continue;
+        if(it.value().level >= 0) {
+            foreach(alarmNode *node, it.value().nodes) changeCount(node, it.value().level, -1);
+        }
+        members.erase(it);
+    }
+}
+
+void AlarmTree::applyIndicators()
+{
+    foreach(alarmNode *node, dirtyNodes) {
+        node->dirty = false;
+        int worst = Worst(node);
+        if(worst == node->shown || node->container.isNull()) continue;
+        node->shown = worst;
+
+        QColor color;
+        switch (worst) {
+        case MINOR_ALARM:
+            color = AL_YELLOW;
+            break;
+        case MAJOR_ALARM:
+            color = AL_RED;
+            break;
+        case INVALID_ALARM:
+            color = AL_WHITE;
+            break;
+        default:
+            break;
+        }
+
+        if(caFrame *frameWidget = qobject_cast<caFrame *>(node->container)) {
+            frameWidget->setAlarmColor(color);
+        } else if(caInclude *includeWidget = qobject_cast<caInclude *>(node->container)) {
+            includeWidget->setAlarmColor(color);
+        } else if(QTabWidget *tabWidget = qobject_cast<QTabWidget *>(node->container)) {
+            int index = tabWidget->indexOf(node->page);
+            if(index >= 0) tabWidget->tabBar()->setTabTextColor(index, color.isValid() ? color : node->tabColor);
+        }
+    }
+    dirtyNodes.clear();
+}
@@ -0,0 +1,90 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef ALARMTREE_H
+#define ALARMTREE_H
+
+#include <QObject>
+#include <QWidget>
+#include <QPointer>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QColor>
+
+/**
+ * worst severity of the channels inside a caFrame, caInclude or tab page with the dynamic
+ * property alarmSummary set; the counts of every container are updated incrementally when a
+ * channel changes its severity and the indicators are redrawn once for a batch of changes
+ */
+class AlarmTree : public QObject
+{
+    Q_OBJECT
+
+public:
+    AlarmTree(QObject *parent, QWidget *root);
+    ~AlarmTree();
+
+    void addContainers(QWidget *parent);
+    bool isEmpty() const { return nodes.isEmpty(); }
+
+    void setSeverity(int indx, QWidget *w, short severity);
+    void removeMember(int indx);
+
+private slots:
+    void applyIndicators();
+    void widgetDestroyed(QObject *widget);
+
+private:
+    enum {SeverityLevels = 4};
+
+    typedef struct _alarmNode {
+        QPointer<QWidget> container;       // caFrame, caInclude or QTabWidget
+        QPointer<QWidget> page;            // page of a tab widget
+        int counts[SeverityLevels];        // members in each severity
+        int shown;                         // severity shown by the indicator
+        QColor tabColor;                   // tab text color before any alarm
+        bool dirty;
+    } alarmNode;
+
+    typedef struct _alarmMember {
+        QObject *widget;
+        int level;
+        QVector<alarmNode *> nodes;        // containers of the member, innermost first
+    } alarmMember;
+
+    static int Level(short severity);
+    static int Worst(const alarmNode *node);
+    void addNode(QWidget *key, QWidget *container, QWidget *page);
+    void changeCount(alarmNode *node, int level, int delta);
+
+    QWidget *root;
+    QHash<QWidget *, alarmNode *> nodes;   // keyed by the container or the tab page
+    QHash<int, alarmMember> members;       // keyed by the knob index
+    QHash<QObject *, QList<int> > widgetMembers;   // knob indexes of a widget
+    QList<alarmNode *> dirtyNodes;
+};
+
+#endif // ALARMTREE_H
@@ -66,6 +66,7 @@
 
 #include "caqtdm_lib.h"
 #include "parsepepfile.h"
+#include "myParser.h"
 #include "fileFunctions.h"
 
 #include "myMessageBox.h"
@@ -291,8 +292,8 @@ CaQtDM_Lib::~CaQtDM_Lib()
 {
 
     disconnect(mutexKnobDataP,
-               SIGNAL(Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobData)), this,
-               SLOT(Callback_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobData)));
+               SIGNAL(Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobUpdate)), this,
+               SLOT(Callback_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobUpdate)));
 
     //if(!fromAS) delete myWidget;
     includeWidgetList.clear();
@@ -320,6 +321,9 @@ CaQtDM_Lib::CaQtDM_Lib(QWidget *parent, QString filename, QString macro, MutexKn
     firstResize = true;
     loopTimer = 0;
     prcFile = false;
+    frameScheduler = (FrameScheduler *) 0;
+    alarmTree = (AlarmTree *) 0;
+    updateStatistics = false;
 
     // for cainclude, we need when updating internal positions to know about the resize factors
     this->setProperty("RESIZEX", 1.0);
@@ -417,6 +421,27 @@ CaQtDM_Lib::CaQtDM_Lib(QWidget *parent, QString filename, QString macro, MutexKn
                 return;
             }
 
+            // MEDM file converted in memory
+        } else if(filename.lastIndexOf(".adl") != -1) {
+
+            QString message;
+            QByteArray uiData = adlConverter::uiFromAdl(filename, message);
+            if(!uiData.isEmpty()) {
+                QBuffer buffer(&uiData);
+                buffer.open(QIODevice::ReadOnly);
+                myWidget = loader.load(&buffer, this);
+                buffer.close();
+            } else {
+                postMessage(QtDebugMsg, (char*) qasc(tr("can't convert file %1: %2").arg(filename).arg(message)));
+            }
+
+            if (!myWidget) {
+                QMessageBox::warning(this, tr("caQtDM"), tr("Error loading %1").arg(filename));
+                delete file;
+                this->deleteLater();
+                return;
+            }
+
         } else {
             qDebug() << "caQtDM -- internal error with fileName= " << filename;
             this->deleteLater();
@@ -483,14 +508,15 @@ CaQtDM_Lib::CaQtDM_Lib(QWidget *parent, QString filename, QString macro, MutexKn
     connect(this, SIGNAL(Signal_ReloadAllWindows()), parent, SLOT(Callback_ReloadAllWindows()));
 
     qRegisterMetaType<knobData>("knobData");
+    qRegisterMetaType<knobUpdate>("knobUpdate");
 
     // connect signals to slots for exchanging data
     connect(mutexKnobDataP, SIGNAL(Signal_QLineEdit(const QString&, const QString&)), this,
             SLOT(Callback_UpdateLine(const QString&, const QString&)));
 
     connect(mutexKnobDataP,
-            SIGNAL(Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobData)), this,
-            SLOT(Callback_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobData)));
+            SIGNAL(Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobUpdate)), this,
+            SLOT(Callback_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, knobUpdate)));
 
     if(!fromAS) {
         connect(this, SIGNAL(Signal_OpenNewWFile(const QString&, const QString&, const QString&, const QString&)), parent,
@@ -593,6 +619,22 @@ CaQtDM_Lib::CaQtDM_Lib(QWidget *parent, QString filename, QString macro, MutexKn
     // start a timer
     loopTimerID = startTimer(1000);
 
+    // repaints of this window are limited to a frame rate, by default the fastest channel rate
+    int frameRate = DEFAULTFRAMERATE;
+    option = options["framerate"];
+    if(!option.isEmpty()) frameRate = option.toInt();
+    if(fromAS) frameRate = 0;
+    frameScheduler = new FrameScheduler(this, frameRate, QString::compare(options["framestatistics"], "true", Qt::CaseInsensitive) == 0);
+    frameScheduler->deferPlots(myWidget);
+    frameScheduler->watchPaints(myWidget);
+
+    // the time spent in the widget updates of each class is only measured on request
+    updateStatistics = QString::compare(options["updatestatistics"], "true", Qt::CaseInsensitive) == 0;
+
+    // frames, includes and tabs with the property alarmSummary show the worst severity of their channels
+    alarmTree = new AlarmTree(this, myWidget);
+    alarmTree->addContainers(myWidget);
+
     // all interfaces flush io
     FlushAllInterfaces();
 
@@ -849,6 +891,9 @@ void CaQtDM_Lib::timerEvent(QTimerEvent *event)
 
     if(loopTimer == 5){
         EnableDisableIO();
+        if(frameScheduler != (FrameScheduler *) 0 && frameScheduler->hasStatistics()) {
+            printf("caQtDM -- %s: %s\n", qasc(windowTitle()), qasc(frameScheduler->getStatistics()));
+        }
         loopTimer = 0;
     }
     loopTimer++;
@@ -879,6 +924,7 @@ QString CaQtDM_Lib::actualizeMacroString(QMap<QString, QString> map, QString arg
     QMap<QString, QString> mapArgs = createMap(argument);
     if(!mapArgs.isEmpty()) {
         // go through macro string and replace the value when this key equals a key in the map
+        QList<replaceMacro *> all = myWidget->findChildren<replaceMacro *>();
         QMapIterator<QString, QString> i(mapArgs);
         while (i.hasNext()) {
             i.next();
@@ -887,7 +933,6 @@ QString CaQtDM_Lib::actualizeMacroString(QMap<QString, QString> map, QString arg
 
                 // only when a replacemacro uses this key with a value > 0
                 bool replace = false;
-                QList<replaceMacro *> all = myWidget->findChildren<replaceMacro *>();
                 foreach(replaceMacro* widget, all) {
                     //qDebug() << widget;
                     QString key =  widget->getKey();
@@ -929,14 +974,14 @@ QMap<QString, QString> CaQtDM_Lib::actualizeMacroMap()
     if(!macroString.isNull()) {
         map = createMap(macroString.toString());
         if(!map.isEmpty()) {
+            // go through all the children of type replaceMacro
+            QList<replaceMacro *> all = myWidget->findChildren<replaceMacro *>();
             QMapIterator<QString, QString> i(map);
             while (i.hasNext()) {
                 i.next();
                 QString macroName = i.key();
                 //qDebug() << "macroName" << macroName;
 
-                // go through all the children of type replaceMacro
-                QList<replaceMacro *> all = myWidget->findChildren<replaceMacro *>();
                 foreach(replaceMacro* widget, all) {
                     if(widget->isEnabled()) {
                         //qDebug() << widget;
@@ -1028,6 +1073,55 @@ void CaQtDM_Lib::scanWidgets(QList<QWidget*> list, QString macro)
     }
 }
 
+/**
+ * this routine builds the macro map for a macro string including the internal macros;
+ * the map is built once per macro string and file and then shared by all widgets using it
+ */
+QMap<QString, QString> CaQtDM_Lib::getMacroMap(const QString &macro)
+{
+    QString cacheKey = macro + "\n" + thisFileFull;
+    QHash<QString, QMap<QString, QString> >::const_iterator it = macroMapCache.constFind(cacheKey);
+    if(it != macroMapCache.constEnd()) return it.value();
+
+    QMap<QString, QString> map = createMap(macro);
+    // insert special macro into map
+    QString path = thisFileFull;
+    int pos = path.lastIndexOf("/");
+    if((pos > 0) && ((path.length() - pos -1) > 0)) path.chop(path.length() - pos -1);
+    map.insert("CAQTDM_INTERNAL_UIPATH", path);
+    map.insert("CAQTDM_INTERNAL_STARTTIME", QTime::currentTime().toString());
+    map.insert("CAQTDM_INTERNAL_STARTDATE", QDate::currentDate().toString("dd.MM.yyyy"));
+
+    map.insert("CAQTDM_INTERNAL_VERSION", TARGET_VERSION_STR);
+
+    QString message = QString("%1");
+    message = message.arg(QT_VERSION_STR);
+    map.insert("CAQTDM_INTERNAL_QTVERSION", message);
+
+    path =qApp->applicationFilePath();
+    pos = path.lastIndexOf("/");
+    if((pos > 0) && ((path.length() - pos -1) > 0)) path.chop(path.length() - pos -1);
+    map.insert("CAQTDM_INTERNAL_EXEPATH", path);
+
+    map.insert("CAQTDM_INTERNAL_PID",QString::number(qApp->applicationPid()));
+    map.insert("CAQTDM_INTERNAL_HOSTNAME", QHostInfo::localHostName());
+
+    map.insert("CAQTDM_INTERNAL_SCREENCOUNT",QString::number( qApp->desktop()->screenCount()));
+    map.insert("CAQTDM_INTERNAL_DPI",QString::number( qApp->desktop()->physicalDpiX())); //qApp->primaryScreen()->physicalDotsPerInch()));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    map.insert("CAQTDM_INTERNAL_REFRESHRATE",QString::number(qApp->primaryScreen()->refreshRate()));
+#endif
+    map.insert("CAQTDM_INTERNAL_DESKTOP_WIDTH",QString::number(qApp->desktop()->size().width()));
+    map.insert("CAQTDM_INTERNAL_DESKTOP_HEIGHT",QString::number(qApp->desktop()->size().height()));
+
+    map.insert("CAQTDM_INTERNAL_CA_ADDRLIST",qgetenv("EPICS_CA_ADDR_LIST"));
+    map.insert("CAQTDM_INTERNAL_BS_ADDRLIST",qgetenv("BSREAD_ZMQ_ADDR_LIST"));
+    map.insert("CAQTDM_INTERNAL_BS_DISPATCHER",qgetenv("BSREAD_DISPATCHER"));
+
+    macroMapCache.insert(cacheKey, map);
+    return map;
+}
+
 /**
  * this routine handles the initialization of all widgets
  */
@@ -1058,40 +1152,7 @@ void CaQtDM_Lib::HandleWidget(QWidget *w1, QString macro, bool firstPass, bool t
 
     if(className.contains("ca") || className.contains("QTextBrowser") || className.contains("replaceMacro") || className.contains("QTabWidget")) {
         PRINT(printf("\n%*c %s macro=<%s>", 15 * level, '+', qasc(w1->objectName()), qasc(macro)));
-        map = createMap(macro);
-        // insert special macro into map
-        QString path = thisFileFull;
-        int pos = path.lastIndexOf("/");
-        if((pos > 0) && ((path.length() - pos -1) > 0)) path.chop(path.length() - pos -1);
-        map.insert("CAQTDM_INTERNAL_UIPATH", path);
-        map.insert("CAQTDM_INTERNAL_STARTTIME", QTime::currentTime().toString());
-        map.insert("CAQTDM_INTERNAL_STARTDATE", QDate::currentDate().toString("dd.MM.yyyy"));
-
-        map.insert("CAQTDM_INTERNAL_VERSION", TARGET_VERSION_STR);
-
-        QString message = QString("%1");
-        message = message.arg(QT_VERSION_STR);
-        map.insert("CAQTDM_INTERNAL_QTVERSION", message);
-
-        path =qApp->applicationFilePath();
-        pos = path.lastIndexOf("/");
-        if((pos > 0) && ((path.length() - pos -1) > 0)) path.chop(path.length() - pos -1);
-        map.insert("CAQTDM_INTERNAL_EXEPATH", path);
-
-        map.insert("CAQTDM_INTERNAL_PID",QString::number(qApp->applicationPid()));
-        map.insert("CAQTDM_INTERNAL_HOSTNAME", QHostInfo::localHostName());
-
-        map.insert("CAQTDM_INTERNAL_SCREENCOUNT",QString::number( qApp->desktop()->screenCount()));
-        map.insert("CAQTDM_INTERNAL_DPI",QString::number( qApp->desktop()->physicalDpiX())); //qApp->primaryScreen()->physicalDotsPerInch()));
-#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
-        map.insert("CAQTDM_INTERNAL_REFRESHRATE",QString::number(qApp->primaryScreen()->refreshRate()));
-#endif
-        map.insert("CAQTDM_INTERNAL_DESKTOP_WIDTH",QString::number(qApp->desktop()->size().width()));
-        map.insert("CAQTDM_INTERNAL_DESKTOP_HEIGHT",QString::number(qApp->desktop()->size().height()));
-
-        map.insert("CAQTDM_INTERNAL_CA_ADDRLIST",qgetenv("EPICS_CA_ADDR_LIST"));
-        map.insert("CAQTDM_INTERNAL_BS_ADDRLIST",qgetenv("BSREAD_ZMQ_ADDR_LIST"));
-        map.insert("CAQTDM_INTERNAL_BS_DISPATCHER",qgetenv("BSREAD_DISPATCHER"));
+        map = getMacroMap(macro);
     }
 
     QColor bg = w1->property("background").value<QColor>();
@@ -2261,6 +2322,17 @@ void CaQtDM_Lib::HandleWidget(QWidget *w1, QString macro, bool firstPass, bool t
 
         searchFile *s = new searchFile(fileName);
         QString fileNameFound = s->findFile();
+
+        // no ui file, but maybe the MEDM file it was converted from
+        bool adlFile = false;
+        if(fileNameFound.isNull() && !prcFile) {
+            QString adlName = fileName;
+            adlName.chop(3);
+            searchFile adl(adlName.append(".adl"));
+            fileNameFound = adl.findFile();
+            adlFile = !fileNameFound.isNull();
+        }
+
         if(fileNameFound.isNull()) {
             includeData value;
             value.count = 0;
@@ -2322,39 +2394,53 @@ void CaQtDM_Lib::HandleWidget(QWidget *w1, QString macro, bool firstPass, bool t
                     timer.start();
 #endif
                     QFile *file = new QFile;
-                    // open and load ui file
-                    file->setFileName(fileName);
-                    file->open(QFile::ReadOnly);
-                    //symtomatic AFS check
-                    if (!file->isOpen()){
-                        postMessage(QtDebugMsg, (char*) qasc(tr("can't open file %1 ").arg(fileName)));
-                    }else{
-                        if (file->size()==0){
-                            postMessage(QtDebugMsg, (char*) qasc(tr("file %1 has size zero ").arg(fileName)));
+                    // convert adl file in memory
+                    if(adlFile) {
+                        QString message;
+                        QByteArray uiData = adlConverter::uiFromAdl(fileName, message);
+                        if(uiData.isEmpty()) {
+                            postMessage(QtDebugMsg, (char*) qasc(tr("can't convert file %1: %2").arg(fileName).arg(message)));
+                        } else if (level<CAQTDM_MAX_INCLUDE_LEVEL-1){
+                            QBuffer buffer(&uiData);
+                            buffer.open(QIODevice::ReadOnly);
+                            thisW = loader.load(&buffer, this);
+                            buffer.close();
+                        }
+                    } else {
+                        // open and load ui file
+                        file->setFileName(fileName);
+                        file->open(QFile::ReadOnly);
+                        //symtomatic AFS check
+                        if (!file->isOpen()){
+                            postMessage(QtDebugMsg, (char*) qasc(tr("can't open file %1 ").arg(fileName)));
                         }else{
-                            if (level<CAQTDM_MAX_INCLUDE_LEVEL-1){
-                                QBuffer *buffer = new QBuffer();
-                                buffer->open(QIODevice::ReadWrite);
-                                //QByteArray data=file->readAll();
-                                buffer->write(file->readAll());
+                            if (file->size()==0){
+                                postMessage(QtDebugMsg, (char*) qasc(tr("file %1 has size zero ").arg(fileName)));
+                            }else{
+                                if (level<CAQTDM_MAX_INCLUDE_LEVEL-1){
+                                    QBuffer *buffer = new QBuffer();
+                                    buffer->open(QIODevice::ReadWrite);
+                                    //QByteArray data=file->readAll();
+                                    buffer->write(file->readAll());
 
-                                //QCryptographicHash md5Gen(QCryptographicHash::Md5);
-                                //md5Gen.addData(data);
+                                    //QCryptographicHash md5Gen(QCryptographicHash::Md5);
+                                    //md5Gen.addData(data);
 
-                                buffer->seek(0);
+                                    buffer->seek(0);
 
-                                thisW = loader.load(buffer, this);
+                                    thisW = loader.load(buffer, this);
 
-                                //qDebug() << "iload= " << fileName << buffer->size() << md5Gen.result().toHex();
-                                //qDebug() << thisW->findChildren<QWidget *>();
-                                //foreach(QWidget *w1, thisW->findChildren<QWidget *>()) {
-                                //  qDebug() << w1->metaObject()->className();
-                                //}
+                                    //qDebug() << "iload= " << fileName << buffer->size() << md5Gen.result().toHex();
+                                    //qDebug() << thisW->findChildren<QWidget *>();
+                                    //foreach(QWidget *w1, thisW->findChildren<QWidget *>()) {
+                                    //  qDebug() << w1->metaObject()->className();
+                                    //}
 
-                                delete buffer;
+                                    delete buffer;
+                                }
                             }
+                            file->close();
                         }
-                        file->close();
                     }
 
                     delete file;
@@ -2474,6 +2560,9 @@ void CaQtDM_Lib::HandleWidget(QWidget *w1, QString macro, bool firstPass, bool t
 
                     scanWidgets(thisW->findChildren<QWidget *>(), macroS);
 
+                    // an include loaded after the display was built brings its own alarm summaries
+                    if(alarmTree != (AlarmTree *) 0) alarmTree->addContainers(includeWidget);
+
                     // take into account recursive use of directories
                     if(cainclude_path.contains("/")) {
                         QStringList pathcomponents=cainclude_path.split("/");
@@ -2930,14 +3019,11 @@ void CaQtDM_Lib::HandleWidget(QWidget *w1, QString macro, bool firstPass, bool t
         for(int i=0; i< vars.count(); i++) {
             pv = vars.at(i);
             if(pv.size() > 0) {
-                QTableWidgetItem *item;
                 specData[0] = i;            // table row
                 int num = addMonitor(myWidget, &kData, pv, w1, specData, map, &pv);
                 integerList.append(num);
                 nbMonitors++;
-                item = new QTableWidgetItem(pv);
-                item->setTextAlignment(Qt::AlignAbsolute | Qt:: AlignLeft);
-                tableWidget->setItem(i,0, item);
+                tableWidget->displayText(i, 0, -1, pv);
             }
         }
         tableWidget->setColumnSizes(tableWidget->getColumnSizes());
@@ -3151,125 +3237,140 @@ void CaQtDM_Lib::updateTextBrowser()
 /**
   * this routine uses macro table to replace inside the pv the macro part
   */
-QString CaQtDM_Lib::treatMacro(QMap<QString, QString> map, const QString& text, bool *doNothing, QString widgetName)
+QString CaQtDM_Lib::treatMacro(const QMap<QString, QString> &map, const QString& text, bool *doNothing, QString widgetName)
 {
-    QString newText = text;
-    char asc[MAX_STRING_LENGTH];
     *doNothing = false;
     // a macro exists and when pv contains a right syntax then replace pv
     if(!map.isEmpty()) {
         if(text.contains("$(") && text.contains(")")) {
-            // normal macroexchange
-            QMapIterator<QString, QString> i(map);
-            int recursive_counter = 0;
-            bool recursive_continue=true;
-            while (recursive_continue) {
-                //recursive_continue=false;
-                QString newText_Backup=newText;
-                while (i.hasNext()) {
-                    i.next();
-                    QString toReplace = "$(" + i.key() + ")";
-                    //qDebug() << "replace in" << newText << toReplace << "with" << i.value();
-                    newText.replace(toReplace, i.value());
-                }
-                if (newText_Backup.compare(newText)==0){
-                    //qDebug() << "finish Loop simple Macro Replace";
-                    recursive_continue=false;
-                }
-                if(recursive_counter++ > 10) break;
-            }
-            i.toFront();
-            if(newText.contains("$(")){
-                //qDebug() << "Spezial";
-                while (i.hasNext()) {
-                    i.next();
-                    QString tofind = "$(" + i.key()+"{";
-                    int position=newText.indexOf(tofind);
-                    while (position!=(-1)){
-                        //qDebug() << "position" <<position;
-                        if ((position>=0)&&(position<newText.length())){
-                            int json_start=(position-1)+tofind.length();
-                            int json_end  =newText.indexOf(QString("})"),json_start);
-
-                            //qDebug() << "newText.mid(): " << newText.mid(json_start,json_end-json_start+1);
-                            QString macro_regex="";
-                            QString macro_value="Parsing Error";
-                            bool macro_value_found=false;
-
-                            JSONObject jsonobj;
-                            JSONValue *MacroDataJ = JSON::Parse(newText.mid(json_start,json_end-json_start+1).toStdString().c_str());
-                            if (MacroDataJ!=NULL){
-                                if(!MacroDataJ->IsObject()) {
-                                    delete(MacroDataJ);
-                                } else {
-                                    jsonobj=MacroDataJ->AsObject();
-                                    if (jsonobj.find(L"regex") != jsonobj.end() && jsonobj[L"regex"]->IsString()) {
-                                        macro_regex=QString::fromWCharArray(jsonobj[L"regex"]->AsString().c_str());
-                                    }
-
-                                    if (jsonobj.find(L"value") != jsonobj.end() && jsonobj[L"value"]->IsString()) {
-                                        macro_value=QString::fromWCharArray(jsonobj[L"value"]->AsString().c_str());
-                                        macro_value_found=true;
-                                    }
-                                    delete(MacroDataJ);
-                                }
-                            }else{
-                                snprintf(asc, MAX_STRING_LENGTH, "JSON Error in (%s)", qasc(newText.mid(json_start,json_end-json_start+1)));
-                                postMessage(QtWarningMsg, asc);
-
-                            }
-
-                            QRegExp rx_json;
-                            QString toReplace = "$(" + i.key() + newText.mid(json_start,json_end-json_start+1) + ")";
-                            rx_json.setPattern(macro_regex);
-                            if (rx_json.isValid()){
-                                QString ReplaceWith=i.value();
-                                    if (macro_value_found){
-                                    ReplaceWith.replace(rx_json,macro_value);
-
-                                    //qDebug() << "replace in" << newText << toReplace << "with" << ReplaceWith << "outof " << macro_value;
-                                    snprintf(asc, MAX_STRING_LENGTH, "Replace (%s) (%s) with (%s) Regex:(%s)", qasc(i.key()), qasc(i.value()),qasc(macro_value),qasc(macro_regex));
-                                    postMessage(QtDebugMsg, asc);
-                                    newText.replace(toReplace, ReplaceWith);
-                                }else{
-                                    snprintf(asc, MAX_STRING_LENGTH, "No Replacement found do simple(%s) (%s) macro resolution", qasc(i.key()), qasc(i.value()));
-                                    //qDebug() << "No Replacement found do simple(%s) (%s) macro resolution" <<  qasc(i.key()) <<  qasc(i.value()) << text;
-                                    postMessage(QtWarningMsg, asc);
-                                    newText.replace(toReplace, i.value());
-                                }
-                            }
-
-                        }
-                        position=newText.indexOf(tofind,position+1);
-                    }
-                }
-
-            }
-            // unresolved macros
-            if(newText.contains("$(")){
-                QString unresMacro = "";
-                QString tofind = "$(";
-                int position=newText.indexOf(tofind);
-                while (position != (-1)){
-                    int wrongmacro_start=(position-1)+tofind.length();
-                    int wrongmacro_end  =newText.indexOf(QString(")"), wrongmacro_start);
-                    if ((position >= 0)&&(position < newText.length())){
-                        unresMacro.append(newText.mid(wrongmacro_start, wrongmacro_end-wrongmacro_start+1));
-                    }
-                    position=newText.indexOf(tofind,position+1);
-                }
+            QString unresMacro = "";
+            QString newText = expandMacroTemplate(map, text, 0, unresMacro);
+
+            // composed names like $(A$(B)) are only complete after the inner macro was replaced
+            for(int pass = 1; pass < MAXMACRODEPTH && newText.contains("$("); pass++) {
+                QString dummy = "";
+                QString nextText = expandMacroTemplate(map, newText, 0, dummy);
+                if(nextText == newText) break;
+                newText = nextText;
+            }
+
+            // unresolved macros are the ones left over
+            unresMacro = "";
+            int start = newText.indexOf("$(");
+            while(start >= 0) {
+                int end = newText.indexOf(")", start);
+                if(end < 0) end = newText.length() - 1;
+                unresMacro.append(newText.mid(start + 1, end - start));
+                start = newText.indexOf("$(", start + 2);
+            }
+            if(unresMacro.length() > 0) {
                 //qDebug() << unresMacro << "for widget" << widgetName << "in file" << savedFile[level];
                 QString key = "%1###%2###%3";
                 key = key.arg(unresMacro).arg(widgetName).arg(savedFile[level]);
                 unknownMacrosList.insert(key, savedFile[level]);
             }
+            return newText;
         }
     } else {
         if(text.contains("$")) *doNothing = true;
     }
+    return text;
+}
+
+/**
+  * this routine expands a compiled macro template; values containing macros are expanded in turn
+  */
+QString CaQtDM_Lib::expandMacroTemplate(const QMap<QString, QString> &map, const QString &text, int depth, QString &unresMacro)
+{
+    QSharedPointer<const MacroTemplate> compiled = MacroTemplate::compile(text);
+    if(!compiled->hasMacros()) return text;
+
+    const QList<MacroTemplate::segment> &segments = compiled->getSegments();
+    QString newText;
+    newText.reserve(text.size());
+
+    for(int i = 0; i < segments.size(); i++) {
+        const MacroTemplate::segment &seg = segments.at(i);
+        if(seg.type == MacroTemplate::Literal) {
+            newText.append(seg.text);
+            continue;
+        }
+
+        QMap<QString, QString>::const_iterator k = map.constFind(seg.text);
+        if(k == map.constEnd()) {
+            newText.append(seg.raw);
+            unresMacro.append(seg.raw.mid(1));
+            continue;
+        }
+
+        QString value = k.value();
+        if(value.contains("$(")) {
+            if(depth < MAXMACRODEPTH) {
+                value = expandMacroTemplate(map, value, depth + 1, unresMacro);
+            } else {
+                unresMacro.append(seg.raw.mid(1));
+            }
+        }
+
+        if(seg.type == MacroTemplate::Variable) {
+            newText.append(value);
+        } else if(expandSpecialMacro(seg, value)) {
+            newText.append(value);
+        } else {
+            newText.append(seg.raw);
+            unresMacro.append(seg.raw.mid(1));
+        }
+    }
     return newText;
 }
 
+/**
+  * this routine treats a macro of type $(NAME{"regex":"...","value":"..."}), the regex is applied to the macro value
+  */
+bool CaQtDM_Lib::expandSpecialMacro(const MacroTemplate::segment &seg, QString &value)
+{
+    char asc[MAX_STRING_LENGTH];
+    QString macro_regex="";
+    QString macro_value="Parsing Error";
+    bool macro_value_found=false;
+
+    JSONObject jsonobj;
+    JSONValue *MacroDataJ = JSON::Parse(seg.json.toStdString().c_str());
+    if (MacroDataJ!=NULL){
+        if(!MacroDataJ->IsObject()) {
+            delete(MacroDataJ);
+        } else {
+            jsonobj=MacroDataJ->AsObject();
+            if (jsonobj.find(L"regex") != jsonobj.end() && jsonobj[L"regex"]->IsString()) {
+                macro_regex=QString::fromWCharArray(jsonobj[L"regex"]->AsString().c_str());
+            }
+
+            if (jsonobj.find(L"value") != jsonobj.end() && jsonobj[L"value"]->IsString()) {
+                macro_value=QString::fromWCharArray(jsonobj[L"value"]->AsString().c_str());
+                macro_value_found=true;
+            }
+            delete(MacroDataJ);
+        }
+    }else{
+        snprintf(asc, MAX_STRING_LENGTH, "JSON Error in (%s)", qasc(seg.json));
+        postMessage(QtWarningMsg, asc);
+    }
+
+    QRegExp rx_json;
+    rx_json.setPattern(macro_regex);
+    if (!rx_json.isValid()) return false;
+
+    if (macro_value_found){
+        snprintf(asc, MAX_STRING_LENGTH, "Replace (%s) (%s) with (%s) Regex:(%s)", qasc(seg.text), qasc(value),qasc(macro_value),qasc(macro_regex));
+        postMessage(QtDebugMsg, asc);
+        value.replace(rx_json,macro_value);
+    }else{
+        snprintf(asc, MAX_STRING_LENGTH, "No Replacement found do simple(%s) (%s) macro resolution", qasc(seg.text), qasc(value));
+        postMessage(QtWarningMsg, asc);
+    }
+    return true;
+}
+
 void CaQtDM_Lib::UndefinedMacrosWindow()
 {
     int count=0;
@@ -3392,6 +3493,7 @@ int CaQtDM_Lib::addMonitor(QWidget *thisW, knobData *kData, QString pv, QWidget
     int indx;
     QString pluginName="";
     QString pluginFlavor="";
+    QString pluginOptions="";
     ControlsInterface *plugininterface = (ControlsInterface *) 0;
 
     ftime(&now);
@@ -3465,9 +3567,30 @@ int CaQtDM_Lib::addMonitor(QWidget *thisW, knobData *kData, QString pv, QWidget
         if(mutexKnobDataP->getSoftPV(trimmedPV, &indx, thisW)) pluginName = "intern";
     }
 
+    // monitor request options (queueSize, pipeline) for epics4 are given after the channel name: name?queueSize=4&pipeline=true
+    // or by the dynamic widget property pvaMonitorOptions; they do not belong to the channel name
+    if(pluginName.contains("epics4")) {
+        pos = trimmedPV.indexOf("?");
+        if(pos != -1) {
+            pluginOptions = trimmedPV.mid(pos+1).trimmed();
+            trimmedPV.truncate(pos);
+        } else {
+            QVariant pvaOptions = w->property("pvaMonitorOptions");
+            if(pvaOptions.isValid()) pluginOptions = pvaOptions.toString().trimmed();
+        }
+    }
+
     *pvRep = trimmedPV;
     strcpy(kData->pluginName, (char*) qasc(pluginName));
     strcpy(kData->pluginFlavor, (char*) qasc(pluginFlavor));
+    cpylen = qMin(pluginOptions.length(), MAXPVLEN-1);
+    strncpy(kData->pluginOptions, (char*) qasc(pluginOptions), (size_t) cpylen);
+    kData->pluginOptions[cpylen] = '\0';
+    if(cpylen < pluginOptions.length()) {
+        char asc[MAX_STRING_LENGTH];
+        snprintf(asc, MAX_STRING_LENGTH, "Warning: options of pv %s are too long and were cut to '%s'", (char*) qasc(trimmedPV), kData->pluginOptions);
+        postMessage(QtWarningMsg, asc);
+    }
 
     cpylen = qMin(trimmedPV.length(), MAXPVLEN-1);
     strncpy(kData->pv, (char*) qasc(trimmedPV), (size_t) cpylen);
@@ -3557,6 +3680,9 @@ int CaQtDM_Lib::addMonitor(QWidget *thisW, knobData *kData, QString pv, QWidget
         return num;
     }
 
+    // the widget class is resolved once here instead of at every update
+    SetUpdateHandler(num, w, ResolveUpdateClass(w));
+
     // insert into the softpv list when we create a soft channel
     if(kData->soft) {
         strcpy(kData->pluginName, "intern");
@@ -3809,15 +3935,15 @@ bool CaQtDM_Lib::CalcVisibility(QWidget *w, double &result, bool &valid)
         QRegExp checkregexp("%\\/(\\S+)\\/");
         checkregexp.setMinimal(true);
         if (checkregexp.indexIn(calcString) != -1){
-            knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(MonitorList.at(1).toInt());
-            if(ptr != (knobData *) 0) {
+            knobSnapshot snapshot;
+            if(mutexKnobDataP->GetMutexKnobDataSnapshot(MonitorList.at(1).toInt(), snapshot, true)) {
                 char dataString[STRING_EXCHANGE_SIZE];
-                int caFieldType= ptr->edata.fieldtype;
+                int caFieldType= snapshot.edata.fieldtype;
                 QString captured_Calc = checkregexp.cap(1);
-                if((caFieldType == caSTRING || caFieldType == caENUM || caFieldType == caCHAR) && ptr->edata.dataB != (void*) 0) {
-                    if(ptr->edata.dataSize < STRING_EXCHANGE_SIZE) {
-                        memcpy(dataString, (char*) ptr->edata.dataB, (size_t) ptr->edata.dataSize);
-                        dataString[ptr->edata.dataSize] = '\0';
+                if((caFieldType == caSTRING || caFieldType == caENUM || caFieldType == caCHAR) && !snapshot.data.isEmpty()) {
+                    if(snapshot.data.size() < STRING_EXCHANGE_SIZE) {
+                        memcpy(dataString, snapshot.data.constData(), (size_t) snapshot.data.size());
+                        dataString[snapshot.data.size()] = '\0';
 
                         // in case of enum we have to get the right string from the value
                         if(caFieldType == caENUM) {
@@ -3825,9 +3951,9 @@ bool CaQtDM_Lib::CalcVisibility(QWidget *w, double &result, bool &valid)
                             QStringList list;
                             //list = String.split(";");
                             list = String.split((QChar)27);
-                            if((ptr->edata.fieldtype == caENUM)  && ((int) ptr->edata.ivalue < list.count() ) && (list.count() > 0)) {
-                                if(list.at((int) ptr->edata.ivalue).trimmed().size() != 0)  {  // string seems to empty, give value
-                                    QString strng = list.at((int) ptr->edata.ivalue);
+                            if((snapshot.edata.fieldtype == caENUM)  && ((int) snapshot.edata.ivalue < list.count() ) && (list.count() > 0)) {
+                                if(list.at((int) snapshot.edata.ivalue).trimmed().size() != 0)  {  // string seems to empty, give value
+                                    QString strng = list.at((int) snapshot.edata.ivalue);
                                     QByteArray ba = strng.toLatin1();
                                     strcpy(dataString, ba.data());
                                 }
@@ -3863,20 +3989,20 @@ bool CaQtDM_Lib::CalcVisibility(QWidget *w, double &result, bool &valid)
                 //qDebug() << "qrect for cacalc detected";
                 for(int i=0; i<4; i++) valueArray[i] = -1;  //say default value will not do anything
                 for(int i=0; i<nbMonitors;i++) {
-                    knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(MonitorList.at(i+1).toInt());
-                    if(ptr != (knobData*) 0) {
-                        //qDebug() << "calculate from index" << i << ptr->index << ptr->pv << ptr->edata.connected << ptr->edata.rvalue << IndexList.at(i+1).toInt();
+                    knobSnapshot snapshot;
+                    if(mutexKnobDataP->GetMutexKnobDataSnapshot(MonitorList.at(i+1).toInt(), snapshot)) {
+                        //qDebug() << "calculate from index" << i << snapshot.index << snapshot.edata.connected << snapshot.edata.rvalue << IndexList.at(i+1).toInt();
                         // when connected
                         int j = IndexList.at(i+1).toInt(); // input a,b,c,d
-                        if(ptr->edata.connected) {
-                            switch (ptr->edata.fieldtype){
+                        if(snapshot.edata.connected) {
+                            switch (snapshot.edata.fieldtype){
                             case caINT:
                             case caLONG:{
-                                valueArray[j] = ptr->edata.ivalue;
+                                valueArray[j] = snapshot.edata.ivalue;
                                 break;
                             }
                             default:{
-                                valueArray[j] = ptr->edata.rvalue;
+                                valueArray[j] = snapshot.edata.rvalue;
                             }
                             }
                         } else {
@@ -3960,12 +4086,12 @@ bool CaQtDM_Lib::CalcVisibility(QWidget *w, double &result, bool &valid)
             pArgs = PyTuple_New(MAXMONITORS);
             for(int i=0; i< MAXMONITORS; i++) pValueA[i] = PyFloat_FromDouble(0.0);
             for(int i=0; i< nbMonitors; i++) {
-                knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(MonitorList.at(i+1).toInt());
-                if(ptr != (knobData*) 0) {
+                knobSnapshot snapshot;
+                if(mutexKnobDataP->GetMutexKnobDataSnapshot(MonitorList.at(i+1).toInt(), snapshot)) {
                     // when connected
                     int j = IndexList.at(i+1).toInt(); // input a,b,c,d
-                    if(ptr->edata.connected) {
-                        valueArray[j] = ptr->edata.rvalue;
+                    if(snapshot.edata.connected) {
+                        valueArray[j] = snapshot.edata.rvalue;
                     } else {
                         valueArray[j] = 0.0;
                     }
@@ -4008,36 +4134,36 @@ bool CaQtDM_Lib::CalcVisibility(QWidget *w, double &result, bool &valid)
             // scan and get the channels
             for(int i=0; i < MAX_CALC_INPUTS; i++) valueArray[i] = 0.0;
             for(int i=0; i< nbMonitors;i++) {
-                knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(MonitorList.at(i+1).toInt());
-                if(ptr != (knobData*) 0) {
-                    //qDebug() << "calculate from index" << i << ptr->index << ptr->pv << ptr->edata.connected << ptr->edata.rvalue << ptr->edata.ivalue << IndexList.at(i+1).toInt();
+                knobSnapshot snapshot;
+                if(mutexKnobDataP->GetMutexKnobDataSnapshot(MonitorList.at(i+1).toInt(), snapshot)) {
+                    //qDebug() << "calculate from index" << i << snapshot.index << snapshot.edata.connected << snapshot.edata.rvalue << snapshot.edata.ivalue << IndexList.at(i+1).toInt();
                     // when connected
                     int j = IndexList.at(i+1).toInt(); // input a,b,c,d
-                    if(ptr->edata.connected) {
-                        switch (ptr->edata.fieldtype){
+                    if(snapshot.edata.connected) {
+                        switch (snapshot.edata.fieldtype){
                             case caINT:
                             case caLONG:
                             case caENUM: {
-                                valueArray[j] = ptr->edata.ivalue;
+                                valueArray[j] = snapshot.edata.ivalue;
                                 break;
                             }
                             default:{
-                                valueArray[j] = ptr->edata.rvalue;
+                                valueArray[j] = snapshot.edata.rvalue;
                             }
                         }
                     } else {
                         valueArray[j] = 0.0;
                     }
                     // for first record
-                    if(i==0 && ptr->edata.connected) {
+                    if(i==0 && snapshot.edata.connected) {
                         valueArray[4] = 0.0;                                 /* E: Reserved */
                         valueArray[5] = 0.0;                                 /* F: Reserved */
-                        valueArray[6] = ptr->edata.valueCount;               /* G: count */
-                        valueArray[7] = ptr->edata.upper_disp_limit;         /* H: hopr */
-                        valueArray[8] = ptr->edata.status;                   /* I: status */
-                        valueArray[9] = ptr->edata.severity;                 /* J: severity */
-                        valueArray[10] = ptr->edata.precision;               /* K: precision */
-                        valueArray[11] = ptr->edata.lower_disp_limit;        /* L: lopr */
+                        valueArray[6] = snapshot.edata.valueCount;           /* G: count */
+                        valueArray[7] = snapshot.edata.upper_disp_limit;     /* H: hopr */
+                        valueArray[8] = snapshot.edata.status;               /* I: status */
+                        valueArray[9] = snapshot.edata.severity;             /* J: severity */
+                        valueArray[10] = snapshot.edata.precision;           /* K: precision */
+                        valueArray[11] = snapshot.edata.lower_disp_limit;    /* L: lopr */
                     }
                 }
             }
@@ -4088,11 +4214,11 @@ short CaQtDM_Lib::ComputeAlarm(QWidget *w)
     if(nbMonitors > 0)  {
 
         // medm uses however only first channel
-        knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(list.at(1).toInt());
-        if(ptr != (knobData *) 0) {
+        knobSnapshot snapshot;
+        if(mutexKnobDataP->GetMutexKnobDataSnapshot(list.at(1).toInt(), snapshot)) {
             // when connected
-            if(ptr->edata.connected) {
-                status = status | ptr->edata.severity;
+            if(snapshot.edata.connected) {
+                status = status | snapshot.edata.severity;
             } else {
                 return NOTCONNECTED;
             }
@@ -4214,6 +4340,69 @@ void CaQtDM_Lib::UpdateMeter(caMeter *widget, const knobData &data)
 
 }
 
+/**
+ * the update class of a widget, tested in the order the widgets were treated before;
+ * derived classes (caApplyNumeric) must be tested before their base class
+ */
+int CaQtDM_Lib::ResolveUpdateClass(QWidget *w)
+{
+    if(dynamic_cast<caWidgetInterface *>(w) != (caWidgetInterface *) 0) return ClassInterface;
+    if(qobject_cast<caCalc *>(w) != (caCalc *) 0) return ClassCalc;
+    if(qobject_cast<caLabel *>(w) != (caLabel *) 0) return ClassLabel;
+    if(qobject_cast<caLabelVertical *>(w) != (caLabelVertical *) 0) return ClassLabelVertical;
+    if(qobject_cast<caInclude *>(w) != (caInclude *) 0) return ClassInclude;
+    if(qobject_cast<caFrame *>(w) != (caFrame *) 0) return ClassFrame;
+    if(qobject_cast<caMenu *>(w) != (caMenu *) 0) return ClassMenu;
+    if(qobject_cast<caChoice *>(w) != (caChoice *) 0) return ClassChoice;
+    if(qobject_cast<caThermo *>(w) != (caThermo *) 0) return ClassThermo;
+    if(qobject_cast<caSlider *>(w) != (caSlider *) 0) return ClassSlider;
+    if(qobject_cast<caClock *>(w) != (caClock *) 0) return ClassClock;
+    if(qobject_cast<caLinearGauge *>(w) != (caLinearGauge *) 0) return ClassLinearGauge;
+    if(qobject_cast<caCircularGauge *>(w) != (caCircularGauge *) 0) return ClassCircularGauge;
+    if(qobject_cast<caMeter *>(w) != (caMeter *) 0) return ClassMeter;
+    if(qobject_cast<caByte *>(w) != (caByte *) 0) return ClassByte;
+    if(qobject_cast<caByteController *>(w) != (caByteController *) 0) return ClassByteController;
+    if(qobject_cast<caLineEdit *>(w) != (caLineEdit *) 0) return ClassLineEdit;
+    if(qobject_cast<caMultiLineString *>(w) != (caMultiLineString *) 0) return ClassMultiLineString;
+    if(qobject_cast<caGraphics *>(w) != (caGraphics *) 0) return ClassGraphics;
+    if(qobject_cast<caPolyLine *>(w) != (caPolyLine *) 0) return ClassPolyLine;
+    if(qobject_cast<caLed *>(w) != (caLed *) 0) return ClassLed;
+    if(qobject_cast<caApplyNumeric *>(w) != (caApplyNumeric *) 0) return ClassApplyNumeric;
+    if(qobject_cast<caNumeric *>(w) != (caNumeric *) 0) return ClassNumeric;
+    if(qobject_cast<caSpinbox *>(w) != (caSpinbox *) 0) return ClassSpinbox;
+    if(qobject_cast<caToggleButton *>(w) != (caToggleButton *) 0) return ClassToggleButton;
+    if(qobject_cast<caCartesianPlot *>(w) != (caCartesianPlot *) 0) return ClassCartesianPlot;
+    if(qobject_cast<caWaterfallPlot *>(w) != (caWaterfallPlot *) 0) return ClassWaterfallPlot;
+    if(qobject_cast<caStripPlot *>(w) != (caStripPlot *) 0) return ClassStripPlot;
+    if(qobject_cast<caImage *>(w) != (caImage *) 0) return ClassImage;
+    if(qobject_cast<caTable *>(w) != (caTable *) 0) return ClassTable;
+    if(qobject_cast<caWaveTable *>(w) != (caWaveTable *) 0) return ClassWaveTable;
+    if(qobject_cast<caBitnames *>(w) != (caBitnames *) 0) return ClassBitnames;
+    if(qobject_cast<caCamera *>(w) != (caCamera *) 0) return ClassCamera;
+    if(qobject_cast<caScan2D *>(w) != (caScan2D *) 0) return ClassScan2D;
+    if(qobject_cast<caMessageButton *>(w) != (caMessageButton *) 0) return ClassMessageButton;
+    return ClassUnknown;
+}
+
+/**
+ * remember for a knob index the widget and how it has to be updated
+ */
+void CaQtDM_Lib::SetUpdateHandler(int indx, QWidget *w, int updateClass)
+{
+    if(indx < 0) return;
+    if(indx >= updateHandlers.size()) {
+        updateHandler empty = {(QWidget *) 0, ClassForeign, "", -1};
+        int oldSize = updateHandlers.size();
+        updateHandlers.resize(indx + KNOBDATA_CHUNK);
+        for(int i = oldSize; i < updateHandlers.size(); i++) updateHandlers[i] = empty;
+    }
+    updateHandlers[indx].widget = w;
+    updateHandlers[indx].updateClass = updateClass;
+    updateHandlers[indx].className = w->metaObject()->className();
+    updateHandlers[indx].severity = -1;
+    if(alarmTree != (AlarmTree *) 0) alarmTree->removeMember(indx);
+}
+
 /**
  * updates my widgets through monitor and emit signal
  */
@@ -4221,35 +4410,70 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
                                        const QString& units,
                                        const QString& fec,
                                        const QString& String,
-                                       const knobData& data)
+                                       const knobUpdate& update)
 {
-    Q_UNUSED(indx);
     Q_UNUSED(fec);
 
     if(!AllowsUpdate) return;
 
-    // thread mutexknobdata emits to all instances of this class, later we will have to filter on the emit side to enhance performance
-    bool thisInstance = false;
-    QWidget *widget = w;
-    if(w == (QWidget*) 0) return;
-    while (widget->parentWidget()) {
-        widget = widget->parentWidget() ;
-        if(widget == myWidget) {
-            thisInstance = true;
-            break;
+    if(w == (QWidget*) 0 || indx < 0) return;
+
+    // thread mutexknobdata emits to all instances of this class; our widgets got their handler when the
+    // monitor was added, widgets of other instances are found out once and then remembered for their index
+    if(indx >= updateHandlers.size() || updateHandlers.at(indx).widget != w) {
+        bool thisInstance = false;
+        QWidget *widget = w;
+        while (widget->parentWidget()) {
+            widget = widget->parentWidget() ;
+            if(widget == myWidget) {
+                thisInstance = true;
+                break;
+            }
         }
+        SetUpdateHandler(indx, w, thisInstance ? ResolveUpdateClass(w) : (int) ClassForeign);
     }
-    if(!thisInstance) {
+
+    int updateClass = updateHandlers.at(indx).updateClass;
+    if(updateClass == ClassForeign) return;
+    const char *className = updateHandlers.at(indx).className;
+
+    // the alarm summaries only hear about a channel when its severity changed
+    if(alarmTree != (AlarmTree *) 0 && !update->soft && !alarmTree->isEmpty()) {
+        short severity = update->edata.connected ? update->edata.severity : (short) NOTCONNECTED;
+        if(severity != updateHandlers.at(indx).severity) {
+            updateHandlers[indx].severity = severity;
+            alarmTree->setSeverity(indx, w, severity);
+        }
+    }
+
+    if(!updateStatistics) {
+        UpdateWidgetByClass(updateClass, w, units, String, *update);
         return;
     }
 
+    QElapsedTimer timer;
+    timer.start();
+    UpdateWidgetByClass(updateClass, w, units, String, *update);
+    mutexKnobDataP->AddUpdateCost(className, timer.nsecsElapsed());
+}
+
+/**
+ * updates a widget of this instance according to its class
+ */
+void CaQtDM_Lib::UpdateWidgetByClass(int updateClass, QWidget *w, const QString& units, const QString& String, const knobData& data)
+{
+    switch(updateClass) {
+
     // any caWidget with caWidgetInterface
-    if (caWidgetInterface* wif = dynamic_cast<caWidgetInterface *>(w)) {
+    case ClassInterface: {
+        caWidgetInterface* wif = dynamic_cast<caWidgetInterface *>(w);
         wif->caDataUpdate(units, String, data);
+        break;
     }
 
     // calc ==================================================================================================================
-    else if(caCalc *calcWidget = qobject_cast<caCalc *>(w)) {
+    case ClassCalc: {
+        caCalc *calcWidget = static_cast<caCalc *>(w);
         bool valid;
         double result;
         switch (data.edata.fieldtype){
@@ -4294,9 +4518,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
                 }
             }
         }
+        break;
+    }
 
-        // caLabel ==================================================================================================================
-    } else if(caLabel *labelWidget = qobject_cast<caLabel *>(w)) {
+    // caLabel ==================================================================================================================
+    case ClassLabel: {
+        caLabel *labelWidget = static_cast<caLabel *>(w);
         //qDebug() << "we have a label";
 
         if(data.edata.connected) {
@@ -4320,9 +4547,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(labelWidget);
         }
+        break;
+    }
 
-        // caLabelVertical ==================================================================================================================
-    } else if(caLabelVertical *labelverticalWidget = qobject_cast<caLabelVertical *>(w)) {
+    // caLabelVertical ==================================================================================================================
+    case ClassLabelVertical: {
+        caLabelVertical *labelverticalWidget = static_cast<caLabelVertical *>(w);
         //qDebug() << "we have a label";
 
         if(data.edata.connected) {
@@ -4346,9 +4576,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(labelverticalWidget);
         }
+        break;
+    }
 
-        // caInclude ==================================================================================================================
-    } else if(caInclude *includeWidget = qobject_cast<caInclude *>(w)) {
+    // caInclude ==================================================================================================================
+    case ClassInclude: {
+        caInclude *includeWidget = static_cast<caInclude *>(w);
         //qDebug() << "we have an include";
 
         // visibility
@@ -4396,15 +4629,21 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
                 ResizeScrollBars(includeWidget, factX * (maximumX + adjustMargin), factY * (maximumY + adjustMargin));
             }
         }
+        break;
+    }
 
-        // caFrame ==================================================================================================================
-    } else if(caFrame *frameWidget = qobject_cast<caFrame *>(w)) {
+    // caFrame ==================================================================================================================
+    case ClassFrame: {
+        caFrame *frameWidget = static_cast<caFrame *>(w);
         //qDebug() << "we have a frame";
 
         setObjectVisibility(frameWidget, data.edata.rvalue);
+        break;
+    }
 
-        // caMenu ==================================================================================================================
-    } else if (caMenu *menuWidget = qobject_cast<caMenu *>(w)) {
+    // caMenu ==================================================================================================================
+    case ClassMenu: {
+        caMenu *menuWidget = static_cast<caMenu *>(w);
         //qDebug() << "we have a menu" << data.pv << data.edata.connected << data.specData[0];
 
         if(data.edata.connected) {
@@ -4443,9 +4682,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         }
         menuWidget->setAccessW(data.edata.accessW);
         updateAccessCursor(menuWidget);
+        break;
+    }
 
-        // caChoice ==================================================================================================================
-    } else if (caChoice *choiceWidget = qobject_cast<caChoice *>(w)) {
+    // caChoice ==================================================================================================================
+    case ClassChoice: {
+        caChoice *choiceWidget = static_cast<caChoice *>(w);
         //qDebug() << "we have a choiceButton" << String << (int) data.edata.ivalue << choiceWidget;
 
         if(data.edata.connected) {
@@ -4471,9 +4713,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         }
         choiceWidget->setAccessW(data.edata.accessW);
         updateAccessCursor(choiceWidget);
+        break;
+    }
 
-        // caThermo ==================================================================================================================
-    } else if (caThermo *thermoWidget = qobject_cast<caThermo *>(w)) {
+    // caThermo ==================================================================================================================
+    case ClassThermo: {
+        caThermo *thermoWidget = static_cast<caThermo *>(w);
         //qDebug() << "we have a thermometer";
 
         if(data.edata.connected) {
@@ -4514,9 +4759,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(thermoWidget);
         }
+        break;
+    }
 
-        // caSlider ==================================================================================================================
-    } else if (caSlider *sliderWidget = qobject_cast<caSlider *>(w)) {
+    // caSlider ==================================================================================================================
+    case ClassSlider: {
+        caSlider *sliderWidget = static_cast<caSlider *>(w);
 
         if(data.edata.connected) {
             bool highChannelLimitEnabled = false;
@@ -4570,9 +4818,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(sliderWidget);
         }
+        break;
+    }
 
-        // caClock ==================================================================================================================
-    } else if (caClock *clockWidget = qobject_cast<caClock *>(w)) {
+    // caClock ==================================================================================================================
+    case ClassClock: {
+        caClock *clockWidget = static_cast<caClock *>(w);
         if(data.edata.connected) {
             if(clockWidget->getTimeType() == caClock::ReceiveTime) {
                 clockWidget->setAlarmColors(data.edata.severity);
@@ -4583,9 +4834,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(clockWidget);
         }
+        break;
+    }
 
-        // linear gauge (like thermometer) ==================================================================================================================
-    } else if (caLinearGauge *lineargaugeWidget = qobject_cast<caLinearGauge *>(w)) {
+    // linear gauge (like thermometer) ==================================================================================================================
+    case ClassLinearGauge: {
+        caLinearGauge *lineargaugeWidget = static_cast<caLinearGauge *>(w);
         //qDebug() << "we have a linear gauge" << value;
         Q_UNUSED(lineargaugeWidget);
         EAbstractGauge *gauge =  qobject_cast<EAbstractGauge *>(w);
@@ -4595,9 +4849,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             if(gauge->isConnected()) gauge->setConnected(false);
         }
+        break;
+    }
 
-        // circular gauge  ==================================================================================================================
-    } else if (caCircularGauge *circulargaugeWidget = qobject_cast<caCircularGauge *>(w)) {
+    // circular gauge  ==================================================================================================================
+    case ClassCircularGauge: {
+        caCircularGauge *circulargaugeWidget = static_cast<caCircularGauge *>(w);
         //qDebug() << "we have a linear gauge" << value;
         Q_UNUSED(circulargaugeWidget);
         EAbstractGauge *gauge =  qobject_cast<EAbstractGauge *>(w);
@@ -4607,9 +4864,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             if(gauge->isConnected()) gauge->setConnected(false);
         }
+        break;
+    }
 
-        // simple meter ==================================================================================================================
-    } else if (caMeter *meterWidget = qobject_cast<caMeter *>(w)) {
+    // simple meter ==================================================================================================================
+    case ClassMeter: {
+        caMeter *meterWidget = static_cast<caMeter *>(w);
         //qDebug() << "we have a simple meter";
 
         if(data.edata.connected) {
@@ -4625,9 +4885,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(meterWidget);
         }
+        break;
+    }
 
-        // byte ==================================================================================================================
-    } else if (caByte *byteWidget = qobject_cast<caByte *>(w)) {
+    // byte ==================================================================================================================
+    case ClassByte: {
+        caByte *byteWidget = static_cast<caByte *>(w);
 
         if(data.edata.connected) {
             int colorMode = byteWidget->getColorMode();
@@ -4643,9 +4906,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(byteWidget);
         }
+        break;
+    }
 
-        // byte ==================================================================================================================
-    } else if (caByteController *bytecontrollerWidget = qobject_cast<caByteController *>(w)) {
+    // byte ==================================================================================================================
+    case ClassByteController: {
+        caByteController *bytecontrollerWidget = static_cast<caByteController *>(w);
 
         if(data.edata.connected) {
             int colorMode = bytecontrollerWidget->getColorMode();
@@ -4678,9 +4944,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(replaceMacroWidget);
         }
+        break;
+    }
 
-        // lineEdit and textEntry ====================================================================================================
-    } else if (caLineEdit *lineeditWidget = qobject_cast<caLineEdit *>(w)) {
+    // lineEdit and textEntry ====================================================================================================
+    case ClassLineEdit: {
+        caLineEdit *lineeditWidget = static_cast<caLineEdit *>(w);
 
         //qDebug() << "we have a linedit or textentry" << lineeditWidget << data.edata.rvalue <<  data.edata.ivalue;
 
@@ -4829,9 +5098,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
                 textentryWidget->updateText(lineeditWidget->text());
             }
         }
+        break;
+    }
 
-        // multilinestring ====================================================================================================
-    } else if (caMultiLineString *multilinestringWidget = qobject_cast<caMultiLineString *>(w)) {
+    // multilinestring ====================================================================================================
+    case ClassMultiLineString: {
+        caMultiLineString *multilinestringWidget = static_cast<caMultiLineString *>(w);
 
         //qDebug() << "we have a multilinedit" << multilinestringWidget << data.edata.rvalue <<  data.edata.ivalue;
 
@@ -4885,9 +5157,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             multilinestringWidget->setAlarmColors(NOTCONNECTED, 0.0, bg, fg);        \
             multilinestringWidget->setProperty("Connect", false);
         }
+        break;
+    }
 
-        // Graphics ==================================================================================================================
-    } else if (caGraphics *graphicsWidget = qobject_cast<caGraphics *>(w)) {
+    // Graphics ==================================================================================================================
+    case ClassGraphics: {
+        caGraphics *graphicsWidget = static_cast<caGraphics *>(w);
         //qDebug() << "caGraphics" << graphicsWidget->objectName() << graphicsWidget->getColorMode() << data.pv;
 
         if(data.edata.connected) {
@@ -4911,9 +5186,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(graphicsWidget);
         }
+        break;
+    }
 
-        // Polyline ==================================================================================================================
-    } else if (caPolyLine *polylineWidget = qobject_cast<caPolyLine *>(w)) {
+    // Polyline ==================================================================================================================
+    case ClassPolyLine: {
+        caPolyLine *polylineWidget = static_cast<caPolyLine *>(w);
 
         if(data.edata.connected) {
             int colorMode = polylineWidget->getColorMode();
@@ -4936,9 +5214,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(polylineWidget);
         }
+        break;
+    }
 
-        // Led ==================================================================================================================
-    } else if (caLed *ledWidget = qobject_cast<caLed *>(w)) {
+    // Led ==================================================================================================================
+    case ClassLed: {
+        caLed *ledWidget = static_cast<caLed *>(w);
         //qDebug() << "led" << led->objectName();
         Qt::CheckState state = Qt::Unchecked;
 
@@ -4953,9 +5234,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             ledWidget->setAlarmColors(NOTCONNECTED);
         }
+        break;
+    }
 
-        // ApplyNumeric and Numeric =====================================================================================================
-    } else if (caApplyNumeric *applynumericWidget = qobject_cast<caApplyNumeric *>(w)) {
+    // ApplyNumeric and Numeric =====================================================================================================
+    case ClassApplyNumeric: {
+        caApplyNumeric *applynumericWidget = static_cast<caApplyNumeric *>(w);
         //qDebug() << "caApplyNumeric" << applynumericWidget->objectName() << data.pv << data.edata.monitorCount;
 
         if(data.edata.connected) {
@@ -4976,9 +5260,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             applynumericWidget->setConnectedColors(false);
         }
+        break;
+    }
 
-        // Numeric =====================================================================================================
-    } else if (caNumeric *numericWidget = qobject_cast<caNumeric *>(w)) {
+    // Numeric =====================================================================================================
+    case ClassNumeric: {
+        caNumeric *numericWidget = static_cast<caNumeric *>(w);
         // qDebug() << "caNumeric" << numericWidget->objectName() << data.pv;
 
         if(data.edata.connected) {
@@ -4999,9 +5286,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             numericWidget->setConnectedColors(false);
         }
+        break;
+    }
 
-        // Numeric =====================================================================================================
-    } else if (caSpinbox *spinboxWidget = qobject_cast<caSpinbox *>(w)) {
+    // Numeric =====================================================================================================
+    case ClassSpinbox: {
+        caSpinbox *spinboxWidget = static_cast<caSpinbox *>(w);
         //qDebug() << "caSpinbox" << spinboxWidget->objectName() << data.pv;
 
         if(data.edata.connected) {
@@ -5022,9 +5312,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             spinboxWidget->setConnectedColors(false);
         }
+        break;
+    }
 
-        // Toggle =====================================================================================================
-    } else if (caToggleButton *togglebuttonWidget = qobject_cast<caToggleButton *>(w)) {
+    // Toggle =====================================================================================================
+    case ClassToggleButton: {
+        caToggleButton *togglebuttonWidget = static_cast<caToggleButton *>(w);
         //qDebug() << "caToggleButton" << togglebuttonWidget->objectName() << data.pv;
         Qt::CheckState state = Qt::Unchecked;
 
@@ -5043,9 +5336,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             SetColorsNotConnected(togglebuttonWidget);
         }
+        break;
+    }
 
-        // cartesian plot ==================================================================================================================
-    } else if (caCartesianPlot *cartesianplotWidget = qobject_cast<caCartesianPlot *>(w)) {
+    // cartesian plot ==================================================================================================================
+    case ClassCartesianPlot: {
+        caCartesianPlot *cartesianplotWidget = static_cast<caCartesianPlot *>(w);
         //qDebug() << "caCartesianPlot" << cartesianplotWidget->objectName() << data.pv << data.specData[0] << data.specData[1]  << data.specData[2];
 
         int curvNB = data.specData[0];    // curve or scale number
@@ -5130,9 +5426,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             cartesianplotWidget->setWhiteColors();
             cartesianplotWidget->setProperty("Connect", false);
         }
+        break;
+    }
 
-        // waterfall plot ==================================================================================================================
-    } else if (caWaterfallPlot *waterfallplotWidget = qobject_cast<caWaterfallPlot *>(w)) {
+    // waterfall plot ==================================================================================================================
+    case ClassWaterfallPlot: {
+        caWaterfallPlot *waterfallplotWidget = static_cast<caWaterfallPlot *>(w);
         //qDebug() << "caWaterfallPlot" << waterfallplotWidget->objectName() << data.pv;
 
         int pvType = data.specData[0];      // waveform=0; Count=1
@@ -5189,9 +5488,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
 
         }
+        break;
+    }
 
-        // stripchart ==================================================================================================================
-    } else if(caStripPlot *stripplotWidget = qobject_cast<caStripPlot *>(w)) {
+    // stripchart ==================================================================================================================
+    case ClassStripPlot: {
+        caStripPlot *stripplotWidget = static_cast<caStripPlot *>(w);
 
         int actPlot= data.specData[1];
         if(data.edata.connected) {
@@ -5234,9 +5536,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             }
 
         }
+        break;
+    }
 
-        // animated gif ==================================================================================================================
-    } else if(caImage *imageWidget = qobject_cast<caImage *>(w)) {
+    // animated gif ==================================================================================================================
+    case ClassImage: {
+        caImage *imageWidget = static_cast<caImage *>(w);
 
         double valueArray[MAX_CALC_INPUTS];
         char post[256];
@@ -5278,11 +5583,11 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
                 // scan and get the channels
                 for(int i=0; i < 4; i++) valueArray[i] = 0.0;
                 for(int i=0; i< nbMonitors;i++) {
-                    knobData *ptr = mutexKnobDataP->GetMutexKnobDataPtr(list.at(i+1).toInt());
-                    if(ptr != (knobData *) 0) {
+                    knobSnapshot snapshot;
+                    if(mutexKnobDataP->GetMutexKnobDataSnapshot(list.at(i+1).toInt(), snapshot)) {
                         // when connected
-                        if(ptr->edata.connected) {
-                            valueArray[i] = ptr->edata.rvalue;
+                        if(snapshot.edata.connected) {
+                            valueArray[i] = snapshot.edata.rvalue;
                         } else {
                             valueArray[i] = 0.0;
                         }
@@ -5316,9 +5621,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
 
             }
         }
+        break;
+    }
 
-        // table with pv name, value and unit==========================================================================
-    } else if(caTable *tableWidget = qobject_cast<caTable *>(w)) {
+    // table with pv name, value and unit==========================================================================
+    case ClassTable: {
+        caTable *tableWidget = static_cast<caTable *>(w);
 
         int row= data.specData[0];
 
@@ -5343,9 +5651,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             tableWidget->displayText(row, 1, NOTCONNECTED, "NC");
             tableWidget->displayText(row, 2, NOTCONNECTED, "NC");
         }
+        break;
+    }
 
-        // table for waveform values==========================================================================
-    } else if(caWaveTable *wavetableWidget = qobject_cast<caWaveTable *>(w)) {
+    // table for waveform values==========================================================================
+    case ClassWaveTable: {
+        caWaveTable *wavetableWidget = static_cast<caWaveTable *>(w);
 
         if(data.edata.connected) {
             // data from vector
@@ -5386,9 +5697,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             }
             wavetableWidget->setStringList(list, NOTCONNECTED, list.size());
         }
+        break;
+    }
 
-        // bitnames table with text and coloring according the value=========================================================
-    } else if (caBitnames *bitnamesWidget = qobject_cast<caBitnames *>(w)) {
+    // bitnames table with text and coloring according the value=========================================================
+    case ClassBitnames: {
+        caBitnames *bitnamesWidget = static_cast<caBitnames *>(w);
         if(data.edata.connected) {
             // set enum strings
             if(data.edata.fieldtype == caENUM) {
@@ -5401,9 +5715,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             // todo
         }
+        break;
+    }
 
-        // camera =========================================================
-    } else if (caCamera *cameraWidget = qobject_cast<caCamera *>(w)) {
+    // camera =========================================================
+    case ClassCamera: {
+        caCamera *cameraWidget = static_cast<caCamera *>(w);
 
         //qDebug() << data.pv << data.edata.connected << data.specData[0];
         if(data.edata.connected) {
@@ -5456,9 +5773,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
             cameraWidget->showDisconnected();
             // todo
         }
+        break;
+    }
 
-        // scan2d =========================================================
-    } else if (caScan2D *scan2dWidget = qobject_cast<caScan2D *>(w)) {
+    // scan2d =========================================================
+    case ClassScan2D: {
+        caScan2D *scan2dWidget = static_cast<caScan2D *>(w);
 
         //qDebug() << "Callback_UpdateWidget: caScan2D" << data.pv << data.edata.connected << data.specData[0];
         if (data.edata.connected) {
@@ -5501,9 +5821,12 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         } else {
             //scan2dWidget->showDisconnected();
         }
+        break;
+    }
 
-        // messagebutton, yust treat access ==========================================================================
-    } else if (caMessageButton *messagebuttonWidget = qobject_cast<caMessageButton *>(w)) {
+    // messagebutton, yust treat access ==========================================================================
+    case ClassMessageButton: {
+        caMessageButton *messagebuttonWidget = static_cast<caMessageButton *>(w);
 
         if(data.edata.connected) {
 
@@ -5527,13 +5850,18 @@ void CaQtDM_Lib::Callback_UpdateWidget(int indx, QWidget *w,
         }
         messagebuttonWidget->setAccessW((bool) data.edata.accessW);
         updateAccessCursor(messagebuttonWidget);
+        break;
+    }
 
-        // something else (user defined monitors with non ca imageWidgets ?) ==============================================
-    } else {
+    // something else (user defined monitors with non ca imageWidgets ?) ==============================================
+    default:
         qDebug() << "unrecognized widget" << w->metaObject()->className();
+        break;
     }
 }
 
+}
+
 void CaQtDM_Lib::Cartesian(caCartesianPlot *widget, int curvNB, int curvType, int XorY, const knobData &data)
 {
     QMutex *datamutex;
@@ -5805,9 +6133,11 @@ void CaQtDM_Lib::Callback_CaCalc(double value)
             if(kPtr->soft) {
                 //qDebug() << "write softpv at" << kPtr->index << kPtr->pv << "with value" << value;
                 kPtr = mutexKnobDataP->GetMutexKnobDataPtr(indx);  // use pointer
+                mutexKnobDataP->BeginMutexKnobDataWrite(indx);
                 kPtr->edata.rvalue = value;
                 kPtr->edata.ivalue = (int) value;
                 kPtr->edata.monitorCount++;
+                mutexKnobDataP->EndMutexKnobDataWrite(indx);
             }
         }
     }
@@ -6315,6 +6645,7 @@ void CaQtDM_Lib::closeEvent(QCloseEvent* ce)
             kData.index = -1;
             //kData.pv[0] = '\0';
             mutexKnobDataP->SetMutexKnobData(i, kData);
+            if(alarmTree != (AlarmTree *) 0) alarmTree->removeMember(i);
         }
     }
 
@@ -6829,6 +7160,10 @@ void CaQtDM_Lib::DisplayContextMenu(QWidget* w)
                         info.append(" Flavor: ");
                         info.append(kPtr->pluginFlavor);
                     }
+                    if(strlen(kPtr->pluginOptions) > 0) {
+                        info.append(" Options: ");
+                        info.append(kPtr->pluginOptions);
+                    }
                     ControlsInterface * plugininterface = getControlInterface(kPtr->pluginName);
                     if(plugininterface == (ControlsInterface *) 0) {
                          if(!kPtr->soft)info.append(" : not loaded");
@@ -7591,7 +7926,9 @@ void CaQtDM_Lib::TreatOrdinaryValue(QString pvo, double value, int32_t idata,  Q
             if(kPtr->soft) {
                 //qDebug() << "write softpv";
                 kPtr = mutexKnobDataP->GetMutexKnobDataPtr(indx);  // use pointer
+                mutexKnobDataP->BeginMutexKnobDataWrite(indx);
                 kPtr->edata.rvalue = value;
+                mutexKnobDataP->EndMutexKnobDataWrite(indx);
                 // set value also into widget, will be overwritten when driven from other channels
                 caCalc * ww = (caCalc*) kPtr->dispW;
                 ww->setValue(value);
@@ -7792,7 +8129,10 @@ void CaQtDM_Lib::TreatRequestedValue(QString pvo, QString text, FormatType fType
         if(match) {
             //qDebug() << "decoded as double, and set as double" << value;
             if(kPtr->soft) {
+                int index = kPtr->index;
+                mutexKnobDataP->BeginMutexKnobDataWrite(index);
                 kPtr->edata.rvalue = value;
+                mutexKnobDataP->EndMutexKnobDataWrite(index);
                 // set value also into widget, will be overwritten when driven from other channels
                 caCalc * ww = (caCalc*) kPtr->dispW;
                 ww->setValue(value);
@@ -8101,12 +8441,6 @@ void CaQtDM_Lib::resizeSpecials(QString className, QWidget *widget, QVariantList
         f.setPointSize(qRound(fontSize));
 
         table->setUpdatesEnabled(false);
-        for(int i = 0; i < table->rowCount(); ++i) {
-            for(int j = 0; j < table->columnCount(); ++j) {
-                QTableWidgetItem* selectedItem = table->item(i, j);
-                if(selectedItem != (QTableWidgetItem*) 0) selectedItem->setFont(f);
-            }
-        }
         table->setValueFont(f);
         table->verticalHeader()->setDefaultSectionSize((int) (qMin(factX, factY)*20));
 
@@ -8125,12 +8459,6 @@ void CaQtDM_Lib::resizeSpecials(QString className, QWidget *widget, QVariantList
         f.setPointSize(qRound(fontSize));
 
         table->setUpdatesEnabled(false);
-        for(int i = 0; i < table->rowCount(); ++i) {
-            for(int j = 0; j < table->columnCount(); ++j) {
-                QTableWidgetItem* selectedItem = table->item(i, j);
-                if(selectedItem != (QTableWidgetItem*) 0) selectedItem->setFont(f);
-            }
-        }
         table->setValueFont(f);
         table->verticalHeader()->setDefaultSectionSize((int) (qMin(factX, factY)*20));
 
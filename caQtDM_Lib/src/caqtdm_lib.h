@@ -74,6 +74,9 @@
 #include "sliderDialog.h"
 #include "splashscreen.h"
 #include "messageQueue.h"
+#include "macroTemplate.h"
+#include "frameScheduler.h"
+#include "alarmTree.h"
 
 // interface to different controlsystems
 #include "controlsinterface.h"
@@ -98,6 +101,7 @@
 
 // 50 levels of includes should do it
 #define CAQTDM_MAX_INCLUDE_LEVEL 50
+#define MAXMACRODEPTH 10
 
 
 
@@ -273,12 +277,17 @@ private:
 
     void scanChildren(QList<QWidget*> children, QWidget *tab, int i);
     QWidget* getTabParent(QWidget *w1);
-    QString treatMacro(QMap<QString, QString> map, const QString& pv, bool *doNothing, QString widgetName = "");
+    QString treatMacro(const QMap<QString, QString> &map, const QString& pv, bool *doNothing, QString widgetName = "");
+    QString expandMacroTemplate(const QMap<QString, QString> &map, const QString &text, int depth, QString &unresMacro);
+    bool expandSpecialMacro(const MacroTemplate::segment &seg, QString &value);
     void scanWidgets(QList<QWidget*> list, QString macro);
     void HandleWidget(QWidget *w, QString macro, bool firstPass, bool treatPrimaries);
     void closeEvent(QCloseEvent* ce);
     bool CalcVisibility(QWidget *w, double &result, bool &valid);
     short ComputeAlarm(QWidget *w);
+    int ResolveUpdateClass(QWidget *w);
+    void SetUpdateHandler(int indx, QWidget *w, int updateClass);
+    void UpdateWidgetByClass(int updateClass, QWidget *w, const QString& units, const QString& String, const knobData& data);
     int setObjectVisibility(QWidget *w, double value);
     bool reaffectText(QMap<QString, QString> map, QString *text, QWidget *w);
     int InitVisibility(QWidget* widget, knobData *kData, QMap<QString, QString> map,  int *specData, QString info);
@@ -333,6 +342,7 @@ private:
     QList<caCalc *> allCalcs_Vectors;
 
     QMap<QString, QString> unknownMacrosList;
+    QHash<QString, QMap<QString, QString> > macroMapCache; // macro maps built from macro strings for this display
     QTableWidget* macroTable;
     QDialog *macroWindow;
 
@@ -347,6 +357,7 @@ private:
 #endif
 
     QMap<QString, QString> createMap(const QString&);
+    QMap<QString, QString> getMacroMap(const QString &macro);
     QString createMacroStringFromMap(QMap<QString, QString> map);
     QMap<QString, QString> actualizeMacroMap();
     QString actualizeMacroString(QMap<QString, QString> map, QString argument);
@@ -372,9 +383,29 @@ private:
     bool AllowsUpdate;
     bool fromAS;
 
+    // how the widget of a knob index is updated
+    enum UpdateClass {ClassForeign = -1, ClassUnknown = 0, ClassInterface, ClassCalc, ClassLabel,
+                      ClassLabelVertical, ClassInclude, ClassFrame, ClassMenu, ClassChoice, ClassThermo,
+                      ClassSlider, ClassClock, ClassLinearGauge, ClassCircularGauge, ClassMeter, ClassByte,
+                      ClassByteController, ClassLineEdit, ClassMultiLineString, ClassGraphics, ClassPolyLine,
+                      ClassLed, ClassApplyNumeric, ClassNumeric, ClassSpinbox, ClassToggleButton,
+                      ClassCartesianPlot, ClassWaterfallPlot, ClassStripPlot, ClassImage, ClassTable,
+                      ClassWaveTable, ClassBitnames, ClassCamera, ClassScan2D, ClassMessageButton};
+    typedef struct _updateHandler {
+        QWidget *widget;
+        int updateClass;
+        const char *className;
+        short severity;
+    } updateHandler;
+    QVector<updateHandler> updateHandlers;
+
     int loopTimer;
     int loopTimerID;
 
+    FrameScheduler *frameScheduler;
+    AlarmTree *alarmTree;
+    bool updateStatistics;
+
     QMap<QString, ControlsInterface*> controlsInterfaces;
     MutexKnobData *mutexKnobDataP;
     MessageWindow *messageWindowP;
@@ -402,7 +433,7 @@ private slots:
     void Callback_ScriptButton();
 
     void Callback_UpdateWidget(int, QWidget *w, const QString& units,const QString& fec,
-                               const QString& statusString, const knobData& data);
+                               const QString& statusString, const knobUpdate& update);
     void Callback_UpdateLine(const QString&, const QString&);
     void Callback_MenuClicked(const QString&);
     void Callback_ChoiceClicked(const QString&);
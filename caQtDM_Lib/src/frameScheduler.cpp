@@ -0,0 +1,186 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <QEvent>
+#include <QCoreApplication>
+#include <QAbstractScrollArea>
+#if QT_VERSION >= 0x050000
+#include <QWindow>
+#endif
+#include <qwt_plot.h>
+#include <qwt_plot_canvas.h>
+
+#include "frameScheduler.h"
+
+// how often a held back frame is retried while the window can not be seen (ms)
+#define HIDDENRETRY 250
+
+FrameScheduler::FrameScheduler(QWidget *window, int frameRate, bool statistics) : QObject(window)
+{
+    this->window = window;
+    this->statistics = statistics;
+    this->frameRate = 0;
+    timerID = 0;
+    pending = false;
+    release = false;
+    frames = requests = 0;
+    lastFrame.start();
+    statisticsTime.start();
+    setFrameRate(frameRate);
+}
+
+/**
+ * a frame rate <= 0 lets all update requests pass as before
+ */
+void FrameScheduler::setFrameRate(int rate)
+{
+    if(rate > 0 && frameRate <= 0) {
+        window->installEventFilter(this);
+    } else if(rate <= 0 && frameRate > 0) {
+        window->removeEventFilter(this);
+        if(pending) {
+            pending = false;
+            release = true;
+            QCoreApplication::postEvent(window, new QEvent(QEvent::UpdateRequest), Qt::LowEventPriority);
+        }
+    }
+    frameRate = rate;
+}
+
+/**
+ * qwt canvases repaint synchronously on every replot, let them update instead so that
+ * their painting is part of the next frame
+ */
+void FrameScheduler::deferPlots(QWidget *parent)
+{
+#if QWT_VERSION >= 0x060000
+    if(frameRate <= 0) return;
+    QList<QwtPlot *> plots = parent->findChildren<QwtPlot *>();
+    foreach(QwtPlot *plot, plots) {
+        QwtPlotCanvas *canvas = qobject_cast<QwtPlotCanvas *>(plot->canvas());
+        if(canvas != (QwtPlotCanvas *) 0) canvas->setPaintAttribute(QwtPlotCanvas::ImmediatePaint, false);
+    }
+#else
+    Q_UNUSED(parent);
+#endif
+}
+
+/**
+ * time the paint events of our widgets when statistics are requested; viewports of scroll areas
+ * are skipped, their paint events have to go through the filter of the scroll area
+ */
+void FrameScheduler::watchPaints(QWidget *parent)
+{
+    if(!statistics) return;
+    QList<QWidget *> all = parent->findChildren<QWidget *>();
+    foreach(QWidget *w, all) {
+        if(qobject_cast<QAbstractScrollArea *>(w->parentWidget()) != (QAbstractScrollArea *) 0) continue;
+        if(!QString(w->metaObject()->className()).startsWith("ca")) continue;
+        w->installEventFilter(this);
+    }
+}
+
+bool FrameScheduler::windowVisible()
+{
+    if(!window->isVisible() || window->isMinimized()) return false;
+#if QT_VERSION >= 0x050000
+    if(window->windowHandle() != (QWindow *) 0 && !window->windowHandle()->isExposed()) return false;
+#endif
+    return true;
+}
+
+void FrameScheduler::scheduleFrame()
+{
+    if(timerID != 0) return;
+    int interval = 1000 / frameRate - (int) lastFrame.elapsed();
+    timerID = startTimer(qMax(interval, 0));
+}
+
+bool FrameScheduler::eventFilter(QObject *obj, QEvent *event)
+{
+    if(obj == window) {
+        if(event->type() == QEvent::UpdateRequest && frameRate > 0) {
+            if(release) {
+                release = false;
+                return false;
+            }
+            // keep it for the next frame, the dirty regions stay in the backing store
+            requests++;
+            pending = true;
+            scheduleFrame();
+            return true;
+        }
+        return false;
+    }
+
+    if(statistics && event->type() == QEvent::Paint) {
+        QElapsedTimer timer;
+        timer.start();
+        obj->event(event);
+        paintStatistics &stat = paintStats[obj->metaObject()->className()];
+        stat.paints++;
+        stat.nsecs += timer.nsecsElapsed();
+        return true;
+    }
+    return false;
+}
+
+void FrameScheduler::timerEvent(QTimerEvent *event)
+{
+    Q_UNUSED(event);
+    killTimer(timerID);
+    timerID = 0;
+    if(!pending) return;
+
+    if(!windowVisible()) {
+        timerID = startTimer(HIDDENRETRY);
+        return;
+    }
+
+    pending = false;
+    release = true;
+    frames++;
+    lastFrame.restart();
+    QCoreApplication::postEvent(window, new QEvent(QEvent::UpdateRequest), Qt::LowEventPriority);
+}
+
+/**
+ * frames and paint times since the last call
+ */
+QString FrameScheduler::getStatistics()
+{
+    double secs = statisticsTime.restart() / 1000.0;
+    if(secs <= 0.0) secs = 1.0;
+    QString text = QString("frames/s=%1 held back requests/s=%2").arg(frames / secs, 0, 'f', 1).arg(requests / secs, 0, 'f', 1);
+    QMapIterator<QString, paintStatistics> i(paintStats);
+    while (i.hasNext()) {
+        i.next();
+        text.append(QString("\n   %1 paints/s=%2 average=%3us").arg(i.key()).arg(i.value().paints / secs, 0, 'f', 1)
+                    .arg(i.value().nsecs / 1000.0 / qMax(i.value().paints, 1), 0, 'f', 1));
+    }
+    frames = requests = 0;
+    paintStats.clear();
+    return text;
+}
@@ -0,0 +1,86 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QMap>
+#include <QString>
+#include <QElapsedTimer>
+
+// default frame rate of a display, the fastest rate channels are updated with
+#define DEFAULTFRAMERATE 50
+
+/**
+ * limits the repaints of a display window to a frame rate: the update requests of the
+ * window are held back and released at most once per frame, in the meantime the dirty
+ * regions of all widgets (qwt plot canvases included) accumulate in the backing store;
+ * nothing is painted while the window is minimized, hidden or fully obscured
+ */
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    FrameScheduler(QWidget *window, int frameRate, bool statistics);
+
+    void setFrameRate(int frameRate);
+    int getFrameRate() const { return frameRate; }
+
+    void deferPlots(QWidget *parent);
+    void watchPaints(QWidget *parent);
+
+    bool hasStatistics() const { return statistics; }
+    QString getStatistics();
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+    void timerEvent(QTimerEvent *event);
+
+private:
+    typedef struct _paintStatistics {
+        int paints;
+        qint64 nsecs;
+    } paintStatistics;
+
+    bool windowVisible();
+    void scheduleFrame();
+
+    QWidget *window;
+    int frameRate;
+    int timerID;
+    bool pending;
+    bool release;
+    QElapsedTimer lastFrame;
+
+    bool statistics;
+    int frames, requests;
+    QElapsedTimer statisticsTime;
+    QMap<QString, paintStatistics> paintStats;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -96,6 +96,7 @@ typedef struct _knobData {
     void *pluginInterface;              /* plugin pointer */
     caqtdm_string_t pluginName;         /* plugin name */
     caqtdm_string_t pluginFlavor;       /* plugin additional data */
+    pv_string pluginOptions;            /* plugin request options, given after ? with the channel */
 } knobData;
 
 #ifdef __cplusplus
@@ -0,0 +1,94 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include "macroTemplate.h"
+
+// the cache is simply dropped when it gets that large
+#define MAXCACHEDTEMPLATES 20000
+
+QSharedPointer<const MacroTemplate> MacroTemplate::compile(const QString &text)
+{
+    static QHash<QString, QSharedPointer<const MacroTemplate> > cache;
+
+    QHash<QString, QSharedPointer<const MacroTemplate> >::const_iterator it = cache.constFind(text);
+    if(it != cache.constEnd()) return it.value();
+
+    if(cache.size() > MAXCACHEDTEMPLATES) cache.clear();
+    QSharedPointer<const MacroTemplate> compiled(new MacroTemplate(text));
+    cache.insert(text, compiled);
+    return compiled;
+}
+
+MacroTemplate::MacroTemplate(const QString &text)
+{
+    int pos = 0;
+    int literalStart = 0;
+    int length = text.size();
+
+    macros = false;
+
+    while(true) {
+        int start = text.indexOf("$(", pos);
+        if(start < 0) break;
+
+        // name ends with ) or with { for the json form
+        int k = start + 2;
+        while(k < length && text.at(k) != QLatin1Char(')') && text.at(k) != QLatin1Char('{') && text.at(k) != QLatin1Char('$')) k++;
+        if(k >= length) break;
+        if(text.at(k) == QLatin1Char('$')) {
+            pos = k;
+            continue;
+        }
+
+        segment seg;
+        int end;
+        seg.text = text.mid(start + 2, k - start - 2);
+        if(text.at(k) == QLatin1Char(')')) {
+            seg.type = Variable;
+            end = k + 1;
+        } else {
+            int close = text.indexOf("})", k);
+            if(close < 0) break;
+            seg.type = Special;
+            seg.json = text.mid(k, close - k + 1);
+            end = close + 2;
+        }
+        seg.raw = text.mid(start, end - start);
+
+        if(start > literalStart) addLiteral(text.mid(literalStart, start - literalStart));
+        segments.append(seg);
+        macros = true;
+        literalStart = pos = end;
+    }
+    if(literalStart < length) addLiteral(text.mid(literalStart));
+}
+
+void MacroTemplate::addLiteral(const QString &text)
+{
+    segment seg;
+    seg.type = Literal;
+    seg.text = text;
+    segments.append(seg);
+}
@@ -0,0 +1,64 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef MACROTEMPLATE_H
+#define MACROTEMPLATE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QSharedPointer>
+
+/**
+ * a text with macros, split once into literal parts and macro references
+ * $(NAME) and $(NAME{"regex":"...","value":"..."}); compiled templates are cached by their text
+ */
+class MacroTemplate
+{
+public:
+
+    enum SegmentType {Literal=0, Variable, Special};
+
+    typedef struct _segment {
+        SegmentType type;
+        QString text;      // literal text or macro name
+        QString json;      // json part of a special macro
+        QString raw;       // macro as written in the text
+    } segment;
+
+    static QSharedPointer<const MacroTemplate> compile(const QString &text);
+
+    bool hasMacros() const { return macros; }
+    const QList<segment> &getSegments() const { return segments; }
+
+private:
+    explicit MacroTemplate(const QString &text);
+    void addLiteral(const QString &text);
+
+    QList<segment> segments;
+    bool macros;
+};
+
+#endif // MACROTEMPLATE_H
@@ -34,31 +34,64 @@
 #include <QDebug>
 #include "QtControls"
 
+// the statistics counters are read by the timer while their thread increments them
+static inline int atomicLoad(int *value)
+{
+    QBasicAtomicInt *atomic = reinterpret_cast<QBasicAtomicInt *>(value);
+#if QT_VERSION >= 0x050000
+    return atomic->loadAcquire();
+#else
+    return atomic->fetchAndAddOrdered(0);
+#endif
+}
+
+static inline void atomicStore(int *value, int newValue)
+{
+    QBasicAtomicInt *atomic = reinterpret_cast<QBasicAtomicInt *>(value);
+#if QT_VERSION >= 0x050000
+    atomic->storeRelease(newValue);
+#else
+    atomic->fetchAndStoreOrdered(newValue);
+#endif
+}
+
+static inline void atomicIncrement(int *value)
+{
+    reinterpret_cast<QBasicAtomicInt *>(value)->fetchAndAddRelaxed(1);
+}
+
+// full barrier, keeps the knob accesses on their side of a sequence change
+static inline int atomicIncrementOrdered(int *value)
+{
+    return reinterpret_cast<QBasicAtomicInt *>(value)->fetchAndAddOrdered(1);
+}
+
+static inline int atomicLoadOrdered(int *value)
+{
+    return reinterpret_cast<QBasicAtomicInt *>(value)->fetchAndAddOrdered(0);
+}
+
+// retries of a snapshot before waiting for the writer
+#define SNAPSHOT_RETRIES 100
+
 /**
  * this routine (re)allocates memory and copies the old data to the new memory
  */
 MutexKnobData::MutexKnobData()
 {
-    KnobDataArraySize=500;
-    KnobData = (knobData*) malloc(KnobDataArraySize * sizeof(knobData));
-    if (KnobData==NULL) {
-        printf("caQtDM -- could not allocate memory -> exit\n");
-        exit(1);
-    }
-    for(int i=0; i < KnobDataArraySize; i++){
-        KnobData[i].index  = -1;
-        KnobData[i].thisW = (void*) 0;
-        KnobData[i].mutex = (void*) 0;
+    KnobDataArraySize=0;
+    KnobDataChunkCount=0;
+    for(int i=0; i < KNOBDATA_STRIPES; i++) {
+        KnobStripes[i].countPV = KnobStripes[i].countNotConnected = KnobStripes[i].countDisplayed = 0;
     }
+    AddKnobDataChunk();
 
     nbMonitorsPerSecond = 0;
     nbDisplayCountPerSecond = 0;
-    nbMonitors = 0;
-    displayCount = 0;
-    highestCount = 0;
-    highestIndex = 0;
     highestIndexPV = 0;
     highestCountPerSecond = 0;
+    statisticsEpoch = 0;
+    monitorsTotal = displaysTotal = 0;
 
     ftime(&last);
     ftime(&monitorTiming);
@@ -74,6 +107,19 @@ MutexKnobData::MutexKnobData()
 
 MutexKnobData:: ~MutexKnobData()
 {
+    for(int i=0; i < KnobDataChunkCount; i++) {
+        free(KnobDataChunks[i]);
+        delete [] KnobSlotChunks[i];
+    }
+    // counters of threads still running stay with their thread storage
+    foreach(threadCounters *counters, threadCountersList) {
+        if(atomicLoad(&counters->inUse) == 0) delete counters;
+    }
+}
+
+MutexKnobData::threadCountersHandle::~threadCountersHandle()
+{
+    atomicStore(&counters->inUse, 0);
 }
 
 /**
@@ -141,30 +187,30 @@ void  MutexKnobData::BuildSoftPVList(QWidget *w)
     softPV_List.clear();
     // go through all our monitors
     for(int i=0; i < KnobDataArraySize; i++) {
-        if(KnobData[i].index != -1 && KnobData[i].soft) {
-            QWidget *w1 = (QWidget*) KnobData[i].thisW;
+        if(KnobDataAt(i)->index != -1 && KnobDataAt(i)->soft) {
+            QWidget *w1 = (QWidget*) KnobDataAt(i)->thisW;
             // when the main widget corresponds keep it
             if(w == w1) {
-                sprintf(asc, "%s_%d_%p", KnobData[i].pv, KnobData[i].index, w);
-                softstruct.pv = QString(KnobData[i].pv);
-                softstruct.index = KnobData[i].index;
+                sprintf(asc, "%s_%d_%p", KnobDataAt(i)->pv, KnobDataAt(i)->index, w);
+                softstruct.pv = QString(KnobDataAt(i)->pv);
+                softstruct.index = KnobDataAt(i)->index;
                 softstruct.w = w;
                 softPV_List.insert(asc, softstruct);
-                //qDebug() << "insert softpv_list" << asc << KnobData[i].dispName ;
+                //qDebug() << "insert softpv_list" << asc << KnobDataAt(i)->dispName ;
             }
         }
         // for softpvs that were not yet known as soft pv, add them
-        if(KnobData[i].index != -1) {
+        if(KnobDataAt(i)->index != -1) {
             int index;
-            if(getSoftPV(KnobData[i].pv, &index, (QWidget *) KnobData[i].thisW)) {
+            if(getSoftPV(KnobDataAt(i)->pv, &index, (QWidget *) KnobDataAt(i)->thisW)) {
                 mutex.unlock();
-                sprintf(asc, "%s_%d_%p", KnobData[i].pv, KnobData[i].index, w);
-                softstruct.pv = QString(KnobData[i].pv);
-                softstruct.index = KnobData[i].index;
+                sprintf(asc, "%s_%d_%p", KnobDataAt(i)->pv, KnobDataAt(i)->index, w);
+                softstruct.pv = QString(KnobDataAt(i)->pv);
+                softstruct.index = KnobDataAt(i)->index;
                 softstruct.w = w;
                 softPV_List.insert(asc, softstruct);
-                InsertSoftPV(KnobData[i].pv, KnobData[i].index, (QWidget *) KnobData[i].thisW);
-                //qDebug() << "insert untill now unknown pv" << asc << KnobData[i].index;
+                InsertSoftPV(KnobDataAt(i)->pv, KnobDataAt(i)->index, (QWidget *) KnobDataAt(i)->thisW);
+                //qDebug() << "insert untill now unknown pv" << asc << KnobDataAt(i)->index;
                 mutex.lock();
             }
         }
@@ -195,8 +241,8 @@ void MutexKnobData::RemoveSoftPV(QString pv, QWidget *w, int indx)
 
     // and remove from the global list
     char asc1[MAXPVLEN+20];
-    QWidget *w1 = (QWidget*) KnobData[indx].thisW;
-    sprintf(asc1, "%s_%d_%p",  KnobData[indx].pv, KnobData[indx].index,  w1);
+    QWidget *w1 = (QWidget*) KnobDataAt(indx)->thisW;
+    sprintf(asc1, "%s_%d_%p",  KnobDataAt(indx)->pv, KnobDataAt(indx)->index,  w1);
     softPV_List.remove(asc1);
 
 /*
@@ -222,6 +268,8 @@ void MutexKnobData::UpdateSoftPV(QString pv, double value, QWidget *w, int dataI
     QMap<QString, int>::const_iterator name = softPV_WidgetList.find(asc);
     if(name != softPV_WidgetList.end()) {
         knobData *ptr = GetMutexKnobDataPtr(name.value());
+        QMutexLocker locker(StripeMutex(name.value()));
+        BeginKnobWrite(name.value());
         ptr->edata.fieldtype = caDOUBLE;
         ptr->edata.precision = 3;
 
@@ -249,6 +297,8 @@ void MutexKnobData::UpdateSoftPV(QString pv, double value, QWidget *w, int dataI
             double *data = (double *) ptr->edata.dataB;
             data[dataIndex] = value;
         }
+        EndKnobWrite(name.value());
+        UpdateKnobDataCounters(name.value());
     }
 
     // and update everywhere where this soft channel is also used on this main window
@@ -259,32 +309,35 @@ void MutexKnobData::UpdateSoftPV(QString pv, double value, QWidget *w, int dataI
         softstruct = i.value();
         if(pv == softstruct.pv) {
             int indx = softstruct.index;
-            if(KnobData[indx].index != -1 && KnobData[indx].pv == pv && softstruct.w == w) {
+            if(KnobDataAt(indx)->index != -1 && KnobDataAt(indx)->pv == pv && softstruct.w == w) {
                 //qDebug() <<  "     update index=" << softstruct.index << i.key() <<  w << "with" << value;
+                QMutexLocker locker(StripeMutex(indx));
+                BeginKnobWrite(indx);
 
                 // simple double
                 if(dataCount <= 1) {
-                    KnobData[indx].edata.rvalue = value;
+                    KnobDataAt(indx)->edata.rvalue = value;
 
                 // waveform
                 } else {
                     // allocate and initialize data to nan
-                    if((int) (dataCount * sizeof(double)) !=  KnobData[indx].edata.dataSize) {
-                        if( KnobData[indx].edata.dataB != (void*) 0) free( KnobData[indx].edata.dataB);
-                        KnobData[indx].edata.dataB = (void*) malloc(dataCount * sizeof(double));
-                        double *data = (double *) KnobData[indx].edata.dataB;
+                    if((int) (dataCount * sizeof(double)) !=  KnobDataAt(indx)->edata.dataSize) {
+                        if( KnobDataAt(indx)->edata.dataB != (void*) 0) free( KnobDataAt(indx)->edata.dataB);
+                        KnobDataAt(indx)->edata.dataB = (void*) malloc(dataCount * sizeof(double));
+                        double *data = (double *) KnobDataAt(indx)->edata.dataB;
                         for(int i=0; i<dataCount; i++) data[i] = qQNaN();
                     }
-                    KnobData[indx].edata.dataSize = dataCount * sizeof(double);
-                    KnobData[indx].edata.valueCount = dataCount;
-                    KnobData[indx].edata.rvalue = value;
+                    KnobDataAt(indx)->edata.dataSize = dataCount * sizeof(double);
+                    KnobDataAt(indx)->edata.valueCount = dataCount;
+                    KnobDataAt(indx)->edata.rvalue = value;
                 }
-                KnobData[indx].edata.fieldtype = caDOUBLE;
-                KnobData[indx].edata.precision = 3;
-                KnobData[indx].edata.connected = true;
-                KnobData[indx].edata.upper_disp_limit=0.0;
-                KnobData[indx].edata.lower_disp_limit=0.0;
-                KnobData[indx].edata.connected = true;
+                KnobDataAt(indx)->edata.fieldtype = caDOUBLE;
+                KnobDataAt(indx)->edata.precision = 3;
+                KnobDataAt(indx)->edata.connected = true;
+                KnobDataAt(indx)->edata.upper_disp_limit=0.0;
+                KnobDataAt(indx)->edata.lower_disp_limit=0.0;
+                EndKnobWrite(indx);
+                UpdateKnobDataCounters(indx);
             }
         }
     }
@@ -313,10 +366,10 @@ bool MutexKnobData::getSoftPV(QString pv, int *indx, QWidget *w)
 knobData MutexKnobData::GetMutexKnobData(int index)
 {
     knobData kData;
-    QMutexLocker locker(&mutex);
+    QMutexLocker locker(StripeMutex(index));
 
-    memcpy(&kData, &KnobData[index], sizeof(knobData));
-    memcpy(&kData.edata, &KnobData[index].edata, sizeof(epicsData));
+    memcpy(&kData, KnobDataAt(index), sizeof(knobData));
+    memcpy(&kData.edata, &KnobDataAt(index)->edata, sizeof(epicsData));
     return kData;
 }
 
@@ -332,22 +385,216 @@ extern "C" MutexKnobData* C_GetMutexKnobData(MutexKnobData* p, int indx, knobDat
  */
 int MutexKnobData::GetMutexKnobDataIndex()
 {
-    int oldsize, newsize;
     QMutexLocker locker(&mutex);
-    for(int i=0; i < KnobDataArraySize; i++) {
-        if(KnobData[i].index == -1) {
-            return i;
+    // slots are only taken by SetMutexKnobData, entries taken meanwhile are dropped here
+    while(!KnobDataFree.isEmpty()) {
+        int i = KnobDataFree.last();
+        if(KnobDataAt(i)->index == -1) return i;
+        KnobDataFree.removeLast();
+        KnobDataInFree[i] = false;
+    }
+    int oldsize=KnobDataArraySize;
+    AddKnobDataChunk();
+    return oldsize;
+}
+
+/**
+ * add a chunk of free slots; the chunks are never moved, so pointers to knobs stay valid
+ */
+void MutexKnobData::AddKnobDataChunk()
+{
+    if(KnobDataChunkCount >= KNOBDATA_MAXCHUNKS) {
+        printf("caQtDM -- maximum number of %d channels reached -> exit\n", KNOBDATA_MAXCHUNKS * KNOBDATA_CHUNK);
+        exit (1);
+    }
+    knobData *chunk = (knobData*) malloc(KNOBDATA_CHUNK * sizeof(knobData));
+    knobSlot *slotChunk = new knobSlot[KNOBDATA_CHUNK];
+    if (chunk==NULL || slotChunk==NULL) {
+        printf("caQtDM -- could not allocate any more memory -> exit\n");
+        exit (1);
+    }
+    for(int i=0; i < KNOBDATA_CHUNK; i++){
+        chunk[i].index  = -1;
+        chunk[i].thisW = (void*) 0;
+        chunk[i].mutex = (void*) 0;
+        chunk[i].pv[0] = '\0';
+        slotChunk[i].state = 0;
+        slotChunk[i].plugin = -1;
+        slotChunk[i].sequence = 0;
+        slotChunk[i].dataMonitorCount = 0;
+    }
+    // the chunk pointers are in place before the size tells other threads about them
+    KnobDataChunks[KnobDataChunkCount] = chunk;
+    KnobSlotChunks[KnobDataChunkCount] = slotChunk;
+    KnobDataChunkCount++;
+    KnobDataInFree.resize(KnobDataArraySize + KNOBDATA_CHUNK);
+    // lowest slots are handed out first
+    for(int i=KnobDataArraySize + KNOBDATA_CHUNK - 1; i >= KnobDataArraySize; i--) {
+        KnobDataFree.append(i);
+        KnobDataInFree[i] = true;
+    }
+    atomicStore(&KnobDataArraySize, KnobDataArraySize + KNOBDATA_CHUNK);
+}
+
+/**
+ * keep free list and pv index up to date when a slot gets taken, released or renamed
+ */
+void MutexKnobData::UpdateKnobDataIndex(int index, const knobData &oldData, const knobData &newData)
+{
+    bool oldUsed = (oldData.index != -1);
+    bool newUsed = (newData.index != -1);
+
+    if(oldUsed && (!newUsed || strcmp(oldData.pv, newData.pv) != 0)) {
+        QHash<QString, QList<int> >::iterator it = KnobDataPVIndex.find(QString(oldData.pv));
+        if(it != KnobDataPVIndex.end()) {
+            it.value().removeAll(index);
+            if(it.value().isEmpty()) KnobDataPVIndex.erase(it);
         }
     }
-    oldsize=KnobDataArraySize;
-    newsize = KnobDataArraySize+200;
-    void *p = &KnobData;
-    ReAllocate(oldsize * (int) sizeof(knobData), newsize * (int) sizeof(knobData), (void**) p);
-    for(int i=oldsize; i < newsize; i++){
-        KnobData[i].index  = -1;
+    if(newUsed && (!oldUsed || strcmp(oldData.pv, newData.pv) != 0)) {
+        KnobDataPVIndex[QString(newData.pv)].append(index);
+    }
+    if(oldUsed && !newUsed && !KnobDataInFree.at(index)) {
+        KnobDataFree.append(index);
+        KnobDataInFree[index] = true;
+    }
+}
+
+/**
+ * adjust the connected/unconnected/displayed counters to the actual state of a slot,
+ * has to be called with the stripe lock of the slot held after the slot was modified
+ */
+void MutexKnobData::UpdateKnobDataCounters(int index)
+{
+    knobData *kPtr = KnobDataAt(index);
+    char state = 0;
+    if(kPtr->index != -1) {
+        state |= KnobUsed;
+        if(kPtr->edata.connected) {
+            state |= KnobConnected;
+            if(kPtr->edata.displayCount > 0) state |= KnobDisplayed;
+        }
+    }
+
+    char oldState = KnobSlotAt(index)->state;
+    if(state == oldState) return;
+
+    knobStripe *stripe = &KnobStripes[index % KNOBDATA_STRIPES];
+    if((state ^ oldState) & KnobUsed) stripe->countPV += (state & KnobUsed) ? 1 : -1;
+    if((state & KnobUsed) && !(state & KnobConnected)) stripe->countNotConnected++;
+    if((oldState & KnobUsed) && !(oldState & KnobConnected)) stripe->countNotConnected--;
+    if((state ^ oldState) & KnobDisplayed) stripe->countDisplayed += (state & KnobDisplayed) ? 1 : -1;
+    KnobSlotAt(index)->state = state;
+}
+
+/**
+ * small id for a plugin name, used for counting the monitors per plugin
+ */
+int MutexKnobData::PluginId(const char *pluginName)
+{
+    QString name(pluginName);
+    QHash<QString, int>::const_iterator it = pluginIds.constFind(name);
+    if(it != pluginIds.constEnd()) return it.value();
+    if(pluginNames.count() >= KNOBDATA_MAXPLUGINS) return -1;
+    int id = pluginNames.count();
+    pluginIds.insert(name, id);
+    pluginNames.append(name);
+    pluginMonitorsTotal.append(0);
+    pluginMonitorsPerSecond.append(0);
+    return id;
+}
+
+/**
+ * statistics counters of the calling thread, threads that ended leave theirs for the next one
+ */
+MutexKnobData::threadCounters *MutexKnobData::ThreadCounters()
+{
+    if(threadCountersStorage.hasLocalData()) return threadCountersStorage.localData()->counters;
+
+    QMutexLocker locker(&countersMutex);
+    threadCounters *counters = (threadCounters *) 0;
+    foreach(threadCounters *c, threadCountersList) {
+        if(atomicLoad(&c->inUse) == 0) {
+            counters = c;
+            break;
+        }
+    }
+    if(counters == (threadCounters *) 0) {
+        counters = new threadCounters;
+        memset(counters, 0, sizeof(threadCounters));
+        threadCountersList.append(counters);
+    }
+    atomicStore(&counters->inUse, 1);
+    threadCountersStorage.setLocalData(new threadCountersHandle(counters));
+    return counters;
+}
+
+/**
+ * sum up the counters of all threads every 5 seconds; the counters only grow,
+ * so the rates are the differences to the last sums
+ */
+void MutexKnobData::UpdateStatistics()
+{
+    struct timeb now;
+    ftime(&now);
+    double diff = ((double) now.time + (double) now.millitm / (double)1000) -
+            ((double) monitorTiming.time + (double) monitorTiming.millitm / (double)1000);
+    if(diff < 5.0) return;
+
+    uint monitors = 0, displays = 0;
+    uint plugins[KNOBDATA_MAXPLUGINS];
+    int highestCount = 0, highestIndex = -1;
+    int epoch = atomicLoad(&statisticsEpoch);
+    memset(plugins, 0, sizeof(plugins));
+
+    countersMutex.lock();
+    foreach(threadCounters *counters, threadCountersList) {
+        monitors += (uint) atomicLoad(&counters->monitors);
+        displays += (uint) atomicLoad(&counters->displays);
+        for(int i=0; i < KNOBDATA_MAXPLUGINS; i++) plugins[i] += (uint) atomicLoad(&counters->pluginMonitors[i]);
+        // find monitor with highest count since last time
+        if(atomicLoad(&counters->epoch) == epoch && atomicLoad(&counters->highestCount) > highestCount) {
+            highestCount = atomicLoad(&counters->highestCount);
+            highestIndex = atomicLoad(&counters->highestIndex);
+        }
+    }
+    countersMutex.unlock();
+    // threads start a new search for the highest count
+    atomicStore(&statisticsEpoch, epoch + 1);
+
+    QMutexLocker locker(&mutex);
+    ftime(&monitorTiming);
+    nbMonitorsPerSecond = (int) ((monitors - monitorsTotal)/diff);
+    monitorsTotal = monitors;
+    nbDisplayCountPerSecond = (int) ((displays - displaysTotal)/diff);
+    displaysTotal = displays;
+    for(int i=0; i < pluginMonitorsTotal.count(); i++) {
+        pluginMonitorsPerSecond[i] = (int) ((plugins[i] - pluginMonitorsTotal.at(i))/diff);
+        pluginMonitorsTotal[i] = plugins[i];
+    }
+    highestCountPerSecond = highestCount / (float) diff;
+    if(highestIndex >= 0) highestIndexPV = highestIndex;
+
+    classUpdatesPerSecond.clear();
+    classUpdateMsPerSecond.clear();
+    QHashIterator<const char *, updateCost> i(updateCosts);
+    while (i.hasNext()) {
+        i.next();
+        classUpdatesPerSecond.insert(i.key(), (int) (i.value().updates / diff));
+        classUpdateMsPerSecond.insert(i.key(), (float) (i.value().nsecs / 1.0e6 / diff));
+    }
+    locker.unlock();
+    updateCosts.clear();
+
+    // remember monitor count for all monitors, one stripe at a time
+    int size = GetMutexKnobDataSize();
+    for(int j=0; j < KNOBDATA_STRIPES; j++) {
+        QMutexLocker stripeLocker(&KnobStripes[j].mutex);
+        for(int i=j; i < size; i += KNOBDATA_STRIPES) {
+            knobData *kPtr = KnobDataAt(i);
+            if(kPtr->index != -1) kPtr->edata.monitorCountPrev = kPtr->edata.monitorCount;
+        }
     }
-    KnobDataArraySize=newsize;
-    return oldsize;
 }
 //*********************************************************************************************************************
 
@@ -356,7 +603,7 @@ int MutexKnobData::GetMutexKnobDataIndex()
  */
 int MutexKnobData::GetMutexKnobDataSize()
 {
-    return KnobDataArraySize;
+    return atomicLoad(&KnobDataArraySize);
 }
 //*********************************************************************************************************************
 
@@ -366,8 +613,20 @@ int MutexKnobData::GetMutexKnobDataSize()
 void MutexKnobData::SetMutexKnobData(int index, knobData data)
 {
     QMutexLocker locker(&mutex);
-    if (KnobData&&(index<KnobDataArraySize))
-        memcpy(&KnobData[index], &data, sizeof(knobData));
+    if ((index >= 0) && (index<KnobDataArraySize)) {
+        knobData *kPtr = KnobDataAt(index);
+        QMutexLocker stripeLocker(StripeMutex(index));
+        if(kPtr->index != data.index || strcmp(kPtr->pv, data.pv) != 0) UpdateKnobDataIndex(index, *kPtr, data);
+        if(data.index != -1 && (kPtr->index == -1 || strcmp(kPtr->pluginName, data.pluginName) != 0)) {
+            KnobSlotAt(index)->plugin = PluginId(data.pluginName);
+        }
+        // a released slot does not keep its array copy
+        if(data.index == -1) KnobSlotAt(index)->data = QByteArray();
+        BeginKnobWrite(index);
+        memcpy(kPtr, &data, sizeof(knobData));
+        EndKnobWrite(index);
+        UpdateKnobDataCounters(index);
+    }
 }
 
 extern "C" MutexKnobData* C_SetMutexKnobData(MutexKnobData* p, int index, knobData data)
@@ -382,33 +641,24 @@ extern "C" MutexKnobData* C_SetMutexKnobData(MutexKnobData* p, int index, knobDa
  */
 knobData* MutexKnobData::getMutexKnobDataPV(QWidget *widget, QString pv)
 {
-    int loop = 0;
+    int found = -1;
     QMutexLocker locker(&mutex);
-    while (loop < 2) {
-
-        for(int i=0; i < GetMutexKnobDataSize(); i++) {
-            knobData *kPtr = (knobData*) &KnobData[i];
-            if(kPtr->index != -1) {
-                QWidget *w = (QWidget *) kPtr->dispW;
-                QString kpv(kPtr->pv);
-
-                if(loop == 1) {
-                    if(kpv == pv) {
-                         //qDebug() << pv << "not exact match for" << widget;
-                        return kPtr;
-                    }
-
-                } else {
-                    if(kpv == pv && widget == w) {
-                        //qDebug() << pv << "exact match for" << widget;
-                        return kPtr;
-                    }
-                }
-            }
+    QHash<QString, QList<int> >::const_iterator it = KnobDataPVIndex.constFind(pv);
+    if(it == KnobDataPVIndex.constEnd()) return (knobData*) 0;
+
+    // exact match for the widget, otherwise the first knob with this pv
+    foreach(int i, it.value()) {
+        knobData *kPtr = KnobDataAt(i);
+        // slots released behind our back keep a stale entry
+        if(kPtr->index == -1 || pv != kPtr->pv) continue;
+        if(widget == (QWidget *) kPtr->dispW) {
+            //qDebug() << pv << "exact match for" << widget;
+            return kPtr;
         }
-    loop++;
+        if(found == -1 || i < found) found = i;
     }
-    return (knobData*) 0;
+    if(found == -1) return (knobData*) 0;
+    return KnobDataAt(found);
 }
 
 //*********************************************************************************************************************
@@ -418,8 +668,100 @@ knobData* MutexKnobData::getMutexKnobDataPV(QWidget *widget, QString pv)
  */
 knobData* MutexKnobData::GetMutexKnobDataPtr(int index)
 {
-    QMutexLocker locker(&mutex);
-    return (knobData*) &KnobData[index];
+    // chunks never move, no lock needed
+    return KnobDataAt(index);
+}
+
+/**
+ * writers of a knob make its sequence odd before and even again after the change,
+ * they have to hold the stripe lock of the knob
+ */
+void MutexKnobData::BeginKnobWrite(int index)
+{
+    atomicIncrementOrdered(&KnobSlotAt(index)->sequence);
+}
+
+void MutexKnobData::EndKnobWrite(int index)
+{
+    atomicIncrementOrdered(&KnobSlotAt(index)->sequence);
+}
+
+/**
+ * for writers that change a knob in place through GetMutexKnobDataPtr; the stripe lock is held
+ * in between, so nothing else of this class may be called before EndMutexKnobDataWrite
+ */
+void MutexKnobData::BeginMutexKnobDataWrite(int index)
+{
+    if(index < 0 || index >= GetMutexKnobDataSize()) return;
+    StripeMutex(index)->lock();
+    BeginKnobWrite(index);
+}
+
+void MutexKnobData::EndMutexKnobDataWrite(int index)
+{
+    if(index < 0 || index >= GetMutexKnobDataSize()) return;
+    EndKnobWrite(index);
+    UpdateKnobDataCounters(index);
+    StripeMutex(index)->unlock();
+}
+
+/**
+ * get a coherent copy of a knob without blocking the writers: the copy is retried until
+ * the sequence of the knob was even and unchanged around it. the array data are copied
+ * once per monitor under the data lock of the knob and then shared by all readers
+ */
+bool MutexKnobData::GetMutexKnobDataSnapshot(int index, knobSnapshot &snapshot, bool withData)
+{
+    if(index < 0 || index >= GetMutexKnobDataSize()) return false;
+
+    knobData *kPtr = KnobDataAt(index);
+    knobSlot *slot = KnobSlotAt(index);
+    bool coherent = false;
+
+    for(int retry = 0; retry < SNAPSHOT_RETRIES && !coherent; retry++) {
+        int sequence = atomicLoad(&slot->sequence);
+        if(sequence & 1) continue;
+        snapshot.index = kPtr->index;
+        memcpy(&snapshot.edata, &kPtr->edata, sizeof(epicsData));
+        coherent = (atomicLoadOrdered(&slot->sequence) == sequence);
+    }
+
+    // the knob is written all the time, wait for the writer
+    if(!coherent) {
+        QMutexLocker locker(StripeMutex(index));
+        snapshot.index = kPtr->index;
+        memcpy(&snapshot.edata, &kPtr->edata, sizeof(epicsData));
+    }
+    snapshot.edata.dataB = (void*) 0;
+    if(snapshot.index == -1) return false;
+
+    if(!withData) {
+        snapshot.data = QByteArray();
+        return true;
+    }
+
+    QMutexLocker locker(StripeMutex(index));
+    if(slot->data.isNull() || slot->dataMonitorCount != snapshot.edata.monitorCount) {
+        locker.unlock();
+        // the data lock is taken before the stripe lock, like the plugins do
+        QByteArray data;
+        int monitorCount = snapshot.edata.monitorCount;
+        if(kPtr->mutex != (void*) 0) {
+            DataLock(kPtr);
+            if(kPtr->edata.dataB != (void*) 0 && kPtr->edata.dataSize > 0) {
+                data = QByteArray((const char *) kPtr->edata.dataB, kPtr->edata.dataSize);
+            }
+            monitorCount = kPtr->edata.monitorCount;
+            locker.relock();
+            DataUnlock(kPtr);
+        } else {
+            locker.relock();
+        }
+        slot->data = data;
+        slot->dataMonitorCount = monitorCount;
+    }
+    snapshot.data = slot->data;
+    return true;
 }
 //*********************************************************************************************************************
 
@@ -453,44 +795,32 @@ void MutexKnobData::SetMutexKnobDataReceived(knobData *kData) {
     char units[40];
     char fec[40];
     char dataString[STRING_EXCHANGE_SIZE];
-    double diff;
     struct timeb now;
-    QMutexLocker locker(&mutex);
     int index = kData->index;
-    memcpy(&KnobData[index].edata, &kData->edata, sizeof(epicsData));
+    QMutexLocker locker(StripeMutex(index));
+    BeginKnobWrite(index);
+    memcpy(&KnobDataAt(index)->edata, &kData->edata, sizeof(epicsData));
+    EndKnobWrite(index);
+    UpdateKnobDataCounters(index);
 
     /*****************************************************************************************/
-    // Statistics
+    // Statistics, counted per thread and summed up by the timer
     /*****************************************************************************************/
 
-    nbMonitors++;
+    threadCounters *counters = ThreadCounters();
+    atomicIncrement(&counters->monitors);
+    int plugin = KnobSlotAt(index)->plugin;
+    if(plugin >= 0) atomicIncrement(&counters->pluginMonitors[plugin]);
 
     // find monitor with highest count since last time
-    if((kData->edata.monitorCount-kData->edata.monitorCountPrev) > highestCount) {
-        highestCount = kData->edata.monitorCount -kData->edata.monitorCountPrev ;
-        highestIndex = index;
+    int epoch = atomicLoad(&statisticsEpoch);
+    if(counters->epoch != epoch) {
+        atomicStore(&counters->highestCount, 0);
+        atomicStore(&counters->epoch, epoch);
     }
-
-    // calculate after 5 seconds our statistics
-    ftime(&now);
-    diff = ((double) now.time + (double) now.millitm / (double)1000) -
-            ((double) monitorTiming.time + (double) monitorTiming.millitm / (double)1000);
-
-    if(diff >= 5.0) {
-        ftime(&monitorTiming);
-        nbMonitorsPerSecond = (int) (nbMonitors/diff);
-        nbMonitors = 0;
-        // remember monitor count for all monitors
-        for(int i=0; i < GetMutexKnobDataSize(); i++) {
-            knobData *kPtr = (knobData*) &KnobData[i];
-            if(kPtr->index != -1) kPtr->edata.monitorCountPrev = kPtr->edata.monitorCount;
-        }
-
-        highestCountPerSecond = highestCount / (float) diff;
-        highestIndexPV = highestIndex;
-        highestCount = 0;
-        nbDisplayCountPerSecond =  (int) (displayCount/diff);
-        displayCount = 0;
+    if((kData->edata.monitorCount-kData->edata.monitorCountPrev) > counters->highestCount) {
+        atomicStore(&counters->highestIndex, index);
+        atomicStore(&counters->highestCount, kData->edata.monitorCount - kData->edata.monitorCountPrev);
     }
 
     /*****************************************************************************************/
@@ -515,11 +845,14 @@ void MutexKnobData::SetMutexKnobDataReceived(knobData *kData) {
         }
 
         kData->edata.displayCount = kData->edata.monitorCount;
+        UpdateKnobDataCounters(index);
+        QString unitsString = KnobUnits(index, units);
         locker.unlock();
-        UpdateWidget(index, dispW, units, fec, dataString, KnobData[index]);
+        UpdateWidget(index, dispW, unitsString, fec, dataString, *KnobDataAt(index));
+        ftime(&now);
         kData->edata.lastTime = now;
         kData->edata.initialize = false;
-        displayCount++;
+        atomicIncrement(&counters->displays);
     }
 }
 
@@ -539,8 +872,8 @@ float MutexKnobData::getHighestCountPV(QString &pv)
 {
     QMutexLocker locker(&mutex);
 
-    if(KnobData[highestIndexPV].index != -1) {
-        pv = KnobData[highestIndexPV].pv;
+    if(KnobDataAt(highestIndexPV)->index != -1) {
+        pv = KnobDataAt(highestIndexPV)->pv;
         return highestCountPerSecond;
     } else {
         return 0.0;
@@ -551,7 +884,53 @@ void MutexKnobData::initHighestCountPV()
 {
     QMutexLocker locker(&mutex);
     ftime(&monitorTiming);
-    highestCount = 0;
+    // threads start a new search for the highest count
+    atomicStore(&statisticsEpoch, atomicLoad(&statisticsEpoch) + 1);
+}
+
+/**
+ * get all statistics at once, the counters are kept up to date per stripe when knobs change,
+ * so no scan over the knobs is needed here
+ */
+void MutexKnobData::getStatistics(knobStatistics &statistics)
+{
+    statistics.countPV = statistics.countNotConnected = statistics.countDisplayed = 0;
+    for(int i=0; i < KNOBDATA_STRIPES; i++) {
+        QMutexLocker stripeLocker(&KnobStripes[i].mutex);
+        statistics.countPV += KnobStripes[i].countPV;
+        statistics.countNotConnected += KnobStripes[i].countNotConnected;
+        statistics.countDisplayed += KnobStripes[i].countDisplayed;
+    }
+
+    QMutexLocker locker(&mutex);
+    statistics.monitorsPerSecond = nbMonitorsPerSecond;
+    statistics.displaysPerSecond = nbDisplayCountPerSecond;
+
+    if(KnobDataAt(highestIndexPV)->index != -1) {
+        statistics.highestPV = KnobDataAt(highestIndexPV)->pv;
+        statistics.highestCountPerSecond = highestCountPerSecond;
+    } else {
+        statistics.highestPV.clear();
+        statistics.highestCountPerSecond = 0.0;
+    }
+
+    statistics.pluginMonitorsPerSecond.clear();
+    for(int i=0; i < pluginNames.count(); i++) {
+        statistics.pluginMonitorsPerSecond.insert(pluginNames.at(i), pluginMonitorsPerSecond.at(i));
+    }
+    statistics.classUpdatesPerSecond = classUpdatesPerSecond;
+    statistics.classUpdateMsPerSecond = classUpdateMsPerSecond;
+}
+
+/**
+ * time spent by a display to update a widget of the given class; only called from the gui thread,
+ * which also collects the costs in UpdateStatistics, so the monitor threads are never blocked by it
+ */
+void MutexKnobData::AddUpdateCost(const char *className, qint64 nsecs)
+{
+    updateCost &cost = updateCosts[className];
+    cost.updates++;
+    cost.nsecs += nsecs;
 }
 
 extern "C" MutexKnobData* C_SetMutexKnobDataReceived(MutexKnobData* p, knobData *kData)
@@ -573,13 +952,15 @@ void MutexKnobData::timerEvent(QTimerEvent *)
     struct timeb now;
     int repetitionRate = DEFAULTRATE;
 
+    UpdateStatistics();
+
     if(blockProcess) return;
 
     ftime(&now);
 
     // do we have something that should go faster then 5 Hz, then change timer, but change back when nothing fast requested
     for(int i=0; i < GetMutexKnobDataSize(); i++) {
-        knobData *kPtr = (knobData*) &KnobData[i];
+        knobData *kPtr = KnobDataAt(i);
         if(kPtr->index != -1) {
           if(kPtr->edata.repRate > repetitionRate) repetitionRate = kPtr->edata.repRate;
           if(repetitionRate > 50) repetitionRate = 50;  // not more than 50Hz
@@ -595,7 +976,7 @@ void MutexKnobData::timerEvent(QTimerEvent *)
     //int number = 0;
     //qDebug() << "============================================";
     for(int i=0; i < GetMutexKnobDataSize(); i++) {
-        knobData *kPtr = (knobData*) &KnobData[i];
+        knobData *kPtr = KnobDataAt(i);
 
         if(kPtr->index != -1) {
             diff = ((double) now.time + (double) now.millitm / (double)1000) -
@@ -628,7 +1009,9 @@ void MutexKnobData::timerEvent(QTimerEvent *)
 
                 if(treatit) {
                     // get value from (updated) QMap variable list
-                    knobData *ptr = (knobData*) &KnobData[indx];
+                    knobData *ptr = KnobDataAt(indx);
+                    QMutexLocker locker(StripeMutex(i));
+                    BeginKnobWrite(i);
                     kPtr->edata.fieldtype = caDOUBLE;
                     kPtr->edata.accessW = true;
                     kPtr->edata.accessR = true;
@@ -663,6 +1046,9 @@ void MutexKnobData::timerEvent(QTimerEvent *)
 
                     if(update) kPtr->edata.monitorCount++;
                     kPtr->edata.oldsoftvalue = ptr->edata.rvalue;
+                    EndKnobWrite(i);
+                    UpdateKnobDataCounters(i);
+                    locker.unlock();
                     QWidget *ww = (QWidget *)kPtr->dispW;
                     if (caTextEntry *widget = qobject_cast<caTextEntry *>(ww)) {
                         widget->setAccessW((bool) kPtr->edata.accessW);
@@ -679,7 +1065,7 @@ void MutexKnobData::timerEvent(QTimerEvent *)
                                                                       kPtr->edata.dataSize, kPtr->edata.valueCount);
 */
             if((myUpdateType == UpdateTimed) || kPtr->soft) {
-                QMutexLocker locker(&mutex);
+                QMutexLocker locker(StripeMutex(i));
                 int index = kPtr->index;
                 QWidget *dispW = (QWidget*) kPtr->dispW;
                 dataString[0] = '\0';
@@ -698,16 +1084,18 @@ void MutexKnobData::timerEvent(QTimerEvent *)
                 }
 
                 kPtr->edata.displayCount = kPtr->edata.monitorCount;
+                UpdateKnobDataCounters(i);
+                QString unitsString = KnobUnits(i, units);
                 locker.unlock();
-                UpdateWidget(index, dispW, units, fec, dataString, KnobData[index]);
+                UpdateWidget(index, dispW, unitsString, fec, dataString, *KnobDataAt(index));
                 kPtr->edata.lastTime = now;
                 kPtr->edata.initialize = false;
-                displayCount++;
+                atomicIncrement(&ThreadCounters()->displays);
             }
 
         } else if ((kPtr->index != -1)  && (diff >= (1.0/(double)repRate))) {
             if( (!kPtr->edata.connected)) {
-                QMutexLocker locker(&mutex);
+                QMutexLocker locker(StripeMutex(i));
                 bool displayIt = false;
                 units[0] = '\0';
                 fec[0] = '\0';
@@ -717,12 +1105,13 @@ void MutexKnobData::timerEvent(QTimerEvent *)
                 if(kPtr->edata.unconnectCount == 0) {
                     kPtr->edata.displayCount = kPtr->edata.monitorCount;
                     kPtr->edata.lastTime = now;
+                    UpdateKnobDataCounters(i);
                     displayIt = true;
                 }
                 kPtr->edata.unconnectCount++;
                 if(kPtr->edata.unconnectCount == 10) kPtr->edata.unconnectCount=0;
                 locker.unlock();
-                if(displayIt) UpdateWidget(index, (QWidget*) kPtr->dispW, units, fec, dataString, KnobData[index]);
+                if(displayIt) UpdateWidget(index, (QWidget*) kPtr->dispW, QString::fromLatin1(units), fec, dataString, *KnobDataAt(index));
             }
         }
     }
@@ -735,19 +1124,22 @@ void MutexKnobData::timerEvent(QTimerEvent *)
  */
 void MutexKnobData::SetMutexKnobDataConnected(int index, int connected)
 {
-    QMutexLocker locker(&mutex);
+    QMutexLocker locker(StripeMutex(index));
 
-    if( KnobData[index].index == -1) return;
+    if( KnobDataAt(index)->index == -1) return;
 
-    KnobData[index].edata.connected = connected;
+    BeginKnobWrite(index);
+    KnobDataAt(index)->edata.connected = connected;
+    EndKnobWrite(index);
+    UpdateKnobDataCounters(index);
 
 #ifdef epics4
-    connectInfoShort *tmp = (connectInfoShort *) KnobData[index].edata.info;
+    connectInfoShort *tmp = (connectInfoShort *) KnobDataAt(index)->edata.info;
     if (tmp != (connectInfoShort *) 0) tmp->connected = connected;
 #endif
 
     if(!connected) {
-        UpdateWidget(index, (QWidget*)KnobData[index].dispW, (char*) " ", (char*) " ",  (char*) " ", KnobData[index]);
+        UpdateWidget(index, (QWidget*)KnobDataAt(index)->dispW, QString::fromLatin1(" "), (char*) " ",  (char*) " ", *KnobDataAt(index));
     }
 
 }
@@ -772,66 +1164,88 @@ QString getBufferAsHexStr(char* buf, int buffsize) {
 
 
 
-void MutexKnobData::UpdateWidget(int index, QWidget* w, char *units, char *fec, char *dataString, knobData knb)
+/**
+ * units of a channel with the special characters coming from epics replaced
+ */
+QString MutexKnobData::NormalizeUnits(const char *units)
 {
     QString StringUnits = QString::fromLatin1(units);
-    if(StringUnits.size() > 0) {
-        // special characters handling (should be done in constructor to save time; however
-        // then we will have somme application using caQtFM_Lib that will crash
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-        static const QChar egrad = 0x00b0;              // º coming from epics
-        QString Egrad(egrad);
-        static const QChar grad = 0x00b0;   // will be replaced by this utf-8 code
-        QString Grad(grad);
+    static const QChar egrad = 0x00b0;              // º coming from epics
+    QString Egrad(egrad);
+    static const QChar grad = 0x00b0;   // will be replaced by this utf-8 code
+    QString Grad(grad);
 #else
-        static const QChar egrad = 0x00b0;              // º coming from epics
-        QString Egrad(egrad);
-        //QString Grad=QString::fromLatin1("º");
-        //QString Grad=QString::fromUtf8("\xc2\xb0");
-        static const QChar grad[2] = { 0x00c2, 0x00ba};   // will be replaced by this utf-8 code
-        QString Grad(grad, 2);
+    static const QChar egrad = 0x00b0;              // º coming from epics
+    QString Egrad(egrad);
+    //QString Grad=QString::fromLatin1("º");
+    //QString Grad=QString::fromUtf8("\xc2\xb0");
+    static const QChar grad[2] = { 0x00c2, 0x00ba};   // will be replaced by this utf-8 code
+    QString Grad(grad, 2);
 
 #endif
 
-        static const QChar emu =  0x00b5;               // mu coming from epics
-        QString Emu(emu);
+    static const QChar emu =  0x00b5;               // mu coming from epics
+    QString Emu(emu);
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-        static const QChar mu =  0x00b5;
-        QString Mu(mu);
-        static const QChar uA[2] = { 0x00b5, 0x0041};
-        static const QChar uJ[2] = { 0x00b5, 0x004A};
-        QString uAs(uA, 2);
-        QString uJs(uJ, 2);
+    static const QChar mu =  0x00b5;
+    QString Mu(mu);
+    static const QChar uA[2] = { 0x00b5, 0x0041};
+    static const QChar uJ[2] = { 0x00b5, 0x004A};
+    QString uAs(uA, 2);
+    QString uJs(uJ, 2);
 #else
-        static const QChar mu[2] = { 0x00ce, 0x00bc};
-        QString Mu(mu, 2);
-        static const QChar uA[3] = { 0x00ce, 0x00bc, 0x0041}; // muA code for replacing ?A coming from epics
-        static const QChar uJ[3] = { 0x00ce, 0x00bc, 0x004A}; // muA code for replacing ?J coming from epics
-        QString uAs(uA, 3);
-        QString uJs(uJ, 3);
+    static const QChar mu[2] = { 0x00ce, 0x00bc};
+    QString Mu(mu, 2);
+    static const QChar uA[3] = { 0x00ce, 0x00bc, 0x0041}; // muA code for replacing ?A coming from epics
+    static const QChar uJ[3] = { 0x00ce, 0x00bc, 0x004A}; // muA code for replacing ?J coming from epics
+    QString uAs(uA, 3);
+    QString uJs(uJ, 3);
 #endif
 
-        // replace special characters
-        StringUnits.replace(Egrad, Grad);
-        StringUnits.replace(Emu, Mu);
-        //printf("Units(string): %s(%s)\n",StringUnits.toUtf8().data(),units);
-        //printf("Units(hex): %s\n",getBufferAsHexStr(units,strlen(units)).toLatin1().data());
-
-        // seems people did not know how to code mu in EGU
-        StringUnits.replace("muA", uAs);
-        StringUnits.replace("uA", uAs);
-        StringUnits.replace("?A", uAs);
-        StringUnits.replace("muJ", uJs);
-        StringUnits.replace("?J", uJs);
-        StringUnits.replace("uJ", uJs);
-
-        // neither grad
-        static const QChar spec =  0x00c2;
-        QString special(spec);
-        if(StringUnits.contains("°C")) StringUnits.replace(special, "");
-    }
+    // replace special characters
+    StringUnits.replace(Egrad, Grad);
+    StringUnits.replace(Emu, Mu);
+    //printf("Units(string): %s(%s)\n",StringUnits.toUtf8().data(),units);
+    //printf("Units(hex): %s\n",getBufferAsHexStr(units,strlen(units)).toLatin1().data());
+
+    // seems people did not know how to code mu in EGU
+    StringUnits.replace("muA", uAs);
+    StringUnits.replace("uA", uAs);
+    StringUnits.replace("?A", uAs);
+    StringUnits.replace("muJ", uJs);
+    StringUnits.replace("?J", uJs);
+    StringUnits.replace("uJ", uJs);
+
+    // neither grad
+    static const QChar spec =  0x00c2;
+    QString special(spec);
+    if(StringUnits.contains("°C")) StringUnits.replace(special, "");
+    return StringUnits;
+}
+
+/**
+ * the normalized units are kept with the knob and normalized again only when they change;
+ * must be called with the stripe lock of the knob held
+ */
+QString MutexKnobData::KnobUnits(int index, const char *units)
+{
+    if(units[0] == '\0') return QString::fromLatin1(units);
+
+    knobSlot *slot = KnobSlotAt(index);
+    if(slot->rawUnits == units) return slot->units;
+    slot->rawUnits = QByteArray(units);
+    slot->units = NormalizeUnits(units);
+    return slot->units;
+}
+
+void MutexKnobData::UpdateWidget(int index, QWidget* w, const QString &units, char *fec, char *dataString, const knobData &knb)
+{
+    // the knob is copied once and shared by all displays the update is queued to
+    knobUpdate update(new knobData(knb));
+
     // send data to main thread
-    emit Signal_UpdateWidget(index, w, StringUnits, fec, dataString, knb);
+    emit Signal_UpdateWidget(index, w, units, fec, dataString, update);
 }
 //*********************************************************************************************************************
 
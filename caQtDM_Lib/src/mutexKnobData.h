@@ -35,12 +35,60 @@
 #include <QObject>
 #include <QVector>
 #include <QMap>
+#include <QHash>
+#include <QList>
+#include <QStringList>
 #include <QWaitCondition>
+#include <QThreadStorage>
+#include <QByteArray>
+#include <QSharedPointer>
 #include "knobData.h"
 #include "mutexKnobDataWrapper.h"
 
 #define DEFAULTRATE 10
 
+// number of knobs allocated at once
+#define KNOBDATA_CHUNK 512
+
+// chunks are never moved, this limits the number of knobs
+#define KNOBDATA_MAXCHUNKS 2048
+
+// knobs share these locks, knob i uses lock i % KNOBDATA_STRIPES
+#define KNOBDATA_STRIPES 64
+
+// number of plugins with their own monitor statistics
+#define KNOBDATA_MAXPLUGINS 32
+
+/**
+ * statistics of all knobs, taken at once under the lock
+ */
+typedef struct _knobStatistics {
+    int countPV;                                 /* knobs in use */
+    int countNotConnected;                       /* knobs in use and not connected */
+    int countDisplayed;                          /* connected knobs displayed at least once */
+    int monitorsPerSecond;
+    int displaysPerSecond;
+    float highestCountPerSecond;
+    QString highestPV;
+    QMap<QString, int> pluginMonitorsPerSecond;  /* monitors per second for each plugin */
+    QMap<QString, int> classUpdatesPerSecond;    /* widget updates per second for each widget class */
+    QMap<QString, float> classUpdateMsPerSecond; /* milliseconds per second spent updating each widget class */
+} knobStatistics;
+
+/**
+ * coherent copy of a knob for readers in the gui thread
+ */
+typedef struct _knobSnapshot {
+    int index;
+    epicsData edata;                             /* copy of the scalar data, edata.dataB is not valid */
+    QByteArray data;                             /* shared copy of the array data when requested */
+} knobSnapshot;
+
+/**
+ * copy of a knob as it was when an update was emitted, shared by all receivers of the update
+ */
+typedef QSharedPointer<const knobData> knobUpdate;
+
 class CAQTDM_LIBSHARED_EXPORT MutexKnobData: public QObject {
     Q_OBJECT
 
@@ -59,6 +107,11 @@ public:
 
     knobData GetMutexKnobData(int indx);
     knobData *GetMutexKnobDataPtr(int indx);
+    bool GetMutexKnobDataSnapshot(int indx, knobSnapshot &snapshot, bool withData = false);
+    // a knob changed in place through its pointer is only seen coherent by the snapshot
+    // when the change is enclosed in these
+    void BeginMutexKnobDataWrite(int indx);
+    void EndMutexKnobDataWrite(int indx);
     void SetMutexKnobData(int indx, knobData data);
     int GetMutexKnobDataIndex();
     int GetMutexKnobDataSize();
@@ -69,7 +122,7 @@ public:
 
     void SetMutexKnobDataConnected(int indx, int connected);
 
-    void UpdateWidget(int indx, QWidget* w,  char* units, char* fec, char* statusString, knobData knb);
+    void UpdateWidget(int indx, QWidget* w, const QString &units, char* fec, char* statusString, const knobData &knb);
     void UpdateTextLine(char *message, char *name);
 
     void InsertSoftPV(QString pv, int num, QWidget* w);
@@ -82,6 +135,8 @@ public:
     int getDisplaysPerSecond();
     float getHighestCountPV(QString &pv);
     void initHighestCountPV();
+    void getStatistics(knobStatistics &statistics);
+    void AddUpdateCost(const char *className, qint64 nsecs);
 
     void UpdateMechanism(UpdateType Type);
     QString SoftPV_Name(QString pv, QWidget *w);
@@ -89,7 +144,7 @@ public:
 
 signals:
 
-    void Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, const knobData&);
+    void Signal_UpdateWidget(int, QWidget*, const QString&, const QString&, const QString&, const knobUpdate&);
     void Signal_QLineEdit(const QString&, const QString&);
 
 private:
@@ -100,19 +155,97 @@ private:
        QWidget *w;
     } softlist;
 
+    // state of a slot as it was last counted
+    enum {KnobUsed = 0x01, KnobConnected = 0x02, KnobDisplayed = 0x04};
+    typedef struct _knobSlot {
+        char state;
+        short plugin;
+        int sequence;                 // odd while the knob is being written
+        int dataMonitorCount;         // monitor the shared array copy belongs to
+        QByteArray data;              // shared array copy for snapshots
+        QByteArray rawUnits;          // units as received
+        QString units;                // and normalized
+    } knobSlot;
+
+    // lock and counters for the knobs of one stripe
+    typedef struct _knobStripe {
+        QMutex mutex;
+        int countPV, countNotConnected, countDisplayed;
+    } knobStripe;
+
+    // statistics of one thread, only written by that thread and summed up by the timer
+    typedef struct _threadCounters {
+        int inUse;
+        int monitors;
+        int displays;
+        int epoch;
+        int highestCount;
+        int highestIndex;
+        int pluginMonitors[KNOBDATA_MAXPLUGINS];
+    } threadCounters;
+
+    // gives the counters of a thread free for reuse when the thread ends
+    struct threadCountersHandle {
+        threadCountersHandle(threadCounters *c) : counters(c) {}
+        ~threadCountersHandle();
+        threadCounters *counters;
+    };
+
+    // protects the free list, the pv index, the soft pv lists and the statistics results
     QMutex mutex;
-    knobData *KnobData;
+    knobData *KnobDataChunks[KNOBDATA_MAXCHUNKS];
+    knobSlot *KnobSlotChunks[KNOBDATA_MAXCHUNKS];
+    int KnobDataChunkCount;
     int KnobDataArraySize;
+    knobStripe KnobStripes[KNOBDATA_STRIPES];
+    QVector<int> KnobDataFree;
+    QVector<bool> KnobDataInFree;
+    QHash<QString, QList<int> > KnobDataPVIndex;
+
+    knobData *KnobDataAt(int indx) { return &KnobDataChunks[indx / KNOBDATA_CHUNK][indx % KNOBDATA_CHUNK]; }
+    knobSlot *KnobSlotAt(int indx) { return &KnobSlotChunks[indx / KNOBDATA_CHUNK][indx % KNOBDATA_CHUNK]; }
+    QMutex *StripeMutex(int indx) { return &KnobStripes[indx % KNOBDATA_STRIPES].mutex; }
+    void AddKnobDataChunk();
+    void UpdateKnobDataIndex(int index, const knobData &oldData, const knobData &newData);
+    void UpdateKnobDataCounters(int index);
+    void BeginKnobWrite(int index);
+    void EndKnobWrite(int index);
+    int PluginId(const char *pluginName);
+    static QString NormalizeUnits(const char *units);
+    QString KnobUnits(int index, const char *units);
+    threadCounters *ThreadCounters();
+    void UpdateStatistics();
+
+    QHash<QString, int> pluginIds;
+    QStringList pluginNames;
+    QVector<int> pluginMonitorsPerSecond;
+    QVector<uint> pluginMonitorsTotal;
+
+    // cost of the widget updates, keyed by the class name of the meta object; gui thread only
+    typedef struct _updateCost {
+        int updates;
+        qint64 nsecs;
+    } updateCost;
+    QHash<const char *, updateCost> updateCosts;
+
+    QMap<QString, int> classUpdatesPerSecond;
+    QMap<QString, float> classUpdateMsPerSecond;
+
+    QMutex countersMutex;
+    QList<threadCounters*> threadCountersList;
+    QThreadStorage<threadCountersHandle*> threadCountersStorage;
+    int statisticsEpoch;
+    uint monitorsTotal, displaysTotal;
     int timerId, prvRepetitionRate;
     QMap<QString, int> softPV_WidgetList;
     QMap<QString, softlist> softPV_List;
 
-    int nbMonitorsPerSecond, nbMonitors;
-    int highestCount, highestIndex, highestIndexPV;
+    int nbMonitorsPerSecond;
+    int highestIndexPV;
     float highestCountPerSecond;
     struct timeb monitorTiming;
 
-    int nbDisplayCountPerSecond, displayCount;
+    int nbDisplayCountPerSecond;
     struct timeb last;
 
     bool blockProcess;
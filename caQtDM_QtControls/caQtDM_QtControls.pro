@@ -114,6 +114,8 @@ SOURCES	+= \
     src/caspinbox.cpp \
     src/qwtplotcurvenan.cpp \
     src/cawavetable.cpp \
+    src/valueformatter.cpp \
+    src/imageframecache.cpp \
     src/specialFunctions.cpp \
     src/caclock.cpp \
     src/cameter.cpp \
@@ -143,11 +145,11 @@ XDR_HACK {
 }
 
 QT += network
-HEADERS += src/networkaccess.h src/fileFunctions.h \
+HEADERS += src/networkaccess.h src/networkprefetch.h src/fileFunctions.h \
     src/calinedraw.h \
     src/wmsignalpropagator.h \
     src/replacemacro.h
-SOURCES += src/networkaccess.cpp src/fileFunctions.cpp
+SOURCES += src/networkaccess.cpp src/networkprefetch.cpp src/fileFunctions.cpp
 
 contains(QWT_VER_MIN, 0) {
    HEADERS	+= src/qwt_thermo_marker.h
@@ -216,6 +218,8 @@ HEADERS	+= \
     src/caspinbox.h \
     src/qwtplotcurvenan.h \
     src/cawavetable.h \
+    src/valueformatter.h \
+    src/imageframecache.h \
     src/capolylinedialog.h \
     src/specialFunctions.h \
     src/caclock.h \
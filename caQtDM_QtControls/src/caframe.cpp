@@ -54,4 +54,19 @@ void caFrame::setBackground(QColor c)
     update();
 }
 
+/**
+ * colors only the border with the summary alarm, an invalid color gives back the normal border
+ */
+void caFrame::setAlarmColor(QColor c)
+{
+    QColor border = c.isValid() ? c : thisBackColor;
+
+    QPalette thisPalette = palette();
+    thisPalette.setColor(QPalette::WindowText, border);
+    thisPalette.setColor(QPalette::Light, border.lighter());
+    thisPalette.setColor(QPalette::Dark, border.darker());
+    setPalette(thisPalette);
+    update();
+}
+
 
@@ -97,6 +97,7 @@ public:
     void setMacro(QString const &newMacro) {thisMacro = newMacro;}
     void setBackground(QColor c);
     QColor getBackground() const {return thisBackColor;}
+    void setAlarmColor(QColor c);
 
 public slots:
     void animation(QRect p) {
@@ -25,6 +25,7 @@
 
 #include <QPaintEvent>
 #include <QPainter>
+#include <QPixmapCache>
 #include <QDebug>
 #include "alarmdefs.h"
 
@@ -328,19 +329,27 @@ QPolygonF caGraphics::drawCircle(int x1, int x2, int y1, int y2) {
 void caGraphics::setHide(bool hide)
 {
     thisHide = hide;
-    repaint();
+    update();
+}
+
+/**
+ * key describing everything that goes into the rendered shape; widgets with the same
+ * geometry, colors and styles share one cached pixmap
+ */
+QString caGraphics::pixmapKey(qreal ratio)
+{
+    return QString("caGraphics_%1_%2x%3_%4_%5_%6_%7_%8_%9_%10_%11_%12_%13_%14")
+            .arg(thisForm).arg(width()).arg(height()).arg(thisLineSize).arg(thisLineStyle).arg(thisFillStyle)
+            .arg(thisLineColor.rgba()).arg(thisForeColor.rgba())
+            .arg(thisTiltAngle).arg(thisStartAngle).arg(thisSpanAngle)
+            .arg(thisArrowSize).arg(thisArrowMode).arg(ratio);
 }
 
 void caGraphics::paintEvent( QPaintEvent *event )
 {
     Q_UNUSED(event);
 
-    if(thisHide) return;
-
-    int m_margin = 3;
-    QPointF p1,p2;
-    QPainter painter( this );
-    painter.setRenderHint( QPainter::Antialiasing );
+    if(thisHide || width() <= 0 || height() <= 0) return;
 
     int margin = thisLineSize/2;
     int w = width() - 2 * margin;
@@ -350,9 +359,40 @@ void caGraphics::paintEvent( QPaintEvent *event )
     if(w <= 0 || h <= 0) {
         setLineSize(thisLineSize-1);
     }
-    margin = thisLineSize/2;
-    w = width() - 2 * margin;
-    h = height() - 2 * margin;
+
+    // static shapes are rendered once into a pixmap and then only blitted
+#if QT_VERSION >= 0x050600
+    qreal ratio = devicePixelRatioF();
+#else
+    qreal ratio = 1.0;
+#endif
+    QString key = pixmapKey(ratio);
+    QPixmap pixmap;
+    if(!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap(qRound(width() * ratio), qRound(height() * ratio));
+#if QT_VERSION >= 0x050600
+        pixmap.setDevicePixelRatio(ratio);
+#endif
+        pixmap.fill(Qt::transparent);
+        QPainter pixmapPainter(&pixmap);
+        drawShape(pixmapPainter);
+        pixmapPainter.end();
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    QPainter painter( this );
+    painter.drawPixmap(0, 0, pixmap);
+}
+
+void caGraphics::drawShape(QPainter &painter)
+{
+    int m_margin = 3;
+    QPointF p1,p2;
+    painter.setRenderHint( QPainter::Antialiasing );
+
+    int margin = thisLineSize/2;
+    int w = width() - 2 * margin;
+    int h = height() - 2 * margin;
     int x = margin;
     int y = margin;
 
@@ -27,6 +27,7 @@
 #define CAGRAPHICS_H
 
 #include <QWidget>
+#include <QPainter>
 #include <QDebug>
 #include <qtcontrols_global.h>
 
@@ -168,6 +169,8 @@ private:
     int thisStartAngle, thisSpanAngle, thisTiltAngle;
 
     QPolygonF drawCircle(int x1, int x2, int y1, int y2);
+    void drawShape(QPainter &painter);
+    QString pixmapKey(qreal ratio);
     QPolygonF rotateObject(int degrees, int w, int h, int linesize, const QPolygonF& object);
 
     bool thisHide;
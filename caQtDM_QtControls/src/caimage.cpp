@@ -26,6 +26,7 @@
 #include "caimage.h"
 #include "searchfile.h"
 #include "fileFunctions.h"
+#include "imageframecache.h"
 
 caImage::caImage(QWidget* parent) : QWidget(parent)
 {
@@ -33,14 +34,14 @@ caImage::caImage(QWidget* parent) : QWidget(parent)
     _container = new QLabel(this);
     _layout = new QVBoxLayout(this);
     thisFrame = prevFrame = 0;
+    thisFrameCount = 0;
+    thisInvalid = false;
     setVisibility(StaticV);
-    timerId = 0;
     thisDelay = 500;
 }
 
 caImage::~caImage() {
 
-   delete _animation;
    delete messagequeue;
 }
 
@@ -78,14 +79,15 @@ void caImage::init(const QString& filename) {
         return;
     }
 
-    _animation = new QMovie(fileNameFound, 0, this);
-    _animation->setCacheMode(QMovie::CacheAll);
-    _animation->jumpToFrame(0);
+    // the frames are decoded once for all images showing the same file
+    thisImageFile = fileNameFound;
+    thisFrameCount = ImageFrameCache::frameCount(thisImageFile);
     delete s;
-    if( _animation.isNull()) return;
-    // display the movie
+    if(thisFrameCount == 0) return;
+    // display the first frame
     _container->setScaledContents(true);
-    _container->setMovie(_animation);
+    prevFrame = 0;
+    showFrame(0);
 
     _layout->setSpacing(0);
     _layout->setMargin(0);
@@ -97,19 +99,34 @@ void caImage::init(const QString& filename) {
 
 int caImage::getFrameCount()
 {
-    if( _animation.isNull()) return 0;
-    return _animation->frameCount();
+    return thisFrameCount;
 }
 
-void caImage::timerEvent(QTimerEvent *)
+/**
+ * the shared frame in the size of this widget
+ */
+void caImage::showFrame(int frame)
+{
+    if(thisFrameCount == 0 || thisInvalid) return;
+    if(frame < 0 || frame >= thisFrameCount) return;
+    _container->setPixmap(ImageFrameCache::frame(thisImageFile, frame, size()));
+}
+
+void caImage::resizeEvent(QResizeEvent *e)
 {
-    if( _animation.isNull()) return;
-    if(thisFrame > (_animation->frameCount()-1)) {
+    QWidget::resizeEvent(e);
+    showFrame(prevFrame);
+}
+
+void caImage::nextFrame()
+{
+    if(thisFrameCount == 0) return;
+    if(thisFrame > (thisFrameCount-1)) {
         thisFrame=0;
     }
     // display only when frame changed
     if(thisFrame != prevFrame) {
-      (void)_animation->jumpToFrame(thisFrame);
+      showFrame(thisFrame);
       prevFrame = thisFrame;
     }
     thisFrame++;
@@ -117,10 +134,14 @@ void caImage::timerEvent(QTimerEvent *)
 
 void caImage::startMovie()
 {
-    // kill default timer
-    if(timerId != 0) killTimer(timerId);
-    //start timer, but 0 milliseconds means no timer
-    if(thisDelay > 0) timerId = startTimer(thisDelay);
+    // leave the previous clock
+    if(!thisClock.isNull()) disconnect(thisClock, SIGNAL(timeout()), this, SLOT(nextFrame()));
+    thisClock = (QTimer *) 0;
+    // all images with the same delay step with the same clock, but 0 milliseconds means no clock
+    if(thisDelay > 0) {
+        thisClock = ImageFrameCache::animationClock(thisDelay);
+        connect(thisClock, SIGNAL(timeout()), this, SLOT(nextFrame()));
+    }
 }
 
 void caImage::setInvalid(QColor c)
@@ -129,7 +150,8 @@ void caImage::setInvalid(QColor c)
       QString style = "color: rgb(%1, %2, %3); background-color: rgb(%4, %5, %6);";
       style = style.arg(c.red()).arg(c.green()).arg(c.blue()).arg(c.red()).arg(c.green()).arg(c.blue());
       _container->setStyleSheet(style);
-      _container->setMovie(NULL);
+      _container->clear();
+      thisInvalid = true;
       oldColor = c;
     }
 }
@@ -138,7 +160,8 @@ void caImage::setValid()
 {
     QColor c;
     if(oldColor == Qt::gray) return;
-    _container->setMovie(_animation);
+    thisInvalid = false;
+    showFrame(prevFrame);
     c = oldColor = Qt::gray;
     QString style = "color: rgb(%1, %2, %3); background-color: rgba(%4, %5, %6, %7);";
     style = style.arg(c.red()).arg(c.green()).arg(c.blue()).arg(c.red()).arg(c.green()).arg(c.blue()).arg(0);
@@ -154,7 +177,7 @@ void caImage::setFileName(QString filename)
 void caImage::setFrame(int frame)
 {
     thisFrame = frame;
-    if( _animation.isNull()) return;
-    (void)_animation->jumpToFrame(frame);
+    // like a movie, a frame out of range leaves the image as it is
+    showFrame(frame);
     prevFrame= thisFrame;
 }
@@ -28,7 +28,8 @@
 
 #include <QVBoxLayout>
 #include <QLabel>
-#include <QMovie>
+#include <QPointer>
+#include <QTimer>
 #include <QMenu>
 #include <QMouseEvent>
 #include <qtcontrols_global.h>
@@ -86,20 +87,26 @@ public slots:
     }
 
 protected:
-    virtual void timerEvent(QTimerEvent *e);
+    void resizeEvent(QResizeEvent *e);
+
+private slots:
+    void nextFrame();
 
 private:
     void init(const QString& filename);
+    void showFrame(int frame);
 
     messageQueue *messagequeue;
     QPointer<QLabel> _container;
-    QPointer<QMovie> _animation;
     QVBoxLayout* _layout;
     QString thisFileName;
+    QString thisImageFile;
+    int thisFrameCount;
     int thisFrame, thisDelay;
     int prevFrame;
     QString thisImageCalc;
-    int timerId;
+    QPointer<QTimer> thisClock;
+    bool thisInvalid;
     QColor oldColor;
 };
 
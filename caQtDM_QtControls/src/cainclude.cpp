@@ -208,10 +208,11 @@ void caInclude::setFileName(QString const &filename)
             frame->setFrameShadow(thisFrameShadow);
             frame->setLineWidth(thisFrameLineWidth);
 
-            QColor thisLightColor = thisFrameColor.lighter();
-            QColor thisDarkColor = thisFrameColor.darker();
+            QColor thisBorderColor = thisAlarmColor.isValid() ? thisAlarmColor : thisFrameColor;
+            QColor thisLightColor = thisBorderColor.lighter();
+            QColor thisDarkColor = thisBorderColor.darker();
 
-            thisPalette.setColor(QPalette::WindowText, thisFrameColor);
+            thisPalette.setColor(QPalette::WindowText, thisBorderColor);
             thisPalette.setColor(QPalette::Light, thisLightColor);
             thisPalette.setColor(QPalette::Dark, thisDarkColor);
             thisPalette.setColor(QPalette::Window, thisFrameColor);
@@ -470,12 +471,27 @@ void caInclude::setLineSize(int size )
     update();
 }
 
+/**
+ * colors the border with the summary alarm without loading the include again
+ */
+void caInclude::setAlarmColor(QColor c)
+{
+    thisAlarmColor = c;
+    QColor thisBorderColor = c.isValid() ? c : thisFrameColor;
+
+    thisPalette.setColor(QPalette::WindowText, thisBorderColor);
+    thisPalette.setColor(QPalette::Light, thisBorderColor.lighter());
+    thisPalette.setColor(QPalette::Dark, thisBorderColor.darker());
+    frame->setPalette(thisPalette);
+    update();
+}
+
 void caInclude::paintEvent( QPaintEvent *event)
 {
     Q_UNUSED(event);
     if(thisLineSize > 0) {
         QPainter painter( this );
-        painter.setPen( QPen(thisFrameColor, thisLineSize, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin ) );
+        painter.setPen( QPen(thisAlarmColor.isValid() ? thisAlarmColor : thisFrameColor, thisLineSize, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin ) );
         painter.drawRect(0, 0, width() - 1, height() -1);
     }
 }
@@ -132,6 +132,7 @@ public:
     void setFrameLineWidth(int lineWidth) {thisFrameLineWidth = lineWidth; thisFrameUpdate = true; setFileName(newFileName);}
     void setFrameColor(QColor c) {thisFrameColor = c; thisFrameUpdate = true; setFileName(newFileName);}
     QColor getFrameColor() const {return thisFrameColor;}
+    void setAlarmColor(QColor c);
 
     caInclude( QWidget *parent = 0 );
     ~caInclude();
@@ -197,6 +198,7 @@ private:
     myShapes thisFrameShape;
     QFrame::Shadow thisFrameShadow;
     QColor thisFrameColor;
+    QColor thisAlarmColor;
     int thisFrameLineWidth;
     bool thisFrameUpdate;
     QPalette thisPalette;
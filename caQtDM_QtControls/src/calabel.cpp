@@ -62,27 +62,53 @@ void caLabel::setColors(QColor bg, QColor fg)
         if(!styleSheet().isEmpty()) {
             setStyleSheet("");
             renewStyleSheet = true;
+            oldStyle = "";
+            thisForeColorOld = QColor();
+            setPalette(QPalette());
         }
         return;
     }
 
-    if((bg != thisBackColorOld) || (fg != thisForeColorOld) || renewStyleSheet || styleSheet().isEmpty() || thisBorderWidth != thisBorderWidthOld ||
+    // the stylesheet carries background and border, the foreground (changed by alarms) goes into the palette
+    if((bg != thisBackColorOld) || renewStyleSheet || styleSheet().isEmpty() || thisBorderWidth != thisBorderWidthOld ||
         thisBorderColor != thisBorderColorOld) {
-        thisStyle = "background-color: rgba(%1, %2, %3, %4); color: rgba(%5, %6, %7, %8); border: %9px solid rgba(%10, %11, %12, %13)";
-        thisStyle = thisStyle.arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                arg(fg.red()).arg(fg.green()).arg(fg.blue()).arg(fg.alpha()).arg(thisBorderWidth).
+        thisStyle = "background-color: rgba(%1, %2, %3, %4); border: %5px solid rgba(%6, %7, %8, %9)";
+        thisStyle = thisStyle.arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).arg(thisBorderWidth).
                 arg(thisBorderColor.red()).arg(thisBorderColor.green()).arg(thisBorderColor.blue()).arg(thisBorderColor.alpha());
         thisBackColorOld = bg;
-        thisForeColorOld = fg;
         thisBorderColorOld = thisBorderColor;
         thisBorderWidthOld = thisBorderWidth;
+        renewStyleSheet = false;
     }
 
     if(thisStyle != oldStyle || thisColorMode != oldColorMode) {
         setStyleSheet(thisStyle);
         oldStyle = thisStyle;
-        update();
+        thisForeColorOld = QColor();
+    }
+
+    if(fg != thisForeColorOld) {
+        thisForeColorOld = fg;
+        setForegroundPalette();
+    }
+}
+
+void caLabel::setForegroundPalette()
+{
+    QPalette pal = palette();
+    pal.setColor(QPalette::WindowText, thisForeColorOld);
+    setPalette(pal);
+    update();
+}
+
+bool caLabel::event(QEvent *e)
+{
+    // a new polish takes the text color from the stylesheets again
+    bool result = ESimpleLabel::event(e);
+    if((e->type() == QEvent::Polish || e->type() == QEvent::StyleChange) && thisColorMode != Default && thisForeColorOld.isValid()) {
+        setForegroundPalette();
     }
+    return result;
 }
 
 void caLabel::setBackground(QColor c)
@@ -92,7 +92,12 @@ public slots:
 #include "hideobjectcode.h"
     }
 
+protected:
+    virtual bool event(QEvent *);
+
 private:
+    void setForegroundPalette();
+
     QColor thisForeColor, thisForeColorOld;
     QColor thisBackColor, thisBackColorOld;
     QColor thisBorderColor, thisBorderColorOld;
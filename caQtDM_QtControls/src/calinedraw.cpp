@@ -73,9 +73,6 @@ caLineDraw::caLineDraw(QWidget *parent) : QWidget(parent), FontScalingWidget(thi
     m_Maximum = 0.0;
     m_Minimum = 0.0;
 
-    m_Format[0] = '\0';
-    m_FormatC[0] = '\0';
-
     setFormat(0);
     setFontScaleModeL(WidthAndHeight);
     setFocusPolicy(Qt::NoFocus);
@@ -469,84 +466,62 @@ void caLineDraw::setFormat(int prec)
     switch (m_FormatType) {
     case string:
     case decimal:
-        if(precision >= 0) {
-            sprintf(m_Format, "%s.%dlf", "%", precision);
-        } else {
-            sprintf(m_Format, "%s.%dle", "%", -precision);
-        }
+        m_Formatter.setFormat(ValueFormatter::Fixed, precision);
         break;
     case compact:
-        sprintf(m_Format, "%s.%dle", "%", qAbs(precision));
-        sprintf(m_FormatC, "%s.%dlf", "%", qAbs(precision));
+        m_Formatter.setFormat(ValueFormatter::Compact, precision);
         break;
     case exponential:
+        m_Formatter.setFormat(ValueFormatter::Exponential, precision);
+        break;
     case engr_notation:
-        sprintf(m_Format, "%s.%dle", "%", qAbs(precision));
+        m_Formatter.setFormat(ValueFormatter::Engineering, precision);
         break;
     case truncated:
     case enumeric:
-        if(thisDatatype == caDOUBLE) strcpy(m_Format, "%lld");
-        else strcpy(m_Format, "%d");
+        m_Formatter.setFormat(ValueFormatter::Truncated, precision);
         break;
     case utruncated:
-        if(thisDatatype == caDOUBLE) strcpy(m_Format, "%llu");
-        else strcpy(m_Format, "%u");
+        m_Formatter.setFormat(ValueFormatter::UTruncated, precision);
         break;
     case hexadecimal:
-        if(thisDatatype == caDOUBLE) strcpy(m_Format, "0x%llx");
-        else strcpy(m_Format, "0x%x");
+        m_Formatter.setFormat(ValueFormatter::Hexadecimal, precision);
         break;
     case octal:
-        if(thisDatatype == caDOUBLE) strcpy(m_Format, "O%llo");
-        else strcpy(m_Format, "O%o");
+        m_Formatter.setFormat(ValueFormatter::Octal, precision);
         break;
     case sexagesimal:
+        m_Formatter.setFormat(ValueFormatter::Sexagesimal, precision);
+        break;
     case sexagesimal_hms:
+        m_Formatter.setFormat(ValueFormatter::SexagesimalHMS, precision);
+        break;
     case sexagesimal_dms:
+        m_Formatter.setFormat(ValueFormatter::SexagesimalDMS, precision);
+        break;
+    case user_defined_format:
+        m_Formatter.setFormat(ValueFormatter::UserDefined, precision, thisFormatUserString.toLatin1().constData());
         break;
-    case user_defined_format:{
-            strncpy(m_Format,thisFormatUserString.toLatin1().data(),MAX_STRING_LENGTH);
-            break;
-     }
-
     }
 }
 
 void caLineDraw::setValue(double value, const QString& units)
 {
     char asc[MAX_STRING_LENGTH];
-    if(m_FormatType == compact) {
-        if ((value < 1.e4 && value > 1.e-4) || (value > -1.e4 && value < -1.e-4) || value == 0.0) {
-            snprintf(asc, MAX_STRING_LENGTH, m_FormatC, value);
-        } else {
-            snprintf(asc, MAX_STRING_LENGTH, m_Format, value);
-        }
-    } else if(m_FormatType == hexadecimal || m_FormatType == octal || m_FormatType == user_defined_format)  {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, m_Format, (long long) value);
-        else  snprintf(asc, MAX_STRING_LENGTH, m_Format, (int) value);
-    } else if(m_FormatType == truncated) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, m_Format, (long long) value);
-        else snprintf(asc, MAX_STRING_LENGTH, m_Format, (int) value);
-    } else if(m_FormatType == enumeric) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, m_Format, (long long) value);
-        else snprintf(asc, MAX_STRING_LENGTH, m_Format, (int) value);
-    } else if(m_FormatType == utruncated) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, m_Format, (unsigned long long) value);
-        else snprintf(asc, MAX_STRING_LENGTH, m_Format, (uint) value);
-    } else {
-        snprintf(asc,MAX_STRING_LENGTH,  m_Format, value);
-    }
+    const QString *unitsText = m_UnitMode ? &units : (const QString *) 0;
 
-    if(qIsNaN(value)){
-      snprintf(asc, MAX_STRING_LENGTH,  "nan");
-    }
+    int len = m_Formatter.format(value, thisDatatype == caDOUBLE, asc, MAX_STRING_LENGTH);
+
+    // the text shown is already the one of this value, do not build it again
+    if(ValueFormatter::sameText(m_Text, asc, len, unitsText)) return;
 
+    QString txt = QString::fromLatin1(asc, len);
     if(m_UnitMode) {
-        strcat(asc, " ");
-        strcat(asc, qasc(units));
+        txt.append(QLatin1Char(' '));
+        txt.append(units);
     }
-    setText(asc);
-    emit textChanged(QString(asc));
+    setText(txt);
+    emit textChanged(txt);
 }
 
 // caWidgetInterface implementation
@@ -29,6 +29,7 @@
 #include <QEvent>
 #include <qtcontrols_global.h>
 #include "fontscalingwidget.h"
+#include "valueformatter.h"
 #include "caWidgetInterface.h"
 
 class QTCON_EXPORT caLineDraw : public QWidget, public FontScalingWidget, public caWidgetInterface
@@ -205,8 +206,7 @@ private:
     SourceMode m_LimitsMode;
     FormatType m_FormatType;
     QString m_Text;
-    char m_Format[MAX_STRING_LENGTH];
-    char m_FormatC[20];
+    ValueFormatter m_Formatter;
     short m_AlarmState;
     QColor m_bgAtInitLast;
     QColor m_fgAtInitLast;
@@ -66,8 +66,6 @@ caLineEdit::caLineEdit(QWidget *parent) : QLineEdit(parent), FontScalingWidget(t
     oldStyle = "";
     thisStyle = "";
 
-    thisFormatC[0] = '\0';
-
     setUnitsEnabled(false);
 
     thisBackColor = Qt::gray;
@@ -141,7 +139,8 @@ void caLineEdit::setPV(QString const &newPV)
 
 // this routine sets the correct styles for the calinedit and catextentry (inheriting from calinedit)
 // the styles are now defined here and not in the style sheet any more
-// while this gives a performance problem, limit the use of it by testing changes
+// while this gives a performance problem, the stylesheet only carries the frame now; the colors
+// are painted, so that alarm changes do not need a new stylesheet
 
 void caLineEdit::setColors(QColor bg, QColor fg, QColor frame, int lineWidth)
 {
@@ -149,25 +148,17 @@ void caLineEdit::setColors(QColor bg, QColor fg, QColor frame, int lineWidth)
 
     if((bg != oldBackColor) || (fg != oldForeColor) || (thisColorMode != oldColorMode) || (frame != oldFrameColor) || lineWidth != oldFrameLineWidth) {
         QColor lc, dc;
+        QColor background, foreground;
         QColor blc = frame.lighter();
         QColor bdc = frame.darker();
 
-        thisStyle = "caTextEntry,caLineEdit {background-color: rgba(%1, %2, %3, %4); color: rgba(%5, %6, %7, %8); border-radius: 1px;} ";
-        thisStyle.append("caLineEdit {border: %9px; border-style:outset; padding: 0px 0px 0px 2px; border-color: rgba(%10, %11, %12, %13) rgba(%14, %15, %16, %17)  rgba(%18, %19, %20, %21) rgba(%22, %23, %24, %25);} caTextEntry { border: 2px; padding: 0px;}");
-
         setBotTopBorderWidth((double) lineWidth+1);
         setLateralBorderWidth((double) lineWidth+1);
 
         // alarm default = (colors from stylesheet)
         if(thisColorMode == Default) {
-            thisStyle = thisStyle.arg(defBackColor.red()).arg(defBackColor.green()).arg(defBackColor.blue()).arg(defBackColor.alpha()).
-                    arg(defForeColor.red()).arg(defForeColor.green()).arg(defForeColor.blue()).arg(defForeColor.alpha()).
-                    arg(lineWidth).
-                    arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                    arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                    arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                    arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-
+            background = defBackColor;
+            foreground = defForeColor;
             lc = defBackColor.lighter();
             dc = defBackColor.darker();
 
@@ -175,88 +166,46 @@ void caLineEdit::setColors(QColor bg, QColor fg, QColor frame, int lineWidth)
           // when major alarm and background handling take the background from stylesheet (normally would be white)
         } else if(thisColorMode == Alarm_Default) {
             if(Alarm == MAJOR_ALARM && thisAlarmHandling == onBackground) {
-                thisStyle = thisStyle.arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                        arg(defBackColor.red()).arg(defBackColor.green()).arg(defBackColor.blue()).arg(defBackColor.alpha()).
-                        arg(lineWidth).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
+                background = bg;
+                foreground = defBackColor;
+            } else if(thisAlarmHandling == onForeground) {
+                background = defBackColor;
+                foreground = fg;
             } else {
-                if(thisAlarmHandling == onForeground) {
-                    thisStyle = thisStyle.
-                            arg(defBackColor.red()).arg(defBackColor.green()).arg(defBackColor.blue()).arg(defBackColor.alpha()).
-                            arg(fg.red()).arg(fg.green()).arg(fg.blue()).arg(fg.alpha()).
-                            arg(lineWidth).
-                            arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                            arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                            arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                            arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-                } else {
-                    thisStyle = thisStyle.
-                            arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                            arg(defForeColor.red()).arg(defForeColor.green()).arg(defForeColor.blue()).arg(defForeColor.alpha()).
-                            arg(lineWidth).
-                            arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                            arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                            arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                            arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-                }
+                background = bg;
+                foreground = defForeColor;
             }
-
             lc = defBackColor.lighter();
             dc = defBackColor.darker();
 
             // alarm static = alarm colors on foreground or background (colors from color properties)
         } else if(thisColorMode == Alarm_Static) {
-            if(thisAlarmHandling == onForeground) {
-                thisStyle = thisStyle.
-                        arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                        arg(fg.red()).arg(fg.green()).arg(fg.blue()).arg(fg.alpha()).
-                        arg(lineWidth).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-            } else {
-                thisStyle = thisStyle.
-                        arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                        arg(fg.red()).arg(fg.green()).arg(fg.blue()).arg(fg.alpha()).
-                        arg(lineWidth).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                        arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-            }
+            background = bg;
+            foreground = fg;
             lc = defBackColor.lighter();
             dc = defBackColor.darker();
 
             // static (colors from color properties)
         } else {
-            thisStyle = thisStyle.arg(bg.red()).arg(bg.green()).arg(bg.blue()).arg(bg.alpha()).
-                    arg(fg.red()).arg(fg.green()).arg(fg.blue()).arg(fg.alpha()).
-                    arg(lineWidth).
-                    arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha()).
-                    arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                    arg(blc.red()).arg(blc.green()).arg(blc.blue()).arg(blc.alpha()).
-                    arg(bdc.red()).arg(bdc.green()).arg(bdc.blue()).arg(bdc.alpha());
-
+            background = bg;
+            foreground = fg;
             lc = bg.lighter();
             dc = bg.darker();
         }
 
-        if(thisStyle != oldStyle || thisColorMode != oldColorMode) {
-            thisStyle.append(" caTextEntry {border-style:inset; border-color: rgba(%1, %2, %3, %4) rgba(%5, %6, %7, %8)  rgba(%9, %10, %11, %12) rgba(%13, %14, %15, %16);} caTextEntry:focus {padding: 0px; border: 2px groove rgba(%17, %18, %19, %20); border-radius: 1px;} ");
-            thisStyle = thisStyle.arg(dc.red()).arg(dc.green()).arg(dc.blue()).arg(dc.alpha()).
-                    arg(lc.red()).arg(lc.green()).arg(lc.blue()).arg(lc.alpha()).
-                    arg(lc.red()).arg(lc.green()).arg(lc.blue()).arg(lc.alpha()).
-                    arg(dc.red()).arg(dc.green()).arg(dc.blue()).arg(dc.alpha()).
-                    arg(defSelectColor.red()).arg(defSelectColor.green()).arg(defSelectColor.blue()).arg(defSelectColor.alpha());
+        thisStyle = "caTextEntry,caLineEdit {background-color: transparent; border-radius: 1px;} ";
+        thisStyle.append("caLineEdit {border: %1px; border-style:outset; padding: 0px 0px 0px 2px; border-color: %2 %3 %3 %2;} caTextEntry { border: 2px; padding: 0px;}");
+        thisStyle.append(" caTextEntry {border-style:inset; border-color: %4 %5 %5 %4;} caTextEntry:focus {padding: 0px; border: 2px groove %6; border-radius: 1px;} ");
+        thisStyle = thisStyle.arg(lineWidth).arg(rgbaString(bdc)).arg(rgbaString(blc)).
+                arg(rgbaString(dc)).arg(rgbaString(lc)).arg(rgbaString(defSelectColor));
 
-            if(thisStyle != oldStyle) {
-                setStyleSheet(thisStyle);
-            }
+        // the frame changes only with the designer properties
+        if(thisStyle != oldStyle) {
+            setStyleSheet(thisStyle);
             oldStyle = thisStyle;
+            setPaintColors(background, foreground, true);
+        } else {
+            setPaintColors(background, foreground, false);
         }
     }
     oldBackColor = bg;
@@ -266,6 +215,34 @@ void caLineEdit::setColors(QColor bg, QColor fg, QColor frame, int lineWidth)
     oldColorMode = thisColorMode;
 }
 
+QString caLineEdit::rgbaString(const QColor &c)
+{
+    return QString("rgba(%1, %2, %3, %4)").arg(c.red()).arg(c.green()).arg(c.blue()).arg(c.alpha());
+}
+
+// text color through the palette, background painted in paintEvent
+void caLineEdit::setPaintColors(QColor bg, QColor fg, bool force)
+{
+    if(!force && bg == paintBackColor && fg == paintForeColor) return;
+    paintBackColor = bg;
+    paintForeColor = fg;
+    if(paintForeColor.isValid()) {
+        QPalette pal = palette();
+        pal.setColor(QPalette::Text, paintForeColor);
+        setPalette(pal);
+    }
+    update();
+}
+
+void caLineEdit::paintEvent(QPaintEvent *e)
+{
+    if(paintBackColor.isValid()) {
+        QPainter painter(this);
+        painter.fillRect(rect(), paintBackColor);
+    }
+    QLineEdit::paintEvent(e);
+}
+
 void caLineEdit::setColorMode(colMode colormode)
 {
     thisColorMode = colormode;
@@ -341,6 +318,12 @@ bool caLineEdit::event(QEvent *e)
           isShown = true;
         }
 
+    // a new polish takes the text color from the stylesheets again
+    } else if(e->type() == QEvent::Polish || e->type() == QEvent::StyleChange) {
+        bool result = QLineEdit::event(e);
+        if(isShown) setPaintColors(paintBackColor, paintForeColor, true);
+        return result;
+
     // we do this to temporarily disable the widget in order to be able to initiate a drag
     // for context menu it will be enabled again when drag gets initiated (in caQtDM_Lib)
     } else if(e->type() == QEvent::MouseButtonPress) {
@@ -371,98 +354,69 @@ void caLineEdit::setFormat(int prec)
     switch (thisFormatType) {
     case string:
     case decimal:
-        if(precision >= 0) {
-           sprintf(thisFormat, "%s.%dlf", "%", precision);
-        } else {
-           sprintf(thisFormat, "%s.%dle", "%", -precision);
-        }
+        thisFormatter.setFormat(ValueFormatter::Fixed, precision);
         break;
     case compact:
-        sprintf(thisFormat, "%s.%dle", "%", qAbs(precision));
-        sprintf(thisFormatC, "%s.%dlf", "%", qAbs(precision));
+        thisFormatter.setFormat(ValueFormatter::Compact, precision);
         break;
     case exponential:
+        thisFormatter.setFormat(ValueFormatter::Exponential, precision);
+        break;
     case engr_notation:
-        sprintf(thisFormat, "%s.%dle", "%", qAbs(precision));
+        thisFormatter.setFormat(ValueFormatter::Engineering, precision);
         break;
     case truncated:
     case enumeric:
-        if(thisDatatype == caDOUBLE) strcpy(thisFormat, "%lld");
-        else strcpy(thisFormat, "%d");
+        thisFormatter.setFormat(ValueFormatter::Truncated, precision);
         break;
     case utruncated:
-        if(thisDatatype == caDOUBLE) strcpy(thisFormat, "%llu");
-        else strcpy(thisFormat, "%u");
+        thisFormatter.setFormat(ValueFormatter::UTruncated, precision);
         break;
     case hexadecimal:
-        if(thisDatatype == caDOUBLE) strcpy(thisFormat, "0x%llx");
-        else strcpy(thisFormat, "0x%x");
+        thisFormatter.setFormat(ValueFormatter::Hexadecimal, precision);
         break;
     case octal:
-        if(thisDatatype == caDOUBLE) strcpy(thisFormat, "O%llo");
-        else strcpy(thisFormat, "O%o");
+        thisFormatter.setFormat(ValueFormatter::Octal, precision);
         break;
     case sexagesimal:
+        thisFormatter.setFormat(ValueFormatter::Sexagesimal, precision);
+        break;
     case sexagesimal_hms:
+        thisFormatter.setFormat(ValueFormatter::SexagesimalHMS, precision);
+        break;
     case sexagesimal_dms:
+        thisFormatter.setFormat(ValueFormatter::SexagesimalDMS, precision);
+        break;
+    case user_defined_format:
+        thisFormatter.setFormat(ValueFormatter::UserDefined, precision, thisFormatUserString.toLatin1().constData());
         break;
-    case user_defined_format:{
-            strncpy(thisFormat,thisFormatUserString.toLatin1().data(),MAX_STRING_LENGTH);
-            break;
-        }
     }
 }
 
 void caLineEdit::setValue(double value, const QString& units)
 {
     char asc[MAX_STRING_LENGTH];
+    const QString *unitsText = (const QString *) 0;
     isValue = true;
 
-    if(thisFormatType == compact) {
-      if ((value < 1.e4 && value > 1.e-4) || (value > -1.e4 && value < -1.e-4) || value == 0.0) {
-        snprintf(asc, MAX_STRING_LENGTH, thisFormatC, value);
-      } else {
-        snprintf(asc, MAX_STRING_LENGTH, thisFormat, value);
-      }
-    } else if(thisFormatType == hexadecimal || thisFormatType == octal || thisFormatType == user_defined_format)  {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (long long) value);
-        else  snprintf(asc, MAX_STRING_LENGTH, thisFormat, (int) value);
-    } else if(thisFormatType == truncated) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (long long) value);
-        else  snprintf(asc,MAX_STRING_LENGTH,  thisFormat, (int) value);
-    } else if(thisFormatType == enumeric) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (long long) value);
-        else  snprintf(asc, MAX_STRING_LENGTH, thisFormat, (int) value);
-    } else if(thisFormatType == utruncated) {
-        if(thisDatatype == caDOUBLE) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (unsigned long long) value);
-        else  snprintf(asc,MAX_STRING_LENGTH,  thisFormat, (uint) value);
-    } else {
-        snprintf(asc, MAX_STRING_LENGTH, thisFormat, value);
-    }
-
-    if(qIsNaN(value)){
-      snprintf(asc, MAX_STRING_LENGTH,  "nan");
-    }
+    int len = thisFormatter.format(value, thisDatatype == caDOUBLE, asc, MAX_STRING_LENGTH);
 
     if(thisUnitMode) {
-        strcat(asc, " ");
-        if(!specialUnitsAppend) {
-
-            QString datastring=asc;
-            datastring=datastring+units;
+        if(!specialUnitsAppend) unitsLast = units;
+        else unitsLast = specialUnitsString;
+        unitsText = &unitsLast;
+    }
+    valueLast = value;
 
-            unitsLast = units;
-            setTextLine( qasc(datastring));
+    // the text shown is already the one of this value, do not build it again
+    if(ValueFormatter::sameText(keepText, asc, len, unitsText)) return;
 
-        } else {
-            strcat(asc, qasc(specialUnitsString));
-            unitsLast = specialUnitsString;
-            setTextLine(asc);
-        }
-    }else{
-        valueLast = value;
-        setTextLine(asc);
+    QString txt = QString::fromLatin1(asc, len);
+    if(unitsText != (const QString *) 0) {
+        txt.append(QLatin1Char(' '));
+        txt.append(*unitsText);
     }
+    setTextLine(txt);
 }
 
 void caLineEdit::appendUnits(const QString& units)
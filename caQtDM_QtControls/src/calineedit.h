@@ -30,6 +30,7 @@
 #include <QPainter>
 #include <qtcontrols_global.h>
 #include <fontscalingwidget.h>
+#include "valueformatter.h"
 
 class QTCON_EXPORT caLineEdit : public QLineEdit, public FontScalingWidget
 {
@@ -168,17 +169,22 @@ private slots:
 
 protected:
       virtual bool event(QEvent *);
+      virtual void paintEvent(QPaintEvent *);
       virtual QSize sizeHint() const;
       virtual QSize minimumSizeHint() const;
       QSize calculateTextSpace();
 
 private:
+    void setPaintColors(QColor bg, QColor fg, bool force);
+    static QString rgbaString(const QColor &c);
+
     QString thisPV;
 
     QColor thisForeColor, oldForeColor;
     QColor thisBackColor, oldBackColor;
     QColor defBackColor, defForeColor, defSelectColor;
     QPalette thisPalette;
+    QColor paintBackColor, paintForeColor;
     colMode thisColorMode;
     colMode oldColorMode;
 
@@ -188,8 +194,7 @@ private:
 
     bool thisUnitMode;
     QString keepText;
-    char thisFormat[MAX_STRING_LENGTH];
-    char thisFormatC[20];
+    ValueFormatter thisFormatter;
     bool d_rescaleFontOnTextChanged;
     double thisMaximum, thisMinimum;
     FormatType thisFormatType;
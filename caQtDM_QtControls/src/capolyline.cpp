@@ -24,6 +24,7 @@
  */
 
 #include <QtGui>
+#include <QPixmapCache>
 
 #include "capolyline.h"
 #include "alarmdefs.h"
@@ -219,23 +220,30 @@ void caPolyLine::mouseReleaseEvent(QMouseEvent *event)
 void caPolyLine::setHide(bool hide)
 {
     thisHide = hide;
-    repaint();
+    update();
 }
 
-void caPolyLine::paintEvent(QPaintEvent * /* event */)
+/**
+ * the pairs string is only parsed again when it changed since the last paint
+ */
+void caPolyLine::parsePairs(const QString &pairs)
 {
-    QStringList pairs;
-    if(thisHide) return;
+    if(pairs == parsedPairs) return;
+    parsedPairs = pairs;
+    parsedPolygon.clear();
 
-    QPainter painter(this);
+    QStringList list = pairs.split(";", QString::SkipEmptyParts);
+    for(int i=0; i< list.count(); i++) {
+        QStringList xy = list.at(i).split(",", QString::SkipEmptyParts);
+        if(xy.count() == 2) {
+            parsedPolygon.append(QPoint(atoi(qasc(xy.at(0))), atoi(qasc(xy.at(1)))));
+        }
+    }
+}
 
+void caPolyLine::drawPolyLine(QPainter &painter)
+{
     painter.setRenderHint( QPainter::Antialiasing );
-    int nbPoints = 0;
-
-    if(inEditor) {
-      painter.setBrush(QColor(Qt::white));
-      painter.drawRect(editSize);
-    }
 
     if(thisLineStyle == Dash) {
         painter.setPen( QPen( getLineColor(), getLineSize(), Qt::DotLine,  Qt::FlatCap));
@@ -245,48 +253,71 @@ void caPolyLine::paintEvent(QPaintEvent * /* event */)
         painter.setPen( QPen( getLineColor(), getLineSize(), Qt::SolidLine, Qt::FlatCap));
     }
 
-    if(inDesigner) {
-        pairs = thisXYpairs.split(";", QString::SkipEmptyParts);
-    } else {
-        pairs = XYpairs.split(";", QString::SkipEmptyParts);
+    if(thisFillStyle == Filled) {
+        painter.setBrush(getForeground());
     }
-    QPolygon polygon(pairs.count());
 
-    for(int i=0; i< pairs.count(); i++) {
-        QStringList xy = pairs.at(i).split(",", QString::SkipEmptyParts);
-        if(xy.count() == 2) {
-            polygon.putPoints(i, 1, atoi(qasc(xy.at(0))), atoi(qasc(xy.at(1))));
-            lastPosition =  QPointF(atoi(qasc(xy.at(0))), atoi(qasc(xy.at(1))));
-            nbPoints++;
+    if(parsedPolygon.count() > 0) {
+        if(thisPolyStyle == Polygon) {
+            // when polygon, close the line
+            QPolygon polygon = parsedPolygon;
+            if(polygon.count() > 2) polygon.append(polygon.first());
+            painter.drawPolygon(polygon);
+        } else {
+            painter.drawPolyline(parsedPolygon);
         }
     }
+}
 
-    // when polygon, close the line
-    if((thisPolyStyle == Polygon) && (nbPoints > 2)) {
-        QStringList xy = pairs.at(0).split(",", QString::SkipEmptyParts);
-        if(xy.count() == 2) {
-            polygon.putPoints(nbPoints, 1, atoi(qasc(xy.at(0))), atoi(qasc(xy.at(1))));
-            nbPoints++;
-        }
-    }
+void caPolyLine::paintEvent(QPaintEvent * /* event */)
+{
+    if(thisHide || width() <= 0 || height() <= 0) return;
 
-    if(thisFillStyle == Filled) {
-        painter.setBrush(getForeground());
+    if(inDesigner) {
+        parsePairs(thisXYpairs);
+    } else {
+        parsePairs(XYpairs);
     }
+    if(parsedPolygon.count() > 0) lastPosition = parsedPolygon.last();
 
-    if(nbPoints > 0) {
-        if(thisPolyStyle == Polygon) {
-            painter.drawPolygon(polygon);
-        } else {
-            painter.drawPolyline(polygon);
+    QPainter painter(this);
+
+    // while editing the line changes all the time, draw it directly
+    if(inEditor) {
+        painter.setBrush(QColor(Qt::white));
+        painter.drawRect(editSize);
+        painter.setBrush(Qt::NoBrush);
+        drawPolyLine(painter);
+        if(mouseMove) {
+            painter.setPen( QPen(QColor(Qt::red), getLineSize(), Qt::SolidLine, Qt::FlatCap ) );
+            if(actualPosition != lastPosition)
+                painter.drawLine(actualPosition, lastPosition);
         }
+        return;
     }
 
-    if(inEditor && mouseMove) {
-      painter.setPen( QPen(QColor(Qt::red), getLineSize(), Qt::SolidLine, Qt::FlatCap ) );
-      if(actualPosition != lastPosition)
-         painter.drawLine(actualPosition, lastPosition);
+    // otherwise render once into a pixmap shared by all lines looking the same
+#if QT_VERSION >= 0x050600
+    qreal ratio = devicePixelRatioF();
+#else
+    qreal ratio = 1.0;
+#endif
+    QString key = QString("caPolyLine_%1x%2_%3_%4_%5_%6_%7_%8_%9_")
+            .arg(width()).arg(height()).arg(thisLineSize).arg(thisLineStyle).arg(thisFillStyle).arg(thisPolyStyle)
+            .arg(thisLineColor.rgba()).arg(thisForeColor.rgba()).arg(ratio) + parsedPairs;
+    QPixmap pixmap;
+    if(!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap(qRound(width() * ratio), qRound(height() * ratio));
+#if QT_VERSION >= 0x050600
+        pixmap.setDevicePixelRatio(ratio);
+#endif
+        pixmap.fill(Qt::transparent);
+        QPainter pixmapPainter(&pixmap);
+        drawPolyLine(pixmapPainter);
+        pixmapPainter.end();
+        QPixmapCache::insert(key, pixmap);
     }
+    painter.drawPixmap(0, 0, pixmap);
 }
 
 void caPolyLine::setActualSize(QSize size)
@@ -27,6 +27,8 @@
 #define CAPOLYLINE_H
 
 #include <QWidget>
+#include <QPainter>
+#include <QPolygon>
 #include <qtcontrols_global.h>
 
 QT_BEGIN_NAMESPACE
@@ -128,6 +130,9 @@ protected:
     void resizeEvent(QResizeEvent *event);
 
 private:
+    void parsePairs(const QString &pairs);
+    void drawPolyLine(QPainter &painter);
+
     QString thisXYpairs;
     QString XYpairs;
     QColor thisLineColor, oldLineColor;
@@ -150,6 +155,8 @@ private:
 
     bool thisHide;
 
+    QString parsedPairs;
+    QPolygon parsedPolygon;
 };
 
 #endif
@@ -27,12 +27,105 @@
 #include <QHeaderView>
 #include <QApplication>
 #include <QClipboard>
+#include <QAbstractTableModel>
 #include "catable.h"
 #include "alarmdefs.h"
 
-caTable::caTable(QWidget *parent) : QTableWidget(parent)
+/**
+ * model behind caTable; it keeps text and color of every cell, the view asks only for the visible ones
+ */
+class caTableModel : public QAbstractTableModel
+{
+public:
+    caTableModel(caTable *table) : QAbstractTableModel(table)
+    {
+        d_table = table;
+        d_rows = d_cols = 0;
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : d_rows; }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : d_cols; }
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    void setDimensions(int nbRows, int nbCols);
+    void setCell(int row, int col, QString const &text, const QColor &color);
+    QColor cellColor(int row, int col) const { return colors.at(row * d_cols + col); }
+    void refresh();
+
+private:
+    caTable *d_table;
+    int d_rows, d_cols;
+    QVector<QString> texts;
+    QVector<QColor> colors;
+};
+
+QVariant caTableModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid()) return QVariant();
+    int indx = index.row() * d_cols + index.column();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return texts.at(indx);
+    case Qt::ForegroundRole:
+        if(!colors.at(indx).isValid()) return QVariant();
+        return QBrush(colors.at(indx));
+    case Qt::FontRole:
+        return d_table->thisItemFont;
+    case Qt::TextAlignmentRole:
+        if(index.column() == 0) return (int) (Qt::AlignAbsolute | Qt::AlignLeft);
+        return (int) (Qt::AlignAbsolute | Qt::AlignRight);
+    default:
+        return QVariant();
+    }
+}
+
+// keeps the cells that are still inside the new dimensions
+void caTableModel::setDimensions(int nbRows, int nbCols)
+{
+    if(nbRows < 0) nbRows = 0;
+    if(nbCols < 0) nbCols = 0;
+    if(nbRows == d_rows && nbCols == d_cols) return;
+
+    QVector<QString> newTexts(nbRows * nbCols);
+    QVector<QColor> newColors(nbRows * nbCols);
+    for(int i=0; i < qMin(nbRows, d_rows); i++) {
+        for(int j=0; j < qMin(nbCols, d_cols); j++) {
+            newTexts[i * nbCols + j] = texts.at(i * d_cols + j);
+            newColors[i * nbCols + j] = colors.at(i * d_cols + j);
+        }
+    }
+
+    beginResetModel();
+    d_rows = nbRows;
+    d_cols = nbCols;
+    texts = newTexts;
+    colors = newColors;
+    endResetModel();
+}
+
+void caTableModel::setCell(int row, int col, QString const &text, const QColor &color)
+{
+    int indx = row * d_cols + col;
+    if(texts.at(indx) == text && colors.at(indx) == color) return;
+    texts[indx] = text;
+    colors[indx] = color;
+    QModelIndex cell = index(row, col);
+    emit dataChanged(cell, cell);
+}
+
+void caTableModel::refresh()
+{
+    if(d_rows <= 0 || d_cols <= 0) return;
+    emit dataChanged(index(0, 0), index(d_rows - 1, d_cols - 1));
+}
+
+caTable::caTable(QWidget *parent) : QTableView(parent)
 
 {
+    tableModel = new caTableModel(this);
+    setModel(tableModel);
+
     setPrecisionMode(Channel);
     setLimitsMode(Channel);
     setPrecision(0);
@@ -40,7 +133,6 @@ caTable::caTable(QWidget *parent) : QTableWidget(parent)
     setMaxValue(1.0);
     for(int i=0; i< MaxRows; i++) {
         setFormat(i, 1);
-        for(int j=0; j< MaxCols; j++) tableItem[i][j] = (QTableWidgetItem*) 0;
     }
 
     thisItemFont = this->font();
@@ -48,7 +140,7 @@ caTable::caTable(QWidget *parent) : QTableWidget(parent)
     setColorMode(Static);
     setAlternatingRowColors(true);
     setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
-    setEditTriggers(QTableWidget::NoEditTriggers);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
     verticalHeader()->setDefaultSectionSize(20);
     horizontalHeader()->setResizeMode(QHeaderView::Interactive);
 
@@ -57,20 +149,39 @@ caTable::caTable(QWidget *parent) : QTableWidget(parent)
     createActions();
     addAction(copyAct);
 
-    connect(this, SIGNAL( cellDoubleClicked (int, int) ), this, SLOT(celldoubleclicked( int, int ) ) );
+    connect(this, SIGNAL(doubleClicked(const QModelIndex &)), this, SLOT(celldoubleclicked(const QModelIndex &)));
     setFocusPolicy(Qt::ClickFocus);
 }
 
-void caTable::cellclicked(int row, int col)
+void caTable::cellclicked(const QModelIndex &index)
+{
+    Q_UNUSED(index);
+}
+
+void caTable::celldoubleclicked(const QModelIndex &index)
+{
+     if(index.column()==1) emit TableDoubleClickedSignal(tableModel->data(tableModel->index(index.row(), 0)).toString());
+     selectionModel()->select(index, QItemSelectionModel::Deselect);
+}
+
+int caTable::rowCount() const
+{
+    return tableModel->rowCount();
+}
+
+int caTable::columnCount() const
+{
+    return tableModel->columnCount();
+}
+
+void caTable::setRowCount(int rows)
 {
-    Q_UNUSED(row);
-    Q_UNUSED(col);
+    tableModel->setDimensions(rows, tableModel->columnCount());
 }
 
-void caTable::celldoubleclicked(int row, int col)
+void caTable::setColumnCount(int columns)
 {
-     if(col==1) emit TableDoubleClickedSignal(this->item(row, 0)->text());
-     if(tableItem[row][col] != (QTableWidgetItem*) 0)  this->item(row,col)->setSelected(false);
+    tableModel->setDimensions(tableModel->rowCount(), columns);
 }
 
 void caTable::createActions() {
@@ -109,8 +220,7 @@ void caTable::copy()
             if (i > 0) str += "\n";
             for(int j = 0; j < columnCount(); ++j) {
                 if (j > 0) str += "\t";
-                QTableWidgetItem* pWidget = item(Row.row(), j);
-                str += pWidget->text();
+                str += tableModel->data(tableModel->index(Row.row(), j)).toString();
             }
             i++;
         }
@@ -122,8 +232,7 @@ void caTable::copy()
                 if (i > 0) str += "\n";
                 for(int j = 0; j < rowCount(); ++j) {
                     if (j > 0) str += "\t";
-                    QTableWidgetItem* pWidget = item(j, Col.column());
-                    str += pWidget->text();
+                    str += tableModel->data(tableModel->index(j, Col.column())).toString();
                 }
                 i++;
             }
@@ -145,11 +254,7 @@ void caTable::setFormat(int row, int prec)
         precision = prec;
     }
     if(precision > 17) precision = 17;
-    if(precision >= 0) {
-        sprintf(thisFormat[row], "%s.%dlf", "%", precision);
-    } else {
-        sprintf(thisFormat[row], "%s.%dle", "%", -precision);
-    }
+    thisRowPrecision[row] = precision;
 }
 
 void caTable::displayText(int row, int col, short status, QString const &text)
@@ -159,52 +264,46 @@ void caTable::displayText(int row, int col, short status, QString const &text)
 
     if(row >= rowCount() || col >= columnCount()) return;
 
-    if(tableItem[row][col] != (QTableWidgetItem*) 0) {
-        tableItem[row][col]->setText(text);
-    } else {
-        tableItem[row][col] = new QTableWidgetItem(text);
-        tableItem[row][col]->setFont(thisItemFont);
-        if(col==0) tableItem[row][col]->setTextAlignment(Qt::AlignAbsolute | Qt:: AlignLeft);
-        else tableItem[row][col]->setTextAlignment(Qt::AlignAbsolute | Qt:: AlignRight);
-        setItem(row, col, tableItem[row][col]);
-    }
-
+    QColor color = tableModel->cellColor(row, col);
     if(thisColorMode == Alarm) {
 
         switch (status) {
         case -1:
             break;
         case NO_ALARM:
-            tableItem[row][col]->setForeground(AL_GREEN);
+            color = AL_GREEN;
             break;
         case MINOR_ALARM:
-            tableItem[row][col]->setForeground(AL_YELLOW);
+            color = AL_YELLOW;
             break;
         case MAJOR_ALARM:
-            tableItem[row][col]->setForeground(AL_RED);
+            color = AL_RED;
             break;
         case INVALID_ALARM:
         case NOTCONNECTED:
-            tableItem[row][col]->setForeground(AL_WHITE);
+            color = AL_WHITE;
             break;
         default:
-            tableItem[row][col]->setForeground(AL_DEFAULT);
+            color = AL_DEFAULT;
             break;
         }
     }   else {
-        tableItem[row][col]->setForeground(defaultForeColor);
+        color = defaultForeColor;
     }
+
+    tableModel->setCell(row, col, text, color);
 }
 
 void caTable::setValueFont(QFont font)
 {
    thisItemFont = font;
+   tableModel->refresh();
 }
 
 
 void caTable::setValue(int row, int col, short status, double value, QString const &unit)
 {
-    string40 text = {'\0'};
+    char text[MAX_STRING_LENGTH];
     short Alarm = -1;
 
     if(row < 0 || row > MaxRows-1) return;
@@ -219,8 +318,10 @@ void caTable::setValue(int row, int col, short status, double value, QString con
             Alarm = NO_ALARM;
         }
     }
-    sprintf(text, thisFormat[row], value);
-    displayText(row, col, Alarm, text);
+    // fixed point, or exponential for a negative precision
+    thisFormatter.setFormat(ValueFormatter::Fixed, thisRowPrecision[row]);
+    int len = thisFormatter.format(value, false, text, MAX_STRING_LENGTH);
+    displayText(row, col, Alarm, QString::fromLatin1(text, len));
     displayText(row, col+1, Alarm, unit);
 }
 
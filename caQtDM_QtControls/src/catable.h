@@ -26,16 +26,19 @@
 #ifndef CATABLE_H
 #define CATABLE_H
 
-#include <QTableWidget>
+#include <QTableView>
 #include <QAction>
 #include <QFont>
 #include <qtcontrols_global.h>
 
 #include "caPropHandleDefs.h"
+#include "valueformatter.h"
 
 typedef char string40[40];
 
-class QTCON_EXPORT caTable : public QTableWidget
+class caTableModel;
+
+class QTCON_EXPORT caTable : public QTableView
 {
     Q_OBJECT
 
@@ -102,6 +105,11 @@ public:
     double getMinValue()  const {return thisMinimum;}
     void setMinValue(double const &minim) {thisMinimum = minim;}
 
+    int rowCount() const;
+    int columnCount() const;
+    void setRowCount(int rows);
+    void setColumnCount(int columns);
+
     void setFormat(int row, int prec);
     void setValue(int row, int col, short severity, double value, QString const &unit);
     void displayText(int row, int col, short severity, QString const &text);
@@ -124,10 +132,12 @@ signals:
 
 private slots:
     void copy();
-    void celldoubleclicked(int, int);
-    void cellclicked(int, int);
+    void celldoubleclicked(const QModelIndex &);
+    void cellclicked(const QModelIndex &);
 
 private:
+    friend class caTableModel;
+
     enum { MaxRows = 500 };
     enum { MaxCols = 5  };
     QStringList	thisPVS;
@@ -135,8 +145,9 @@ private:
     double thisMaximum, thisMinimum;
     QString thisStyle;
     QString oldStyle;
-    string40 thisFormat[MaxRows];
-    QTableWidgetItem* tableItem[MaxRows][MaxCols];
+    int thisRowPrecision[MaxRows];
+    ValueFormatter thisFormatter;
+    caTableModel *tableModel;
 
     colMode thisColorMode;
     int thisPrecision;
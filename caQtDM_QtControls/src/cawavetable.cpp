@@ -34,14 +34,162 @@
 #include <QHeaderView>
 #include <QApplication>
 #include <QClipboard>
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
 #include <qnumeric.h>
 #include "cawavetable.h"
 #include "alarmdefs.h"
 
+/**
+ * model behind caWaveTable; it keeps the last values of the waveform and formats
+ * only the cells the view asks for, i.e. the visible ones
+ */
+class caWaveTableModel : public QAbstractTableModel
+{
+public:
+    caWaveTableModel(caWaveTable *table) : QAbstractTableModel(table)
+    {
+        d_table = table;
+        d_rows = d_cols = 0;
+        count = 0;
+        dataType = caWaveTable::doubles;
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : d_rows; }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : d_cols; }
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+
+    void setDimensions(int nbRows, int nbCols);
+    void valuesChanged(int newCount);
+    void refresh();
+
+    template <typename T> void setValues(const T *array, int size, caWaveTable::DataType type)
+    {
+        values.resize(size);
+        for(int i=0; i< size; i++) values[i] = (double) array[i];
+        strings.clear();
+        dataType = type;
+        valuesChanged(size);
+    }
+
+    void setStrings(const QStringList &list, int size)
+    {
+        strings = list;
+        values.clear();
+        dataType = caWaveTable::strings;
+        valuesChanged(qMin(size, list.size()));
+    }
+
+    QVector<double> values;
+    QStringList strings;
+    caWaveTable::DataType dataType;
+    int count;
+    QColor foreColor;
+
+private:
+    caWaveTable *d_table;
+    int d_rows, d_cols;
+};
+
+QVariant caWaveTableModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid()) return QVariant();
+    int indx = index.row() * d_cols + index.column();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        if(indx >= count) return QString();
+        if(dataType == caWaveTable::strings) return strings.at(indx);
+        return d_table->setValue(values.at(indx), dataType);
+    case Qt::ForegroundRole:
+        if(indx >= count || !foreColor.isValid()) return QVariant();
+        return QBrush(foreColor);
+    case Qt::FontRole:
+        return d_table->thisItemFont;
+    case Qt::TextAlignmentRole:
+        switch (d_table->thisAlignment) {
+        case caWaveTable::Left:
+            return (int) Qt::AlignLeft;
+        case caWaveTable::Center:
+            return (int) Qt::AlignCenter;
+        case caWaveTable::Right:
+        default:
+            return (int) Qt::AlignRight;
+        }
+    default:
+        return QVariant();
+    }
+}
+
+bool caWaveTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if(!index.isValid() || role != Qt::EditRole) return false;
+
+    // the cell keeps showing the monitored value, the entry is only written to the control system
+    d_table->dataInput(index.row() * d_cols + index.column(), value.toString());
+    return true;
+}
+
+Qt::ItemFlags caWaveTableModel::flags(const QModelIndex &index) const
+{
+    if(!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable;
+}
+
+void caWaveTableModel::setDimensions(int nbRows, int nbCols)
+{
+    beginResetModel();
+    d_rows = nbRows;
+    d_cols = nbCols;
+    count = 0;
+    values.clear();
+    strings.clear();
+    endResetModel();
+}
+
+// one notification covering the rows touched by the new and the previous values
+void caWaveTableModel::valuesChanged(int newCount)
+{
+    int changed = qMax(count, newCount);
+    count = newCount;
+    if(changed <= 0 || d_rows <= 0 || d_cols <= 0) return;
+    int lastRow = qMin((changed - 1) / d_cols, d_rows - 1);
+    emit dataChanged(index(0, 0), index(lastRow, d_cols - 1));
+}
+
+void caWaveTableModel::refresh()
+{
+    if(d_rows <= 0 || d_cols <= 0) return;
+    emit dataChanged(index(0, 0), index(d_rows - 1, d_cols - 1));
+}
+
+/**
+ * monitor updates should not overwrite what is being typed into a cell
+ */
+class caWaveTableDelegate : public QStyledItemDelegate
+{
+public:
+    caWaveTableDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+    void setEditorData(QWidget *editor, const QModelIndex &index) const
+    {
+        if(editor->property("editorInitialized").toBool()) return;
+        editor->setProperty("editorInitialized", true);
+        QStyledItemDelegate::setEditorData(editor, index);
+    }
+};
+
 
-caWaveTable::caWaveTable(QWidget *parent) : QTableWidget(parent)
+caWaveTable::caWaveTable(QWidget *parent) : QTableView(parent)
 {
-    thisFormatC[0] = '\0';
+    tableModel = new caWaveTableModel(this);
+    setModel(tableModel);
+    setItemDelegate(new caWaveTableDelegate(this));
+    setEditTriggers(QAbstractItemView::DoubleClicked);
+
     thisFormat[0] = '\0';
     thisUnsigned = false;
 
@@ -67,11 +215,11 @@ caWaveTable::caWaveTable(QWidget *parent) : QTableWidget(parent)
     clearFocus();
     setAccessW(true);
 
-    connect(this, SIGNAL(cellDoubleClicked (int, int) ), this, SLOT(cellDoubleclicked( int, int ) ) );
-    connect(this, SIGNAL(cellChanged(int, int)), this, SLOT(dataInput(int, int)));
-    connect(this, SIGNAL(cellClicked(int, int)), this, SLOT(cellClicked(int, int)));
+    connect(this, SIGNAL(doubleClicked(const QModelIndex &)), this, SLOT(cellDoubleclicked(const QModelIndex &)));
+    connect(this, SIGNAL(clicked(const QModelIndex &)), this, SLOT(cellClicked(const QModelIndex &)));
 
-    connect(this, SIGNAL(currentCellChanged(int, int, int, int)), this,  SLOT(cellChange(int,int, int, int)));
+    connect(selectionModel(), SIGNAL(currentChanged(const QModelIndex &, const QModelIndex &)), this,
+            SLOT(cellChange(const QModelIndex &, const QModelIndex &)));
 
     createActions();
     addAction(copyAct);
@@ -123,103 +271,46 @@ void caWaveTable::setNumberOfColumns(int nbCols) {
 
 void caWaveTable::setupItems(int nbRows, int nbCols)
 {
-    // get rid of old items and clear table
-    for(int i=0; i<rowCount(); i++) {
-        for(int j=0; j<columnCount(); j++) {
-            QTableWidgetItem *Item = item(i,j);
-            if(Item != (QTableWidgetItem *) 0) {
-                delete Item;
-            }
-        }
-    }
-    clear();
-
-    // setup table with alignment of items
-    setColumnCount(nbCols);
-    setRowCount(nbRows);
-    for(int i=0; i<nbRows; i++) {
-        for(int j=0; j<nbCols; j++) {
-
-            setItem(i,j, new QTableWidgetItem());
-            item(i,j)->setFont(thisItemFont);
-            switch (thisAlignment) {
-            case Left:
-                item(i,j)->setTextAlignment(Qt::AlignLeft);
-                break;
-            case Center:
-                item(i,j)->setTextAlignment(Qt::AlignCenter);
-                break;
-            case Right:
-            default:
-                item(i,j)->setTextAlignment(Qt::AlignRight);
-                break;
-            }
-        }
-    }
-
-    keepText.clear();
-    keepData.clear();
-    keepText.resize(rowcount*colcount+1);
-    keepData.resize(rowcount*colcount+1);
-}
-
-void caWaveTable::cellChange(int currentRow, int currentColumn, int previousRow, int previousColumn) {
-    Q_UNUSED(currentRow);
-    Q_UNUSED(currentColumn);
-    Q_UNUSED(previousRow);
-    Q_UNUSED(previousColumn);
-    blockIndex = -1;
+    // the model only holds the dimensions and the last values, cells are formatted when displayed
+    tableModel->setDimensions(nbRows, nbCols);
 }
 
-void caWaveTable::enableEdit(QTableWidgetItem* pItem)
+void caWaveTable::setAlignment(const Alignment &alignment)
 {
-    Qt::ItemFlags eFlags = pItem->flags();
-    eFlags |= Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable;
-    pItem->setFlags(eFlags);
+    thisAlignment = alignment;
+    tableModel->refresh();
 }
 
-void caWaveTable::disableEdit(QTableWidgetItem* pItem)
-{
-    Qt::ItemFlags eFlags = pItem->flags();
-    eFlags &= ~Qt::ItemIsEditable;
-    pItem->setFlags(eFlags);
+void caWaveTable::cellChange(const QModelIndex &current, const QModelIndex &previous) {
+    Q_UNUSED(current);
+    Q_UNUSED(previous);
+    blockIndex = -1;
 }
 
-void caWaveTable::dataInput(int row, int col)
+void caWaveTable::dataInput(int index, QString const &text)
 {
-    int index = toIndex(row,col);
     if(!dataPresent) return;
 
     if(index == blockIndex) {
         blockIndex = -1;
-        QString valueText =  item(row, col)->text();
 
         clearSelection();
 
-        // set the value back (dataInput is now blocked again
-        if(item(row,col) != (QTableWidgetItem*) 0) {
-            item(row,col)->setText(keepText[index]);
-        }
-
         // and write it to the control system
-        emit WaveEntryChanged(valueText, index);
+        emit WaveEntryChanged(text, index);
     }
 }
 
-void caWaveTable::cellClicked(int row, int col)
+void caWaveTable::cellClicked(const QModelIndex &index)
 {
-    Q_UNUSED(row);
-    Q_UNUSED(col);
-    disableEdit(item(row, col));
+    Q_UNUSED(index);
     QTimer::singleShot(2000, this, SLOT(clearSelection()));
 }
 
-void caWaveTable::cellDoubleclicked(int row, int col)
+void caWaveTable::cellDoubleclicked(const QModelIndex &index)
 {
-    enableEdit(item(row,col));
-
-    // prevent monitoring change of this item until focus is lost again
-    blockIndex = toIndex(row, col);
+    // the entry of this cell will be written when editing is finished
+    blockIndex = toIndex(index.row(), index.column());
 }
 
 bool caWaveTable::eventFilter(QObject *obj, QEvent *event)
@@ -283,24 +374,19 @@ void caWaveTable::setFormat(DataType dataType)
         switch (thisFormatType) {
         case string:
         case decimal:
-            if(actualPrecision >= 0) {
-                sprintf(thisFormat, "%s.%dlf", "%", actualPrecision);
-            } else {
-                sprintf(thisFormat, "%s.%dle", "%", -actualPrecision);
-            }
+            thisFormatter.setFormat(ValueFormatter::Fixed, actualPrecision);
             break;
         case compact:
-            sprintf(thisFormat, "%s.%dle", "%", qAbs(actualPrecision));
-            sprintf(thisFormatC, "%s.%dlf", "%", qAbs(actualPrecision));
+            thisFormatter.setFormat(ValueFormatter::Compact, actualPrecision);
             break;
         case exponential:
-            sprintf(thisFormat, "%s.%dle", "%", qAbs(actualPrecision));
+            thisFormatter.setFormat(ValueFormatter::Exponential, actualPrecision);
             break;
         case hexadecimal:
-            strcpy(thisFormat, "0x%x");
+            thisFormatter.setFormat(ValueFormatter::Hexadecimal, actualPrecision);
             break;
         case octal:
-            strcpy(thisFormat, "O%o");
+            thisFormatter.setFormat(ValueFormatter::Octal, actualPrecision);
             break;
         }
 
@@ -311,26 +397,26 @@ void caWaveTable::setFormat(DataType dataType)
         case compact:
         case exponential:
             strcpy(thisFormat, "%d");
-            strcpy(thisFormatC, "%d");
+            thisFormatter.setFormat(ValueFormatter::Truncated, 0);
             break;
         case hexadecimal:
             strcpy(thisFormat, "0x%x");
+            thisFormatter.setFormat(ValueFormatter::Hexadecimal, 0);
             break;
         case octal:
             strcpy(thisFormat, "O%o");
+            thisFormatter.setFormat(ValueFormatter::Octal, 0);
             break;
         }
     } else if(dataType == characters) {
         switch (thisFormatType) {
         case string:
             strcpy(thisFormat, "%c");
-            strcpy(thisFormatC, "%c");
             break;
         case decimal:
         case compact:
         case exponential:
             strcpy(thisFormat, "%d");
-            strcpy(thisFormatC, "%d");
             break;
         case hexadecimal:
             strcpy(thisFormat, "0x%x");
@@ -343,23 +429,15 @@ void caWaveTable::setFormat(DataType dataType)
 
 }
 
-QString caWaveTable::setValue(double value, DataType dataType)
+QString caWaveTable::setValue(double value, DataType dataType) const
 {
     char asc[MAX_STRING_LENGTH];
 
-    if(dataType == doubles) {
-        if(thisFormatType == compact) {
-            if ((value < 1.e4 && value > 1.e-4) || (value > -1.e4 && value < -1.e-4) || value == 0.0) {
-                snprintf(asc, MAX_STRING_LENGTH, thisFormatC, value);
-            } else {
-                snprintf(asc, MAX_STRING_LENGTH, thisFormat, value);
-            }
-        } else {
-            snprintf(asc, MAX_STRING_LENGTH, thisFormat, value);
-        }
+    // doubles and signed integers go through the formatter, it converts the value like printf without parsing a format
+    if(dataType == doubles || (dataType == longs && !thisUnsigned)) {
+        thisFormatter.format(value, false, asc, MAX_STRING_LENGTH);
     } else if(dataType == longs) {
-        if(thisUnsigned) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (uint) value);
-        else snprintf(asc, MAX_STRING_LENGTH, thisFormat, (int) value);
+        snprintf(asc, MAX_STRING_LENGTH, thisFormat, (uint) value);
     } else if(dataType == characters) {
         if(thisUnsigned) snprintf(asc, MAX_STRING_LENGTH, thisFormat, (uchar) value);
         else snprintf(asc, MAX_STRING_LENGTH, thisFormat, (char) value);
@@ -373,69 +451,50 @@ QString caWaveTable::setValue(double value, DataType dataType)
 }
 
 // calcualte from the row and column indexes the array index
-int caWaveTable::toIndex(int row, int col) {
+int caWaveTable::toIndex(int row, int col) const {
     return row*colcount+col;
 }
 
 // calculate from index the row and column indexes
-void caWaveTable::fromIndex(int index, int &row, int &col)
+void caWaveTable::fromIndex(int index, int &row, int &col) const
 {
     row = index / colcount;
     col = index - row * colcount;
 }
 
-void caWaveTable::displayText(int index, short status, QString const &text)
+void caWaveTable::setStatus(short status)
 {
-    int column =0;
-    int row = 0;
-
-    if(index > colcount * rowcount) return;
-    if(keepText[index] == text) return;
-
-    keepText[index] = text;
-
-    if(index == blockIndex) return;
-
-    if(colcount == 0) row = 0;
-    else row = index / colcount;
-    column = index - row * colcount;
-    if(column < 0) column=0;
-
-    if(this->item(row, column) != 0)  {
-
-        this->item(row,column)->setText(text);
-
-        if(thisColorMode == Alarm) {
+    if(thisColorMode != Alarm) {
+        tableModel->foreColor = defaultForeColor;
+        return;
+    }
 
-            switch (status) {
-            case -1:
-                break;
-            case NO_ALARM:
-                this->item(row, column)->setForeground(AL_GREEN);
-                break;
-            case MINOR_ALARM:
-                this->item(row, column)->setForeground(AL_YELLOW);
-                break;
-            case MAJOR_ALARM:
-                this->item(row, column)->setForeground(AL_RED);
-                break;
-            case INVALID_ALARM:
-            case NOTCONNECTED:
-                this->item(row, column)->setForeground(AL_WHITE);
-                break;
-            default:
-                this->item(row, column)->setForeground(AL_DEFAULT);
-                break;
-            }
-        }   else {
-            this->item(row, column)->setForeground(defaultForeColor);
-        }
+    switch (status) {
+    case -1:
+        break;
+    case NO_ALARM:
+        tableModel->foreColor = AL_GREEN;
+        break;
+    case MINOR_ALARM:
+        tableModel->foreColor = AL_YELLOW;
+        break;
+    case MAJOR_ALARM:
+        tableModel->foreColor = AL_RED;
+        break;
+    case INVALID_ALARM:
+    case NOTCONNECTED:
+        tableModel->foreColor = AL_WHITE;
+        break;
+    default:
+        tableModel->foreColor = AL_DEFAULT;
+        break;
     }
 }
 
 void caWaveTable::setValueFont(QFont font)
 {
     thisItemFont = font;
+    tableModel->refresh();
 }
 
 QString caWaveTable::getPV() const
@@ -454,13 +513,9 @@ void caWaveTable::setStringList(QStringList list, short status, int size)
     int maxSize = rowcount * colcount;
     sizeSaved = size;
 
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, list.at(i));
-    }
+    setStatus(status);
+    tableModel->setStrings(list, qMin(size, maxSize));
     dataPresent = true;
-    keepDatatype = strings;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setData(double *array, short status, int size)
@@ -470,14 +525,9 @@ void caWaveTable::setData(double *array, short status, int size)
     sizeSaved = size;
 
     setFormat(doubles);
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, setValue(array[i], doubles));
-        keepData[i] = array[i];
-    }
+    setStatus(status);
+    tableModel->setValues(array, qMin(size, maxSize), doubles);
     dataPresent = true;
-    keepDatatype = doubles;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setData(float *array, short status, int size)
@@ -487,14 +537,9 @@ void caWaveTable::setData(float *array, short status, int size)
     sizeSaved = size;
 
     setFormat(doubles);
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, setValue(array[i], doubles));
-        keepData[i] = (double) array[i];
-    }
+    setStatus(status);
+    tableModel->setValues(array, qMin(size, maxSize), doubles);
     dataPresent = true;
-    keepDatatype = doubles;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setData(int16_t *array, short status, int size)
@@ -504,14 +549,9 @@ void caWaveTable::setData(int16_t *array, short status, int size)
     sizeSaved = size;
 
     setFormat(longs);
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, setValue(array[i], longs));
-        keepData[i] = (double) array[i];
-    }
+    setStatus(status);
+    tableModel->setValues(array, qMin(size, maxSize), longs);
     dataPresent = true;
-    keepDatatype = longs;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setData(int32_t *array, short status, int size)
@@ -521,14 +561,9 @@ void caWaveTable::setData(int32_t *array, short status, int size)
     sizeSaved = size;
 
     setFormat(longs);
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, setValue(array[i], longs));
-        keepData[i] = (double) array[i];
-    }
+    setStatus(status);
+    tableModel->setValues(array, qMin(size, maxSize), longs);
     dataPresent = true;
-    keepDatatype = longs;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setData(char *array, short status, int size)
@@ -538,14 +573,9 @@ void caWaveTable::setData(char *array, short status, int size)
     sizeSaved = size;
 
     setFormat(characters);
-    for(int i=0; i< qMin(size, maxSize); i++) {
-        displayText(i, status, setValue((double) ((int) array[i]), characters));
-        keepData[i] =  (double) ((int) array[i]);
-    }
+    setStatus(status);
+    tableModel->setValues(array, qMin(size, maxSize), characters);
     dataPresent = true;
-    keepDatatype = characters;
-    keepDatasize = qMin(size, maxSize);
-    keepStatus = status;
 }
 
 void caWaveTable::setDataType(QString const &datatype)
@@ -553,12 +583,8 @@ void caWaveTable::setDataType(QString const &datatype)
     if(datatype.contains("U")) thisUnsigned = true;
     else thisUnsigned = false;
 
-    if(keepDatatype == strings) return;
-    if(dataPresent) {
-        for(int i=0; i< keepDatasize; i++) {
-            displayText(i, keepStatus, setValue(keepData[i], keepDatatype));
-        }
-    }
+    if(tableModel->dataType == strings) return;
+    if(dataPresent) tableModel->refresh();
 }
 
 
@@ -578,10 +604,9 @@ void caWaveTable::copy()
         int i=0;
         foreach (QModelIndex Row, rows) {
             if (i > 0) str += "\n";
-            for(int j = 0; j < columnCount(); ++j) {
+            for(int j = 0; j < tableModel->columnCount(); ++j) {
                 if (j > 0) str += "\t";
-                QTableWidgetItem* pWidget = item(Row.row(), j);
-                str += pWidget->text();
+                str += tableModel->data(tableModel->index(Row.row(), j)).toString();
             }
             i++;
         }
@@ -591,10 +616,9 @@ void caWaveTable::copy()
             QModelIndexList cols = select->selectedColumns();
             foreach (QModelIndex Col, cols) {
                 if (i > 0) str += "\n";
-                for(int j = 0; j < rowCount(); ++j) {
+                for(int j = 0; j < tableModel->rowCount(); ++j) {
                     if (j > 0) str += "\t";
-                    QTableWidgetItem* pWidget = item(j, Col.column());
-                    str += pWidget->text();
+                    str += tableModel->data(tableModel->index(j, Col.column())).toString();
                 }
                 i++;
             }
@@ -26,7 +26,7 @@
 #ifndef CAWAVETABLE_H
 #define CAWAVETABLE_H
 
-#include <QTableWidget>
+#include <QTableView>
 #include <QAction>
 #include <QFont>
 #include <QEvent>
@@ -34,14 +34,15 @@
 #include <QTimer>
 #include <stdint.h>
 #include <qtcontrols_global.h>
+#include "valueformatter.h"
 
 typedef char string40[40];
 
-class QTCON_EXPORT caWaveTable : public QTableWidget
+class caWaveTableModel;
+
+class QTCON_EXPORT caWaveTable : public QTableView
 {
     Q_OBJECT
-    Q_PROPERTY(int rowCount READ rowCount WRITE setRowCount DESIGNABLE false)
-    Q_PROPERTY(int columnCount READ columnCount WRITE setColumnCount DESIGNABLE false)
 
     Q_PROPERTY(QString channel READ getPV WRITE setPV)
     Q_PROPERTY(int numberOfRows READ getNumberOfRows WRITE setNumberOfRows)
@@ -94,7 +95,6 @@ public:
     void setDataType(QString const &datatype);
 
     void setActualPrecision(int prec);
-    void displayText(int index, short status, QString const &text);
 
     void setValueFont(QFont font);
 
@@ -116,9 +116,7 @@ public:
     void setFormatType(FormatType m) { thisFormatType = m;}
     FormatType getFormatType() { return thisFormatType; }
 
-    void setAlignment(const Alignment &alignment) { thisAlignment = alignment;
-                                                    if(colcount > 0 && rowcount > 0) setupItems(rowcount, colcount);
-                                                  }
+    void setAlignment(const Alignment &alignment);
     Alignment getAlignment() const {return thisAlignment;}
 
 public slots:
@@ -132,32 +130,33 @@ public slots:
 
 private slots:
     void copy();
-    void dataInput(int, int);
-    void cellDoubleclicked(int, int);
-    void cellClicked(int, int);
-    void cellChange(int, int, int, int);
+    void cellDoubleclicked(const QModelIndex &);
+    void cellClicked(const QModelIndex &);
+    void cellChange(const QModelIndex &, const QModelIndex &);
 
 signals:
     void WaveEntryChanged(const QString &text, int index);
 
 private:
+    friend class caWaveTableModel;
+
     bool eventFilter(QObject *obj, QEvent *event);
     void createActions();
-    void enableEdit(QTableWidgetItem* pItem);
-    void disableEdit(QTableWidgetItem* pItem);
     void setupItems(int nbRows, int nbCols);
-    int toIndex(int row, int col);
-    void fromIndex(int index, int &row, int &col);
+    int toIndex(int row, int col) const;
+    void fromIndex(int index, int &row, int &col) const;
     void setFormat(DataType dataType);
-    QString setValue(double value, DataType dataType);
+    QString setValue(double value, DataType dataType) const;
     void RedefineRowColumns(int xsav, int ysav, int z, int &x, int &y);
+    void dataInput(int index, QString const &text);
+    void setStatus(short status);
 
     bool _AccessW;
 
     QString	thisPV;
     int	thisColumnSize;
     char thisFormat[20];
-    char thisFormatC[20];
+    ValueFormatter thisFormatter;
     FormatType thisFormatType;
     bool thisUnsigned;
     Alignment thisAlignment;
@@ -167,11 +166,7 @@ private:
     QFont thisItemFont;
     QAction *copyAct;
 
-    QVector<QString> keepText;
-    QVector<double> keepData;
-    DataType keepDatatype;
-    int keepDatasize;
-    short keepStatus;
+    caWaveTableModel *tableModel;
 
     int blockIndex;
 
@@ -25,6 +25,7 @@
 
 #include "fileFunctions.h"
 #include "networkaccess.h"
+#include "networkprefetch.h"
 #include "searchfile.h"
 #include "specialFunctions.h"
 
@@ -89,14 +90,53 @@ int fileFunctions::checkFileAndDownload(const QString &fileName, const QString &
         return false;
     }
     displayGet->deleteLater();
+
+    // the file exists now, forget a negative resolution
+    searchFile::invalidateCache(fileName);
     return true;
 }
 
+/**
+ * downloads in parallel the includes, images and related displays of a display file from a http server,
+ * files already downloaded are only revalidated; waits at most timeout ms, what is not done by then
+ * is downloaded on demand when the display is built
+ */
+int fileFunctions::prefetchDependencies(const QString &fileName, const QString &url, int timeout)
+{
+    QString displayPath;
+    errorString = "";
+    infoString = "";
+
+    // use specified url
+    if(url.size() > 0) {
+       displayPath = url;
+    // otherwise use url from environment variable
+    } else {
+       displayPath = (QString)  qgetenv("CAQTDM_URL_DISPLAY_PATH");
+    }
+
+    if(displayPath.length() < 1) return true;
+
+    NetworkPrefetch prefetch(displayPath);
+    prefetch.prefetch(fileName);
+    bool success = prefetch.waitForFinished(timeout);
+
+    if(prefetch.downloaded() > 0 || prefetch.notModified() > 0 || !success) {
+        infoString = QString("prefetch for %1: %2 files downloaded, %3 not modified").arg(fileName).arg(prefetch.downloaded()).arg(prefetch.notModified());
+        if(!success) infoString.append(QString(", %1 left to load on demand").arg(prefetch.pending()));
+    }
+    if(!prefetch.errors().isEmpty()) {
+        errorString = prefetch.errors().join("\n");
+        return false;
+    }
+    return success;
+}
+
 bool fileFunctions::removeFilesInTree(const QString &dirName)
     {
         QStringList fileFilter;
         bool result = true;
-        fileFilter << "ui" << "prc" << "gif" << "jpg" << "png";
+        fileFilter << "ui" << "prc" << "gif" << "jpg" << "png" << "http";
         QDir dir(dirName);
 
         if (dir.exists(dirName)) {
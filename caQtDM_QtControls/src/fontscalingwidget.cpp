@@ -27,12 +27,38 @@
 #include <QEvent>
 #include <QTextDocument>
 #include <QTextCursor>
+#include <QHash>
 #include <QtDebug>
 
 #define qslisttoc(x) 			do {}while(0)
 
 #define FONT_SIZE_TOLERANCE_MARGIN 	3 /* pixel */
 #define MIN_FONT_SIZE 			4
+#define FONT_CACHE_MAXENTRIES 		8192
+
+/* fitted point sizes shared by all scaling widgets; the key holds everything the fit depends on,
+ * i.e. the starting font, the available space, the borders, the scale mode and the shape of the text */
+static QHash<QString, double> fontSizeCache;
+/* per font: do all digits have the same advance, so that they can be folded into one shape */
+static QHash<QString, bool> fontTabularDigits;
+
+static bool hasTabularDigits(const QFont &f, const QString &fontKey)
+{
+    QHash<QString, bool>::const_iterator it = fontTabularDigits.constFind(fontKey);
+    if(it != fontTabularDigits.constEnd()) return it.value();
+
+    QFontMetricsF fm(f);
+    bool tabular = true;
+    double w0 = fm.width(QChar('0'));
+    for(char c = '1'; c <= '9'; c++) {
+        if(fm.width(QChar(c)) != w0) {
+            tabular = false;
+            break;
+        }
+    }
+    fontTabularDigits.insert(fontKey, tabular);
+    return tabular;
+}
 
 FontScalingWidget::FontScalingWidget(QWidget *parent)
 {
@@ -70,7 +96,7 @@ void FontScalingWidget::setScaleMode(int mode)
     }
 }
 
-double FontScalingWidget::calculateFontPointSizeF(const QString& text, const QSize &size)
+double FontScalingWidget::measureFontPointSizeF(const QString& text, const QSize &size)
 {
     QTextDocument *textDoc = (QTextDocument *) 0;
     QFontMetrics fmint = d_widget->fontMetrics();
@@ -200,7 +226,7 @@ double FontScalingWidget::calculateFontPointSizeF(const QString& text, const QSi
     return f.pointSizeF();
 }
 
-double FontScalingWidget::calculateVertFontPointSizeF(const QString& text, const QSize &size)
+double FontScalingWidget::measureVertFontPointSizeF(const QString& text, const QSize &size)
 {
     QFontMetrics fmint = d_widget->fontMetrics();
     QFontMetricsF fm(fmint);
@@ -297,6 +323,54 @@ double FontScalingWidget::calculateVertFontPointSizeF(const QString& text, const
     return f.pointSizeF();
 }
 
+/**
+ * returns the text shape used as cache key: when only the height is fitted, only the number of lines matters,
+ * otherwise the text itself with all digits folded to '0' when the font has digits of equal width, so that
+ * a changing numeric value of the same format reuses the size fitted before
+ */
+QString FontScalingWidget::textShape(const QString& text, const QFont &f, const QString &fontKey)
+{
+    if(d_scaleMode != 2) return QString("#%1").arg(text.count("\n") + 1);
+    if(Qt::mightBeRichText(text) || !hasTabularDigits(f, fontKey)) return text;
+
+    QString shape = text;
+    QChar *c = shape.data();
+    for(int i = 0; i < shape.length(); i++) {
+        if(c[i].isDigit()) c[i] = QChar('0');
+    }
+    return shape;
+}
+
+double FontScalingWidget::cachedFontPointSizeF(const QString& text, const QSize &size, bool vertical)
+{
+    QFont f = d_widget->font();
+    QString fontKey = f.toString();
+    QString key = QString("%1|%2|%3x%4|%5|%6|%7|").arg(fontKey).arg(d_scaleMode).arg(size.width()).arg(size.height())
+            .arg(d_lateralBorderWidth).arg(d_botTopBorderWidth).arg(vertical ? 1 : 0);
+    key.append(textShape(text, f, fontKey));
+
+    QHash<QString, double>::const_iterator it = fontSizeCache.constFind(key);
+    if(it != fontSizeCache.constEnd()) return it.value();
+
+    double fontSize;
+    if(vertical) fontSize = measureVertFontPointSizeF(text, size);
+    else fontSize = measureFontPointSizeF(text, size);
+
+    if(fontSizeCache.size() > FONT_CACHE_MAXENTRIES) fontSizeCache.clear();
+    fontSizeCache.insert(key, fontSize);
+    return fontSize;
+}
+
+double FontScalingWidget::calculateFontPointSizeF(const QString& text, const QSize &size)
+{
+    return cachedFontPointSizeF(text, size, false);
+}
+
+double FontScalingWidget::calculateVertFontPointSizeF(const QString& text, const QSize &size)
+{
+    return cachedFontPointSizeF(text, size, true);
+}
+
 void FontScalingWidget::rescaleFont(const QString& text, const QSize &size)
 {
     double fontSize;
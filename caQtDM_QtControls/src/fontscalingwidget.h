@@ -65,6 +65,11 @@ class FontScalingWidget
 	int d_scaleMode;
 	
   private:
+    double measureFontPointSizeF(const QString& text, const QSize & size);
+    double measureVertFontPointSizeF(const QString& text, const QSize & size);
+    double cachedFontPointSizeF(const QString& text, const QSize & size, bool vertical);
+    QString textShape(const QString& text, const QFont &f, const QString &fontKey);
+
     bool d_vertical;
 	double d_lateralBorderWidth;
 	double d_botTopBorderWidth;
@@ -0,0 +1,153 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <QApplication>
+#include <QImageReader>
+#include <QPixmapCache>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QDebug>
+
+#include "imageframecache.h"
+
+// decoded frames are kept up to this size, the scaled pixmaps live in the QPixmapCache
+#define MAXDECODEDBYTES (128 * 1024 * 1024)
+
+typedef struct _decodedImage {
+    QDateTime modified;
+    int generation;
+    QVector<QImage> frames;
+} decodedImage;
+
+// only used from the gui thread, pixmaps can not live anywhere else
+static QHash<QString, decodedImage> decodedImages;
+static qint64 decodedBytes = 0;
+static int decodedGeneration = 0;
+static QMap<int, QTimer *> animationClocks;
+
+static qint64 imageBytes(const decodedImage &image)
+{
+    qint64 bytes = 0;
+    foreach(const QImage &frame, image.frames) bytes += frame.byteCount();
+    return bytes;
+}
+
+/**
+ * decode all frames of a file once, a file changed on disk is decoded again; the generation
+ * is part of the pixmap keys, so the pixmaps of the old contents are never found again
+ */
+static const decodedImage &decodeImage(const QString &fileName, bool revalidate)
+{
+    QHash<QString, decodedImage>::iterator it = decodedImages.find(fileName);
+    QDateTime modified;
+    if(revalidate || it == decodedImages.end()) modified = QFileInfo(fileName).lastModified();
+    if(it != decodedImages.end() && (!revalidate || it.value().modified == modified)) return it.value();
+
+    if(it != decodedImages.end()) {
+        decodedBytes -= imageBytes(it.value());
+        decodedImages.erase(it);
+    }
+
+    decodedImage image;
+    image.modified = modified;
+    image.generation = ++decodedGeneration;
+    QImageReader reader(fileName);
+    do {
+        QImage frame;
+        if(!reader.read(&frame)) break;
+        image.frames.append(frame);
+    } while(reader.canRead());
+    if(image.frames.isEmpty()) qDebug() << "image" << fileName << "could not be decoded:" << reader.errorString();
+
+    qint64 bytes = imageBytes(image);
+    if(decodedBytes + bytes > MAXDECODEDBYTES) {
+        decodedImages.clear();
+        decodedBytes = 0;
+    }
+    decodedBytes += bytes;
+    return decodedImages.insert(fileName, image).value();
+}
+
+int ImageFrameCache::frameCount(const QString &fileName)
+{
+    return decodeImage(fileName, true).frames.count();
+}
+
+QSize ImageFrameCache::frameSize(const QString &fileName)
+{
+    const decodedImage &image = decodeImage(fileName, false);
+    if(image.frames.isEmpty()) return QSize();
+    return image.frames.at(0).size();
+}
+
+/**
+ * a frame scaled to the given size, an invalid size gives the frame in its own size; the pixmaps
+ * of sizes no longer used, f.ex. while a window is resized, are evicted by the QPixmapCache
+ */
+QPixmap ImageFrameCache::frame(const QString &fileName, int frame, const QSize &size)
+{
+    const decodedImage &image = decodeImage(fileName, false);
+    if(frame < 0 || frame >= image.frames.count()) return QPixmap();
+    if(size.isValid() && size.isEmpty()) return QPixmap();
+
+    QString key = QString("ImageFrame_%1_%2x%3_%4_").arg(image.generation).arg(size.width()).arg(size.height()).arg(frame) + fileName;
+    QPixmap pixmap;
+    if(QPixmapCache::find(key, &pixmap)) return pixmap;
+
+    const QImage &decoded = image.frames.at(frame);
+    if(!size.isValid() || size == decoded.size()) {
+        pixmap = QPixmap::fromImage(decoded);
+    } else {
+        pixmap = QPixmap::fromImage(decoded.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+/**
+ * one running timer for every animation delay in use
+ */
+QTimer *ImageFrameCache::animationClock(int delay)
+{
+    QTimer *clock = animationClocks.value(delay, (QTimer *) 0);
+    if(clock == (QTimer *) 0) {
+        clock = new QTimer(qApp);
+        clock->start(delay);
+        animationClocks.insert(delay, clock);
+    }
+    return clock;
+}
+
+/**
+ * forget all decoded images, f.ex. when the displays are reloaded
+ */
+void ImageFrameCache::clear()
+{
+    decodedImages.clear();
+    decodedBytes = 0;
+}
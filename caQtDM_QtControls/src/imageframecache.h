@@ -0,0 +1,50 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef IMAGEFRAMECACHE_H
+#define IMAGEFRAMECACHE_H
+
+#include <QString>
+#include <QPixmap>
+#include <QSize>
+#include <QTimer>
+#include <qtcontrols_global.h>
+
+/**
+ * decoded frames of images and animated gifs shared by all widgets of the process; the frames
+ * are kept per resolved file name and scaled once per size, all animations with the same delay
+ * are stepped by the same clock
+ */
+class QTCON_EXPORT ImageFrameCache
+{
+public:
+    static int frameCount(const QString &fileName);
+    static QSize frameSize(const QString &fileName);
+    static QPixmap frame(const QString &fileName, int frame, const QSize &size);
+    static QTimer *animationClock(int delay);
+    static void clear();
+};
+
+#endif
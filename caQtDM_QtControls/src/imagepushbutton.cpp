@@ -24,6 +24,7 @@
  */
 
 #include "imagepushbutton.h"
+#include "imageframecache.h"
 #include <QResizeEvent>
 #include <QPainter>
 
@@ -34,12 +35,12 @@ ImagePushButton::ImagePushButton(const QString & text, const QString& image, QWi
     iconPresent = false;
     invisible = false;
 
-    //  load from the resources
+    //  load from the resources, all buttons with the same image share it
     iconOK = true;
-    QString fileName =  ":/pixmaps/%1";
-    fileName = fileName.arg(image);
-    pixmap = QPixmap(fileName);
-    resize(pixmap.width(), pixmap.height());
+    imageFile =  ":/pixmaps/%1";
+    imageFile = imageFile.arg(image);
+    imageSize = ImageFrameCache::frameSize(imageFile);
+    resize(imageSize.width(), imageSize.height());
 }
 
 void ImagePushButton:: setLabelText(const QString& text) {
@@ -76,11 +77,11 @@ void ImagePushButton::paintEvent( QPaintEvent* event) {
     x=r.x(); y=r.y(); w=r.width(); h=r.height();
 
     if(!invisible) {
-        if(iconPresent && iconOK) {
+        if(iconPresent && iconOK && imageSize.height() > 0) {
+            // scaled to the height and narrowed, the scaled pixmap is kept in the cache
             int hpix = qRound(h * 0.9);
-            QPixmap pixnew1 = pixmap.scaledToHeight(hpix, Qt::SmoothTransformation);
-            int wpix = qRound(pixnew1.width() * 0.85);
-            QPixmap pixnew2 = pixnew1.scaled(wpix, hpix, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            int wpix = qRound(qRound((double) imageSize.width() * hpix / imageSize.height()) * 0.85);
+            QPixmap pixnew2 = ImageFrameCache::frame(imageFile, 0, QSize(wpix, hpix));
             int pixw = pixnew2.width();
             int pixh = pixnew2.height();
             p.drawPixmap( 1, y+h/2-pixh/2, pixnew2);
@@ -49,7 +49,8 @@ private:
    QString myText;
    QString myImage;
    bool iconPresent;
-   QPixmap pixmap;
+   QString imageFile;
+   QSize imageSize;
    bool iconOK;
    bool invisible;
    QColor thisbg, thisfg, thisbc;
@@ -37,56 +37,110 @@
 #  include <unistd.h>
 #endif
 
+// cached files get their http validators (ETag, Last-Modified) in a file with this suffix
+#define CACHEHEADERSUFFIX ".http"
+
 NetworkAccess::NetworkAccess()
 {
     finished = false;
-    manager = new QNetworkAccessManager;
+    notModified = false;
+    manager = sharedManager();
+    pendingReply = (QNetworkReply *) 0;
     eventLoop = new QEventLoop(this);
+    timeoutHelper = new QTimer(this);
+    timeoutHelper->setInterval(3000);
+    timeoutHelper->setSingleShot(true);
+    connect(timeoutHelper, SIGNAL(timeout()), this, SLOT(timeoutL()));
     errorString = "";
     connect(this, SIGNAL(requestFinished()), this, SLOT(downloadFinished()) );
 }
 
+NetworkAccess::~NetworkAccess()
+{
+    if(pendingReply != (QNetworkReply *) 0) {
+        pendingReply->disconnect(this);
+        pendingReply->abort();
+        pendingReply->deleteLater();
+    }
+}
+
+/**
+ * all requests share one access manager, so that connections to the same server are kept and reused
+ */
+QNetworkAccessManager *NetworkAccess::sharedManager()
+{
+    static QNetworkAccessManager *shared = (QNetworkAccessManager *) 0;
+    if(shared == (QNetworkAccessManager *) 0) shared = new QNetworkAccessManager(qApp);
+    return shared;
+}
+
+/**
+ * local path of a downloaded file
+ */
+QString NetworkAccess::cachePath(const QString &file)
+{
+    Specials specials;
+    QString filePath = specials.getStdPath();
+    filePath.append("/");
+    filePath.append(file);
+    return filePath;
+}
+
 void NetworkAccess::timeoutL()
 {
     errorString = tr("networkaccess: http request timeout for %1").arg(downloadUrl.toString());
-    eventLoop->quit();
+    if(pendingReply != (QNetworkReply *) 0) {
+        pendingReply->disconnect(this);
+        pendingReply->abort();
+        pendingReply->deleteLater();
+        pendingReply = (QNetworkReply *) 0;
+    }
+    emit requestFinished();
 }
 
 bool NetworkAccess::requestUrl(const QUrl url, const QString &file)
+{
+    startRequest(url, file);
+    if(pendingReply != (QNetworkReply *) 0) eventLoop->exec();
+
+    if(finished) return true;
+    else return false;
+}
+
+/**
+ * starts a request without waiting for it, requestFinished is emitted when done
+ */
+void NetworkAccess::startRequest(const QUrl url, const QString &file)
 {
     finished = false;
+    notModified = false;
+    errorString = "";
     thisFile = file;
     //printf("caQtDM -- download %s\n", qasc(url.toString()));
     downloadUrl = url;
 
-    QNetworkRequest *request = new QNetworkRequest(url);
+    QNetworkRequest request(url);
 
     //for https we need some configuration (with no verify socket)
 #ifndef CAQTDM_SSL_IGNORE
 #ifndef QT_NO_SSL
     if(url.toString().toUpper().contains("HTTPS")) {
-        QSslConfiguration config = request->sslConfiguration();
+        QSslConfiguration config = request.sslConfiguration();
         config.setPeerVerifyMode(QSslSocket::VerifyNone);
-        request->setSslConfiguration(config);
+        request.setSslConfiguration(config);
     }
 #endif
 #endif
-    //request->setRawHeader("Content-Type", "application/json");
-    //request->setRawHeader("Timeout", "86400");
+    //request.setRawHeader("Content-Type", "application/json");
+    //request.setRawHeader("Timeout", "86400");
 
-    manager->get(*request);
+    // revalidate a file we already have instead of fetching it again
+    if(thisFile.length() > 0) readCacheHeaders(request);
 
-    connect(manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(finishReply(QNetworkReply*)));
+    pendingReply = manager->get(request);
+    connect(pendingReply, SIGNAL(finished()), this, SLOT(replyFinished()));
 
-    finished = false;
-    QTimer *timeoutHelper = new QTimer(this);
-    timeoutHelper->setInterval(3000);
     timeoutHelper->start();
-    connect(timeoutHelper, SIGNAL(timeout()), this, SLOT(timeoutL()));
-    eventLoop->exec();
-
-    if(finished) return true;
-    else return false;
 }
 
 int NetworkAccess::downloadFinished()
@@ -95,11 +149,30 @@ int NetworkAccess::downloadFinished()
     return finished;
 }
 
+void NetworkAccess::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if(reply == (QNetworkReply *) 0 || reply != pendingReply) return;
+    pendingReply = (QNetworkReply *) 0;
+    timeoutHelper->stop();
+    finishReply(reply);
+}
+
 void NetworkAccess::finishReply(QNetworkReply *reply)
 {
     //printf("network reply completed! thisFile=%s\n",  qasc(thisFile));
 
     QVariant status =  reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+
+    // our copy is still valid
+    if(status.toInt() == 304 && thisFile.length() > 0) {
+        notModified = true;
+        finished = true;
+        reply->deleteLater();
+        emit requestFinished();
+        return;
+    }
+
     if(reply->error()) {
         errorString = tr("networkaccess: http status code %1 [%2] for %3").arg(status.toInt()).arg(reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString()).arg(downloadUrl.toString());
         emit requestFinished();
@@ -117,11 +190,10 @@ void NetworkAccess::finishReply(QNetworkReply *reply)
         QString newPath = filePath + "/" + fi.path();
         if(!QDir(newPath).exists()) QDir().mkpath(newPath);
 
-        filePath.append("/");
-        filePath.append(thisFile);
+        filePath = cachePath(thisFile);
 
         QFile file(filePath);
-        if(!file.open(QIODevice::ReadWrite)) {
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
             errorString = tr("networkaccess: %1 could not be opened for write").arg(filePath);
             emit requestFinished();
             reply->deleteLater();
@@ -129,6 +201,7 @@ void NetworkAccess::finishReply(QNetworkReply *reply)
         } else {
             file.write(reply->readAll());
             file.close();
+            writeCacheHeaders(reply, filePath);
         }
 
     }
@@ -137,6 +210,45 @@ void NetworkAccess::finishReply(QNetworkReply *reply)
     emit requestFinished();
 }
 
+/**
+ * sets If-None-Match / If-Modified-Since when the file and its validators are in the local cache
+ */
+void NetworkAccess::readCacheHeaders(QNetworkRequest &request)
+{
+    QString filePath = cachePath(thisFile);
+    if(!QFileInfo(filePath).exists()) return;
+
+    QFile headers(filePath + CACHEHEADERSUFFIX);
+    if(!headers.open(QIODevice::ReadOnly)) return;
+    while(!headers.atEnd()) {
+        QByteArray line = headers.readLine().trimmed();
+        int pos = line.indexOf(':');
+        if(pos < 1) continue;
+        QByteArray name = line.left(pos).trimmed();
+        QByteArray value = line.mid(pos + 1).trimmed();
+        if(value.isEmpty()) continue;
+        if(name == "ETag") request.setRawHeader("If-None-Match", value);
+        else if(name == "Last-Modified") request.setRawHeader("If-Modified-Since", value);
+    }
+    headers.close();
+}
+
+void NetworkAccess::writeCacheHeaders(QNetworkReply *reply, const QString &filePath)
+{
+    QByteArray etag = reply->rawHeader("ETag");
+    QByteArray modified = reply->rawHeader("Last-Modified");
+
+    QFile headers(filePath + CACHEHEADERSUFFIX);
+    if(etag.isEmpty() && modified.isEmpty()) {
+        headers.remove();
+        return;
+    }
+    if(!headers.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+    if(!etag.isEmpty()) headers.write("ETag: " + etag + "\n");
+    if(!modified.isEmpty()) headers.write("Last-Modified: " + modified + "\n");
+    headers.close();
+}
+
 const QString NetworkAccess::lastError()
 {
     return errorString;
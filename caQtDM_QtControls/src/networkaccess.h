@@ -30,6 +30,7 @@
 #include <QNetworkReply>
 #include <QMessageBox>
 #include <QEventLoop>
+#include <QTimer>
 
 class QNetworkAccessManager;
 
@@ -39,25 +40,38 @@ class NetworkAccess:public QObject
 
 public:
     NetworkAccess();
-    ~NetworkAccess(){}
+    ~NetworkAccess();
     bool requestUrl(const QUrl url, const QString &file = QString::null);
+    void startRequest(const QUrl url, const QString &file = QString::null);
+    bool isFinished() const {return finished;}
+    bool isNotModified() const {return notModified;}
     const QString lastError();
 
+    static QString cachePath(const QString &file);
+
 signals:
     void networkError(const QString);
     void requestFinished();
 
 protected slots:
     void finishReply(QNetworkReply*);
+    void replyFinished();
     const QString parseError(QNetworkReply::NetworkError error);
     int downloadFinished();
     void timeoutL();
 
 private:
+    static QNetworkAccessManager *sharedManager();
+    void readCacheHeaders(QNetworkRequest &request);
+    void writeCacheHeaders(QNetworkReply *reply, const QString &filePath);
+
     QNetworkAccessManager *manager;
+    QNetworkReply *pendingReply;
     QEventLoop *eventLoop;
+    QTimer *timeoutHelper;
     QString thisFile;
     int finished;
+    bool notModified;
     QUrl downloadUrl;
     QString errorString;
 };
@@ -0,0 +1,198 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QTimer>
+#include <QXmlStreamReader>
+#include "networkaccess.h"
+#include "networkprefetch.h"
+#include "searchfile.h"
+
+// at most that many downloads at the same time
+#define PREFETCH_MAX_PARALLEL 8
+
+// files revalidated during this session, they are not asked for again
+static QMutex revalidatedMutex;
+static QSet<QString> revalidatedFiles;
+
+NetworkPrefetch::NetworkPrefetch(const QString &url)
+{
+    baseUrl = url;
+    if(baseUrl.endsWith("/")) baseUrl.chop(1);
+    eventLoop = new QEventLoop(this);
+    downloadCount = 0;
+    notModifiedCount = 0;
+}
+
+NetworkPrefetch::~NetworkPrefetch()
+{
+    QHashIterator<NetworkAccess*, prefetchRequest> i(running);
+    while (i.hasNext()) {
+        i.next();
+        i.key()->disconnect(this);
+        i.key()->deleteLater();
+    }
+}
+
+/**
+ * starts to fetch the dependencies of the given (already available) file
+ */
+void NetworkPrefetch::prefetch(const QString &file)
+{
+    seen.insert(file);
+    if(baseUrl.length() > 0) scanFile(file);
+    startRequests();
+    checkFinished();
+}
+
+bool NetworkPrefetch::waitForFinished(int msecs)
+{
+    if(running.isEmpty() && queue.isEmpty()) return true;
+    QTimer::singleShot(msecs, this, SLOT(timeoutL()));
+    eventLoop->exec();
+    return running.isEmpty() && queue.isEmpty();
+}
+
+void NetworkPrefetch::timeoutL()
+{
+    // what is still pending is aborted with this object and downloaded on demand
+    eventLoop->quit();
+}
+
+void NetworkPrefetch::addFile(const QString &file, bool scan)
+{
+    // no macro resolution here, these files are fetched when used
+    if(file.isEmpty() || file.contains("$") || seen.contains(file)) return;
+    seen.insert(file);
+
+    prefetchRequest request;
+    request.file = file;
+    request.scan = scan;
+
+    // only remote files are looked into; a local file and what it includes are found on demand,
+    // so that opening a display does not parse a whole local include tree twice
+    searchFile s(file);
+    QString fileNameFound = s.findFile();
+    if(!fileNameFound.isNull()) {
+        if(QFileInfo(fileNameFound).absoluteFilePath() != QFileInfo(NetworkAccess::cachePath(file)).absoluteFilePath()) return;
+        // revalidated earlier in this session together with its dependencies
+        QMutexLocker locker(&revalidatedMutex);
+        if(revalidatedFiles.contains(file)) return;
+    }
+    queue.append(request);
+}
+
+/**
+ * looks in a ui file for included files, images and related displays
+ */
+void NetworkPrefetch::scanFile(const QString &file)
+{
+    if(!file.endsWith(".ui")) return;
+
+    searchFile s(file);
+    QString fileNameFound = s.findFile();
+    if(fileNameFound.isNull()) return;
+
+    QFile uiFile(fileNameFound);
+    if(!uiFile.open(QIODevice::ReadOnly)) return;
+
+    QXmlStreamReader xml(&uiFile);
+    QStringList widgetClasses;
+    QString property;
+    while(!xml.atEnd()) {
+        xml.readNext();
+        if(xml.isStartElement()) {
+            if(xml.name() == "widget") {
+                widgetClasses.append(xml.attributes().value("class").toString());
+            } else if(xml.name() == "property") {
+                property = xml.attributes().value("name").toString();
+            } else if(xml.name() == "string" && !widgetClasses.isEmpty()) {
+                QString widgetClass = widgetClasses.last();
+                if(property == "filename" && widgetClass == "caInclude") {
+                    QString fileName = xml.readElementText().trimmed();
+                    if(!fileName.contains(".prc")) fileName = fileName.split(".", QString::SkipEmptyParts).value(0).append(".ui");
+                    addFile(fileName, true);
+                } else if(property == "filename" && widgetClass == "caImage") {
+                    addFile(xml.readElementText().trimmed(), false);
+                } else if(property == "files" && widgetClass == "caRelatedDisplay") {
+                    // related displays are fetched, their own dependencies when they are opened
+                    foreach(QString fileName, xml.readElementText().split(";", QString::SkipEmptyParts)) {
+                        fileName = fileName.trimmed();
+                        if(!fileName.contains(".prc")) fileName = fileName.split(".", QString::SkipEmptyParts).value(0).append(".ui");
+                        addFile(fileName, false);
+                    }
+                }
+            }
+        } else if(xml.isEndElement()) {
+            if(xml.name() == "widget" && !widgetClasses.isEmpty()) widgetClasses.removeLast();
+            else if(xml.name() == "property") property = "";
+        }
+    }
+    uiFile.close();
+}
+
+void NetworkPrefetch::startRequests()
+{
+    while(!queue.isEmpty() && running.count() < PREFETCH_MAX_PARALLEL) {
+        prefetchRequest request = queue.takeFirst();
+        NetworkAccess *access = new NetworkAccess();
+        connect(access, SIGNAL(requestFinished()), this, SLOT(requestDone()));
+        running.insert(access, request);
+        access->startRequest(QUrl(baseUrl + "/" + request.file), request.file);
+    }
+}
+
+void NetworkPrefetch::requestDone()
+{
+    NetworkAccess *access = qobject_cast<NetworkAccess *>(sender());
+    if(access == (NetworkAccess *) 0 || !running.contains(access)) return;
+
+    prefetchRequest request = running.take(access);
+    if(access->isFinished()) {
+        if(access->isNotModified()) notModifiedCount++;
+        else downloadCount++;
+        revalidatedMutex.lock();
+        revalidatedFiles.insert(request.file);
+        revalidatedMutex.unlock();
+        searchFile::invalidateCache(request.file);
+        if(request.scan) scanFile(request.file);
+    } else {
+        errorList.append(access->lastError());
+    }
+    access->deleteLater();
+
+    startRequests();
+    checkFinished();
+}
+
+void NetworkPrefetch::checkFinished()
+{
+    if(running.isEmpty() && queue.isEmpty()) {
+        eventLoop->quit();
+        emit finished();
+    }
+}
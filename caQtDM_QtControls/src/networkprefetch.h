@@ -0,0 +1,84 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef NETWORKPREFETCH_H
+#define NETWORKPREFETCH_H
+
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QEventLoop>
+#include <QUrl>
+
+class NetworkAccess;
+
+/**
+ * downloads the includes, images and related displays of a display file in parallel;
+ * files already in the download cache are revalidated with a conditional request
+ */
+class NetworkPrefetch:public QObject
+{
+    Q_OBJECT
+
+public:
+    NetworkPrefetch(const QString &url);
+    ~NetworkPrefetch();
+    void prefetch(const QString &file);
+    bool waitForFinished(int msecs);
+    const QStringList &errors() const {return errorList;}
+    int downloaded() const {return downloadCount;}
+    int notModified() const {return notModifiedCount;}
+    int pending() const {return running.count() + queue.count();}
+
+signals:
+    void finished();
+
+private slots:
+    void requestDone();
+    void timeoutL();
+
+private:
+    typedef struct _prefetchRequest {
+        QString file;
+        bool scan;
+    } prefetchRequest;
+
+    void addFile(const QString &file, bool scan);
+    void scanFile(const QString &file);
+    void startRequests();
+    void checkFinished();
+
+    QString baseUrl;
+    QList<prefetchRequest> queue;
+    QSet<QString> seen;
+    QHash<NetworkAccess*, prefetchRequest> running;
+    QStringList errorList;
+    QEventLoop *eventLoop;
+    int downloadCount;
+    int notModifiedCount;
+};
+
+#endif
@@ -25,6 +25,89 @@
 
 #include "searchfile.h"
 #include "pathdefinitions.h"
+#include <QDir>
+#include <QSet>
+#include <QHash>
+#include <QMutex>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+// the display path directories are checked for modifications at most every 2 seconds
+#define SEARCHFILE_VALIDATE_MS 2000
+
+/*
+ * process wide cache of resolved file names, shared by all searchFile objects;
+ * names not found are cached as an empty string. Only simple names are cached, the
+ * modification times of the searched directories tell when they were added or removed;
+ * names with a directory part are looked up in subdirectories we do not watch
+ */
+typedef struct _searchDirectory {
+    QString path;
+    QDateTime modified;
+    bool indexed;
+    QSet<QString> entries;
+} searchDirectory;
+
+static QMutex searchMutex;
+static QString searchPathEnv;
+static QString searchCurrentDir;
+static QList<searchDirectory> searchDirectories;
+static QHash<QString, QString> searchCache;
+static QElapsedTimer searchValidated;
+
+static void indexDirectory(searchDirectory &dir, bool useIndex)
+{
+    QFileInfo fi(dir.path);
+    dir.modified = fi.lastModified();
+    dir.entries.clear();
+    dir.indexed = useIndex && fi.isDir();
+    if(dir.indexed) {
+        QDir directory(dir.path);
+        foreach(QString entry, directory.entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System)) {
+            dir.entries.insert(entry);
+        }
+    }
+}
+
+// must be called with searchMutex locked
+static void validateSearchCache()
+{
+    QString path = (QString) qgetenv("CAQTDM_DISPLAY_PATH");
+    QString current = QDir::currentPath();
+    bool useIndex = !qgetenv("CAQTDM_DISPLAY_PATH_INDEX").isEmpty();
+
+    // display path or current directory changed, rebuild everything
+    if(!searchValidated.isValid() || path != searchPathEnv || current != searchCurrentDir) {
+        searchPathEnv = path;
+        searchCurrentDir = current;
+        searchDirectories.clear();
+        searchCache.clear();
+
+        searchDirectory dir;
+        dir.path = current;
+        indexDirectory(dir, false);
+        searchDirectories.append(dir);
+        foreach(QString entry, path.split(pathSeparator)) {
+            dir.path = entry;
+            indexDirectory(dir, useIndex);
+            searchDirectories.append(dir);
+        }
+        searchValidated.start();
+        return;
+    }
+
+    if(searchValidated.elapsed() < SEARCHFILE_VALIDATE_MS) return;
+
+    // files were added or removed in a directory, forget what we know
+    for(int i=0; i < searchDirectories.count(); i++) {
+        searchDirectory &dir = searchDirectories[i];
+        if(QFileInfo(dir.path).lastModified() != dir.modified) {
+            indexDirectory(dir, useIndex && (i > 0));
+            searchCache.clear();
+        }
+    }
+    searchValidated.start();
+}
 
 searchFile::searchFile(QString filename)
 {
@@ -35,8 +118,24 @@ QString searchFile::findFile()
 {
     if(_FileName.isNull()) return NULL;
 
-    QString path = (QString) qgetenv("CAQTDM_DISPLAY_PATH");
-    QStringList paths = path.split(pathSeparator);
+    // absolute names are not searched in the display path
+    if(QDir::isAbsolutePath(_FileName)) {
+        QFileInfo fi(_FileName);
+        if(fi.exists()) return _FileName;
+        else return NULL;
+    }
+
+    QMutexLocker locker(&searchMutex);
+    validateSearchCache();
+
+    bool simpleName = !_FileName.contains("/") && !_FileName.contains("\\");
+    if(simpleName) {
+        QHash<QString, QString>::const_iterator it = searchCache.constFind(_FileName);
+        if(it != searchCache.constEnd()) {
+            if(it.value().isEmpty()) return NULL;
+            else return it.value();
+        }
+    }
 
     // first search in current directory
     QString FileName = _FileName;
@@ -45,13 +144,16 @@ QString searchFile::findFile()
 
     // file was not found, go through path list
     if(!fi.exists()) {
-       for(int i=0; i< paths.count(); i++) {
-           FileName = paths[i] + "/" + _FileName;
-           QFileInfo fin(FileName);
-           if(fin.exists()) {
-             fileFound = true;
-             break;
+       for(int i=1; i< searchDirectories.count(); i++) {
+           const searchDirectory &dir = searchDirectories.at(i);
+           FileName = dir.path + "/" + _FileName;
+           if(dir.indexed && simpleName) {
+               fileFound = dir.entries.contains(_FileName);
+           } else {
+               QFileInfo fin(FileName);
+               fileFound = fin.exists();
            }
+           if(fileFound) break;
         }
 
     // file was found in current directory
@@ -62,12 +164,35 @@ QString searchFile::findFile()
     // return filename or null
     if(fileFound) {
         //printf("searchFile -- %s\n", qasc(FileName));
+        if(simpleName) searchCache.insert(_FileName, FileName);
         return FileName;
     }
-    else return NULL;
+    else {
+        if(simpleName) searchCache.insert(_FileName, QString(""));
+        return NULL;
+    }
 }
 
 QString searchFile::displayPath()
 {
     return (QString)  qgetenv("CAQTDM_DISPLAY_PATH");
 }
+
+/**
+ * forget a cached resolution (or all of them), f.ex. after a file was downloaded
+ */
+void searchFile::invalidateCache(const QString &fileName)
+{
+    QMutexLocker locker(&searchMutex);
+    if(fileName.isEmpty()) {
+        searchCache.clear();
+        searchValidated.invalidate();
+    } else {
+        searchCache.remove(fileName);
+        // a downloaded file may land in an indexed directory
+        for(int i=1; i < searchDirectories.count(); i++) {
+            searchDirectory &dir = searchDirectories[i];
+            if(dir.indexed && QFileInfo(dir.path + "/" + fileName).exists()) dir.entries.insert(fileName);
+        }
+    }
+}
@@ -38,6 +38,8 @@ public:
     QString findFile();
     QString displayPath();
 
+    static void invalidateCache(const QString &fileName = QString());
+
 private:
     QString _FileName;
 };
@@ -0,0 +1,299 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#if defined(_MSC_VER)
+#define snprintf _snprintf
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <qnumeric.h>
+#include "valueformatter.h"
+
+/* below this magnitude the scaled value is exact to far better than the tie guard, so the
+ * direct conversion rounds exactly like printf does; near a tie printf has the last word */
+#define FIXED_FAST_LIMIT        1.0e12
+#define FIXED_TIE_GUARD         1.0e-3
+#define FIXED_FAST_PRECISION    9
+
+#define SEXA_PI 3.14159265358979323846
+
+static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17};
+
+static int printed(char *buf, int size, int len)
+{
+    buf[size - 1] = '\0';
+    if(len < 0 || len >= size) return (int) strlen(buf);
+    return len;
+}
+
+/* writes n in the given base with at least minDigits digits and returns the number of characters */
+static int unsignedToText(unsigned long long n, unsigned int base, int minDigits, char *buf)
+{
+    char tmp[72];
+    int len = 0;
+    do {
+        unsigned int digit = (unsigned int) (n % base);
+        tmp[len++] = (char) (digit < 10 ? '0' + digit : 'a' + digit - 10);
+        n /= base;
+    } while(n != 0);
+    while(len < minDigits) tmp[len++] = '0';
+    for(int i = 0; i < len; i++) buf[i] = tmp[len - 1 - i];
+    return len;
+}
+
+static int signedToText(long long n, char *buf)
+{
+    if(n < 0) {
+        buf[0] = '-';
+        return unsignedToText(0ULL - (unsigned long long) n, 10, 1, buf + 1) + 1;
+    }
+    return unsignedToText((unsigned long long) n, 10, 1, buf);
+}
+
+ValueFormatter::ValueFormatter()
+{
+    setFormat(Fixed, 0);
+}
+
+void ValueFormatter::setFormat(Kind kind, int precision, const char *userFormat)
+{
+    if(precision > 17) precision = 17;
+    if(precision < -17) precision = -17;
+    d_kind = kind;
+    d_precision = qAbs(precision);
+    d_format[0] = '\0';
+
+    switch (kind) {
+    case Fixed:
+        if(precision < 0) {
+            d_kind = Exponential;
+            snprintf(d_format, MAX_STRING_LENGTH, "%%.%de", d_precision);
+        }
+        break;
+    case Compact:
+    case Exponential:
+        snprintf(d_format, MAX_STRING_LENGTH, "%%.%de", d_precision);
+        break;
+    case UserDefined:
+        if(userFormat != (const char *) 0) {
+            strncpy(d_format, userFormat, MAX_STRING_LENGTH - 1);
+            d_format[MAX_STRING_LENGTH - 1] = '\0';
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int ValueFormatter::format(double value, bool longIntegers, char *buf, int size) const
+{
+    int len = 0;
+
+    if(size <= 0) return 0;
+    if(size < 64) {
+        char tmp[MAX_STRING_LENGTH];
+        len = format(value, longIntegers, tmp, MAX_STRING_LENGTH);
+        strncpy(buf, tmp, size - 1);
+        buf[size - 1] = '\0';
+        return qMin(len, size - 1);
+    }
+
+    if(qIsNaN(value)) return printed(buf, size, snprintf(buf, size, "nan"));
+
+    switch (d_kind) {
+    case Fixed:
+        return formatFixed(value, d_precision, buf, size);
+
+    case Compact:
+        if ((value < 1.e4 && value > 1.e-4) || (value > -1.e4 && value < -1.e-4) || value == 0.0) {
+            return formatFixed(value, d_precision, buf, size);
+        }
+        return printed(buf, size, snprintf(buf, size, d_format, value));
+
+    case Exponential:
+        return printed(buf, size, snprintf(buf, size, d_format, value));
+
+    case Engineering:
+        return formatEngineering(value, buf, size);
+
+    case Truncated:
+        if(longIntegers) len = signedToText((long long) value, buf);
+        else len = signedToText((int) value, buf);
+        break;
+
+    case UTruncated:
+        if(longIntegers) len = unsignedToText((unsigned long long) value, 10, 1, buf);
+        else len = unsignedToText((uint) value, 10, 1, buf);
+        break;
+
+    case Hexadecimal:
+        buf[0] = '0';
+        buf[1] = 'x';
+        if(longIntegers) len = unsignedToText((unsigned long long) (long long) value, 16, 1, buf + 2) + 2;
+        else len = unsignedToText((uint) (int) value, 16, 1, buf + 2) + 2;
+        break;
+
+    case Octal:
+        buf[0] = 'O';
+        if(longIntegers) len = unsignedToText((unsigned long long) (long long) value, 8, 1, buf + 1) + 1;
+        else len = unsignedToText((uint) (int) value, 8, 1, buf + 1) + 1;
+        break;
+
+    case Sexagesimal:
+    case SexagesimalHMS:
+    case SexagesimalDMS:
+        return formatSexagesimal(value, buf, size);
+
+    case UserDefined:
+        if(longIntegers) return printed(buf, size, snprintf(buf, size, d_format, (long long) value));
+        return printed(buf, size, snprintf(buf, size, d_format, (int) value));
+    }
+
+    buf[len] = '\0';
+    return len;
+}
+
+bool ValueFormatter::sameText(const QString &text, const char *value, int len, const QString *units)
+{
+    int size = len;
+    if(units != (const QString *) 0) size += units->size() + 1;
+    if(text.size() != size) return false;
+
+    const QChar *c = text.constData();
+    for(int i = 0; i < len; i++) {
+        if(c[i] != QLatin1Char(value[i])) return false;
+    }
+    if(units == (const QString *) 0) return true;
+    if(c[len] != QLatin1Char(' ')) return false;
+    return memcmp(c + len + 1, units->constData(), units->size() * sizeof(QChar)) == 0;
+}
+
+int ValueFormatter::formatFixed(double value, int precision, char *buf, int size) const
+{
+    if(precision <= FIXED_FAST_PRECISION) {
+        double scaled = fabs(value) * powersOf10[precision];
+        if(scaled < FIXED_FAST_LIMIT) {
+            double integral = floor(scaled);
+            double fraction = scaled - integral;
+            if(fabs(fraction - 0.5) > FIXED_TIE_GUARD) {
+                unsigned long long n = (unsigned long long) integral;
+                unsigned long long divisor = (unsigned long long) powersOf10[precision];
+                int len = 0;
+                if(fraction > 0.5) n++;
+                // printf keeps the sign of values rounding to zero and of -0.0
+                if(value < 0.0 || (value == 0.0 && 1.0 / value < 0.0)) buf[len++] = '-';
+                len += unsignedToText(n / divisor, 10, 1, buf + len);
+                if(precision > 0) {
+                    buf[len++] = '.';
+                    len += unsignedToText(n % divisor, 10, precision, buf + len);
+                }
+                buf[len] = '\0';
+                return len;
+            }
+        }
+    }
+    return printed(buf, size, snprintf(buf, size, "%.*f", precision, value));
+}
+
+/* mantissa between 1 and 999 with the exponent a multiple of three, e.g. 12.35e+03 */
+int ValueFormatter::formatEngineering(double value, char *buf, int size) const
+{
+    double absValue = fabs(value);
+    int exponent = 0;
+    int len = 0;
+
+    if(qIsInf(value)) return printed(buf, size, snprintf(buf, size, "%e", value));
+
+    if(absValue != 0.0) {
+        exponent = (int) floor(log10(absValue));
+        if(exponent >= 0) exponent = (exponent / 3) * 3;
+        else exponent = -(((-exponent) + 2) / 3) * 3;
+        absValue = absValue / pow(10.0, exponent);
+        // rounding to the precision must not give a mantissa of 1000
+        if(absValue >= 1000.0 - 0.5 / powersOf10[d_precision]) {
+            absValue /= 1000.0;
+            exponent += 3;
+        }
+    }
+
+    if(value < 0.0) buf[len++] = '-';
+    len += formatFixed(absValue, d_precision, buf + len, size - len - 8);
+    buf[len++] = 'e';
+    buf[len++] = exponent < 0 ? '-' : '+';
+    len += unsignedToText((unsigned long long) qAbs(exponent), 10, 2, buf + len);
+    buf[len] = '\0';
+    return len;
+}
+
+/**
+ * degrees (or hours) with minutes and seconds; precision 0 gives d, 1 gives d:mm, 2 gives d:mm:ss
+ * and higher precisions add decimals to the seconds. For hms and dms the value is in radians.
+ */
+int ValueFormatter::formatSexagesimal(double value, char *buf, int size) const
+{
+    double x = value;
+    int precision = qMin(d_precision, 11);
+    int len = 0;
+
+    if(d_kind == SexagesimalHMS) x = value * 12.0 / SEXA_PI;
+    else if(d_kind == SexagesimalDMS) x = value * 180.0 / SEXA_PI;
+
+    double scale;
+    if(precision == 0) scale = 1.0;
+    else if(precision == 1) scale = 60.0;
+    else scale = 3600.0 * powersOf10[precision - 2];
+
+    double scaled = floor(fabs(x) * scale + 0.5);
+    if(!(scaled < 9.0e15)) return printed(buf, size, snprintf(buf, size, "%.*f", precision, x));
+
+    unsigned long long n = (unsigned long long) scaled;
+    if(x < 0.0 && n > 0) buf[len++] = '-';
+
+    if(precision == 0) {
+        len += unsignedToText(n, 10, 1, buf + len);
+    } else if(precision == 1) {
+        len += unsignedToText(n / 60, 10, 1, buf + len);
+        buf[len++] = ':';
+        len += unsignedToText(n % 60, 10, 2, buf + len);
+    } else {
+        unsigned long long fraction = (unsigned long long) powersOf10[precision - 2];
+        unsigned long long seconds = n % (60 * fraction);
+        unsigned long long minutes = n / (60 * fraction);
+        len += unsignedToText(minutes / 60, 10, 1, buf + len);
+        buf[len++] = ':';
+        len += unsignedToText(minutes % 60, 10, 2, buf + len);
+        buf[len++] = ':';
+        len += unsignedToText(seconds / fraction, 10, 2, buf + len);
+        if(precision > 2) {
+            buf[len++] = '.';
+            len += unsignedToText(seconds % fraction, 10, precision - 2, buf + len);
+        }
+    }
+    buf[len] = '\0';
+    return len;
+}
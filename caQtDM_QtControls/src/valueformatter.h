@@ -0,0 +1,81 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef VALUEFORMATTER_H
+#define VALUEFORMATTER_H
+
+#include <QString>
+#include <qtcontrols_global.h>
+
+/** \brief formats a numeric value into a caller supplied buffer without allocating memory
+ *
+ * The buffer should hold at least 64 characters, smaller buffers get a truncated text.
+ * The format is compiled once from format type and precision with setFormat(); format() then only
+ * has to convert the value. Fixed point and integer representations are converted directly, the
+ * result is identical to the one of the corresponding printf format; exponential and user defined
+ * formats still go through snprintf with the compiled format.
+ */
+class QTCON_EXPORT ValueFormatter
+{
+public:
+    enum Kind {Fixed, Exponential, Compact, Engineering, Truncated, UTruncated, Hexadecimal, Octal,
+               Sexagesimal, SexagesimalHMS, SexagesimalDMS, UserDefined};
+
+    ValueFormatter();
+
+    /** \brief compiles the format
+     *
+     * @param kind the representation
+     * @param precision number of decimals; a negative precision with Fixed gives an exponential format
+     * @param userFormat printf format used with UserDefined, it gets the value as integer
+     */
+    void setFormat(Kind kind, int precision, const char *userFormat = 0);
+
+    /** \brief formats the value into buf and returns the length of the text
+     *
+     * @param longIntegers integer representations convert the value to long long instead of int
+     */
+    int format(double value, bool longIntegers, char *buf, int size) const;
+
+    /** \brief tells without building a QString whether text already shows the formatted value
+     *
+     * @param units when given, the text is expected to be the value, a blank and the units
+     */
+    static bool sameText(const QString &text, const char *value, int len, const QString *units = 0);
+
+    Kind kind() const { return d_kind; }
+    int precision() const { return d_precision; }
+
+private:
+    int formatFixed(double value, int precision, char *buf, int size) const;
+    int formatEngineering(double value, char *buf, int size) const;
+    int formatSexagesimal(double value, char *buf, int size) const;
+
+    Kind d_kind;
+    int d_precision;
+    char d_format[MAX_STRING_LENGTH];
+};
+
+#endif
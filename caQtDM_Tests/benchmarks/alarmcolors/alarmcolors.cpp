@@ -0,0 +1,138 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+/*
+ * toggles the alarm severity of many caLineEdit and caLabel widgets and reports the time
+ * until the window is repainted, as during a beam trip where all monitors change severity at once
+ *
+ *   alarmcolors [-widgets 1000] [-frames 40] [-stylesheet]
+ *
+ * -stylesheet sets the alarm colors with a stylesheet per widget for comparison
+ */
+
+#include <QApplication>
+#include <QWidget>
+#include <QGridLayout>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include "calineedit.h"
+#include "calabel.h"
+#include "alarmdefs.h"
+
+static const short severities[] = {NO_ALARM, MINOR_ALARM, MAJOR_ALARM, INVALID_ALARM};
+
+static QColor severityColor(short severity)
+{
+    switch(severity) {
+    case NO_ALARM: return QColor(0, 205, 0);
+    case MINOR_ALARM: return QColor(255, 255, 0);
+    case MAJOR_ALARM: return QColor(255, 0, 0);
+    default: return QColor(255, 255, 255);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    int widgets = 1000;
+    int frames = 40;
+    bool stylesheet = false;
+
+    QStringList args = app.arguments();
+    for(int i=1; i < args.count(); i++) {
+        if(args.at(i) == "-widgets" && i+1 < args.count()) widgets = args.at(++i).toInt();
+        else if(args.at(i) == "-frames" && i+1 < args.count()) frames = args.at(++i).toInt();
+        else if(args.at(i) == "-stylesheet") stylesheet = true;
+    }
+    if(widgets < 2 || frames < 1) {
+        printf("usage: alarmcolors [-widgets n] [-frames n] [-stylesheet]\n");
+        return 1;
+    }
+
+    // half text monitors, half labels
+    QWidget window;
+    QGridLayout *layout = new QGridLayout(&window);
+    layout->setSpacing(1);
+    int columns = 40;
+    QVector<caLineEdit*> lineEdits;
+    QVector<caLabel*> labels;
+    for(int i=0; i < widgets; i++) {
+        QWidget *w;
+        if(i % 2 == 0) {
+            caLineEdit *lineEdit = new caLineEdit(&window);
+            lineEdit->setColorMode(caLineEdit::Alarm_Default);
+            lineEdit->setText(QString::number(i * 0.5, 'f', 2));
+            lineEdits.append(lineEdit);
+            w = lineEdit;
+        } else {
+            caLabel *label = new caLabel(&window);
+            label->setColorMode(caLabel::Alarm);
+            label->setText("alarm");
+            labels.append(label);
+            w = label;
+        }
+        w->setMinimumSize(30, 14);
+        layout->addWidget(w, i / columns, i % columns);
+    }
+    window.show();
+    app.processEvents();
+    window.repaint();
+
+    QVector<double> times;
+    QColor bg = QColor(160, 160, 164);
+    QColor fg = Qt::black;
+    for(int frame=0; frame < frames; frame++) {
+        short severity = severities[frame % 4];
+        QColor c = severityColor(severity);
+        QString style = QString("color: rgb(%1, %2, %3);").arg(c.red()).arg(c.green()).arg(c.blue());
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int i=0; i < lineEdits.count(); i++) {
+            if(stylesheet) lineEdits[i]->setStyleSheet(style);
+            else lineEdits[i]->setAlarmColors(severity, 0.0, bg, fg);
+        }
+        for(int i=0; i < labels.count(); i++) {
+            if(stylesheet) labels[i]->setStyleSheet(style);
+            else labels[i]->setAlarmColors(severity);
+        }
+        app.processEvents();
+        window.repaint();
+        times.append(timer.nsecsElapsed() / 1.0e6);
+    }
+
+    std::sort(times.begin(), times.end());
+    double sum = 0.0;
+    for(int i=0; i < times.count(); i++) sum += times.at(i);
+    printf("%d widgets (%d caLineEdit, %d caLabel), %d frames, colors by %s\n", widgets, lineEdits.count(), labels.count(),
+           frames, stylesheet ? "stylesheet" : "palette");
+    printf("frame time [ms]: min %.2f  median %.2f  mean %.2f  max %.2f\n", times.first(), times.at(times.count() / 2),
+           sum / times.count(), times.last());
+    return 0;
+}
@@ -0,0 +1,19 @@
+# benchmark of alarm color changes on caLineEdit and caLabel, built on its own against the qtcontrols library:
+#   qmake alarmcolors.pro && make && ./alarmcolors -widgets 1000 -frames 40
+#   ./alarmcolors -stylesheet      (colors set by a stylesheet per widget, for comparison)
+
+include(../../../caQtDM_Viewer/qtdefs.pri)
+
+TEMPLATE = app
+TARGET = alarmcolors
+CONFIG += console qwt
+CONFIG -= app_bundle
+contains(QT_VER_MAJ, 5) {
+   QT += widgets
+}
+
+INCLUDEPATH += ../../../caQtDM_QtControls/src
+INCLUDEPATH += ../../../caQtDM_Lib/src
+LIBS += -L$(CAQTDM_COLLECT) -Wl,-rpath,$(CAQTDM_COLLECT) -lqtcontrols
+
+SOURCES += alarmcolors.cpp
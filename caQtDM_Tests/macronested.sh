@@ -0,0 +1 @@
+caQtDM -macro "N=1,DEV1=ACM:BPM1,SIG=X,IDX1=2,PRE2=deep" macronested
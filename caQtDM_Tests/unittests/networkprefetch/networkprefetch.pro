@@ -0,0 +1,18 @@
+# test of the parallel prefetch of display dependencies, built on its own:
+#   qmake networkprefetch.pro && make && ./tst_networkprefetch -platform offscreen
+
+TEMPLATE = app
+TARGET = tst_networkprefetch
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+lessThan(QT_MAJOR_VERSION, 5) {
+   error("this test needs Qt5 or later")
+}
+QT += network widgets testlib
+
+CONTROLS = ../../../caQtDM_QtControls/src
+INCLUDEPATH += $$CONTROLS
+
+HEADERS += $$CONTROLS/networkaccess.h $$CONTROLS/networkprefetch.h $$CONTROLS/searchfile.h
+SOURCES += tst_networkprefetch.cpp $$CONTROLS/networkaccess.cpp $$CONTROLS/networkprefetch.cpp $$CONTROLS/searchfile.cpp
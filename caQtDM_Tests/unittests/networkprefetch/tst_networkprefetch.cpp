@@ -0,0 +1,300 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+/*
+ * checks the parallel prefetch of display dependencies and the revalidation of cached files
+ * against a small http server running in this process
+ */
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QDir>
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "networkprefetch.h"
+#include "searchfile.h"
+
+static QByteArray uiFile(const QString &widgets)
+{
+    return QString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<ui version=\"4.0\">\n"
+                   "<widget class=\"QWidget\" name=\"Form\">\n%1</widget>\n</ui>\n").arg(widgets).toUtf8();
+}
+
+static QString includeWidget(const QString &name, const QString &file)
+{
+    return QString("<widget class=\"caInclude\" name=\"%1\"><property name=\"filename\"><string>%2</string></property></widget>\n").arg(name).arg(file);
+}
+
+static QString imageWidget(const QString &name, const QString &file)
+{
+    return QString("<widget class=\"caImage\" name=\"%1\"><property name=\"filename\"><string>%2</string></property></widget>\n").arg(name).arg(file);
+}
+
+static QString relatedWidget(const QString &name, const QString &files)
+{
+    return QString("<widget class=\"caRelatedDisplay\" name=\"%1\"><property name=\"files\"><string>%2</string></property></widget>\n").arg(name).arg(files);
+}
+
+class HttpStandIn;
+
+/**
+ * one http/1.0 style exchange, the answer is delayed so that requests overlap
+ */
+class HttpConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    HttpConnection(HttpStandIn *server, QTcpSocket *socket);
+
+private slots:
+    void readRequest();
+    void respond();
+
+private:
+    HttpStandIn *thisServer;
+    QPointer<QTcpSocket> thisSocket;
+    QByteArray request;
+    QString path;
+    QByteArray ifNoneMatch;
+};
+
+class HttpStandIn : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    HttpStandIn() {reset();}
+    void reset() {requests = inFlight = maxInFlight = 0; conditionalPaths.clear();}
+
+    QHash<QString, QByteArray> files;
+    QHash<QString, int> delays;
+    int requests;
+    int inFlight;
+    int maxInFlight;
+    QStringList conditionalPaths;
+
+private slots:
+    void acceptConnection() {
+        while(hasPendingConnections()) new HttpConnection(this, nextPendingConnection());
+    }
+
+public:
+    bool start() {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+        return listen(QHostAddress::LocalHost);
+    }
+};
+
+HttpConnection::HttpConnection(HttpStandIn *server, QTcpSocket *socket) : QObject(server)
+{
+    thisServer = server;
+    thisSocket = socket;
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+}
+
+void HttpConnection::readRequest()
+{
+    if(thisSocket.isNull() || !path.isEmpty()) return;
+    request.append(thisSocket->readAll());
+    if(!request.contains("\r\n\r\n")) return;
+
+    QList<QByteArray> lines = request.split('\n');
+    path = QString(lines.at(0).split(' ').value(1));
+    if(path.startsWith("/")) path.remove(0, 1);
+    for(int i=1; i < lines.count(); i++) {
+        QByteArray line = lines.at(i).trimmed();
+        if(line.toLower().startsWith("if-none-match:")) ifNoneMatch = line.mid(14).trimmed();
+    }
+
+    thisServer->requests++;
+    thisServer->inFlight++;
+    thisServer->maxInFlight = qMax(thisServer->maxInFlight, thisServer->inFlight);
+    if(!ifNoneMatch.isEmpty()) thisServer->conditionalPaths.append(path);
+    QTimer::singleShot(thisServer->delays.value(path, 150), this, SLOT(respond()));
+}
+
+void HttpConnection::respond()
+{
+    thisServer->inFlight--;
+    if(!thisSocket.isNull() && thisSocket->state() == QAbstractSocket::ConnectedState) {
+        QByteArray etag = "\"v1\"";
+        QByteArray answer;
+        if(!thisServer->files.contains(path)) {
+            answer = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        } else if(ifNoneMatch == etag) {
+            answer = "HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\nConnection: close\r\n\r\n";
+        } else {
+            QByteArray body = thisServer->files.value(path);
+            answer = "HTTP/1.1 200 OK\r\nETag: " + etag + "\r\nContent-Length: " + QByteArray::number(body.size()) +
+                     "\r\nConnection: close\r\n\r\n" + body;
+        }
+        thisSocket->write(answer);
+        thisSocket->disconnectFromHost();
+    }
+    if(!thisSocket.isNull()) thisSocket->deleteLater();
+    deleteLater();
+}
+
+class tst_NetworkPrefetch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parallelFetch();
+    void revalidatedOncePerSession();
+    void boundedWait();
+    void cleanupTestCase();
+
+private:
+    QString baseDir;
+    QString cacheDir;
+    QString url;
+    HttpStandIn server;
+};
+
+void tst_NetworkPrefetch::initTestCase()
+{
+    // the download cache lives below the temporary directory, give it a fresh one
+    baseDir = QDir::tempPath() + QString("/tst_networkprefetch_%1").arg(QCoreApplication::applicationPid());
+    QDir(baseDir).removeRecursively();
+    QVERIFY(QDir().mkpath(baseDir + "/local"));
+    qputenv("TMPDIR", baseDir.toLocal8Bit());
+    cacheDir = baseDir + "/caQtDM";
+    QVERIFY(QDir().mkpath(cacheDir));
+    qputenv("CAQTDM_DISPLAY_PATH", cacheDir.toLocal8Bit());
+    QDir::setCurrent(baseDir + "/local");
+
+    QVERIFY(server.start());
+    url = QString("http://127.0.0.1:%1/").arg(server.serverPort());
+
+    server.files.insert("inc1.ui", uiFile(includeWidget("deep", "deep.ui")));
+    server.files.insert("inc2.ui", uiFile(""));
+    server.files.insert("deep.ui", uiFile(""));
+    server.files.insert("pic.gif", QByteArray("GIF89a"));
+    server.files.insert("rel1.ui", uiFile(includeWidget("notscanned", "relinc.ui")));
+    server.files.insert("rel2.ui", uiFile(""));
+    server.files.insert("relinc.ui", uiFile(""));
+    server.files.insert("slow.ui", uiFile(""));
+    server.delays.insert("slow.ui", 2000);
+
+    // the top level files are local, as after checkFileAndDownload
+    QFile top("top.ui");
+    QVERIFY(top.open(QIODevice::WriteOnly));
+    top.write(uiFile(includeWidget("i1", "inc1.ui") + includeWidget("i2", "inc2.ui") + imageWidget("p", "pic.gif") +
+                     relatedWidget("r", "rel1.adl;rel2.ui") + includeWidget("m", "$(M).ui")));
+    top.close();
+
+    QFile slow("slowtop.ui");
+    QVERIFY(slow.open(QIODevice::WriteOnly));
+    slow.write(uiFile(includeWidget("s", "slow.ui")));
+    slow.close();
+
+    // inc2.ui was downloaded in an earlier session, it has to be revalidated only
+    QFile cached(cacheDir + "/inc2.ui");
+    QVERIFY(cached.open(QIODevice::WriteOnly));
+    cached.write(server.files.value("inc2.ui"));
+    cached.close();
+    QFile validators(cacheDir + "/inc2.ui.http");
+    QVERIFY(validators.open(QIODevice::WriteOnly));
+    validators.write("ETag: \"v1\"\n");
+    validators.close();
+    searchFile::invalidateCache();
+}
+
+void tst_NetworkPrefetch::parallelFetch()
+{
+    server.reset();
+    NetworkPrefetch prefetch(url);
+    QElapsedTimer timer;
+    timer.start();
+    prefetch.prefetch("top.ui");
+    QVERIFY(prefetch.waitForFinished(5000));
+    int elapsed = timer.elapsed();
+
+    QVERIFY2(prefetch.errors().isEmpty(), qPrintable(prefetch.errors().join("\n")));
+
+    // inc1, deep, pic, rel1, rel2 downloaded, inc2 answered with 304; related displays are not scanned
+    QCOMPARE(prefetch.downloaded(), 5);
+    QCOMPARE(prefetch.notModified(), 1);
+    QCOMPARE(server.requests, 6);
+    QCOMPARE(server.conditionalPaths, QStringList() << "inc2.ui");
+    QVERIFY(!QFile::exists(cacheDir + "/relinc.ui"));
+
+    // requests overlap, far less than six times the answer delay
+    QVERIFY2(server.maxInFlight > 1, qPrintable(QString("at most %1 request in flight").arg(server.maxInFlight)));
+    QVERIFY2(elapsed < 6 * 150, qPrintable(QString("prefetch took %1 ms").arg(elapsed)));
+
+    foreach(QString file, QStringList() << "inc1.ui" << "deep.ui" << "pic.gif" << "rel1.ui" << "rel2.ui") {
+        QFile downloaded(cacheDir + "/" + file);
+        QVERIFY2(downloaded.open(QIODevice::ReadOnly), qPrintable(file));
+        QCOMPARE(downloaded.readAll(), server.files.value(file));
+        QVERIFY(QFile::exists(cacheDir + "/" + file + ".http"));
+    }
+    qDebug() << "prefetch of 6 files took" << elapsed << "ms with" << server.maxInFlight << "requests in flight";
+}
+
+void tst_NetworkPrefetch::revalidatedOncePerSession()
+{
+    // everything was revalidated above, opening the display again asks the server nothing
+    server.reset();
+    NetworkPrefetch prefetch(url);
+    prefetch.prefetch("top.ui");
+    QVERIFY(prefetch.waitForFinished(5000));
+    QCOMPARE(server.requests, 0);
+    QCOMPARE(prefetch.downloaded() + prefetch.notModified(), 0);
+}
+
+void tst_NetworkPrefetch::boundedWait()
+{
+    // the wait is bounded, what is pending is left to the on demand download
+    server.reset();
+    QElapsedTimer timer;
+    timer.start();
+    {
+        NetworkPrefetch prefetch(url);
+        prefetch.prefetch("slowtop.ui");
+        QVERIFY(!prefetch.waitForFinished(200));
+        QCOMPARE(prefetch.pending(), 1);
+        QVERIFY(prefetch.errors().isEmpty());
+    }
+    QVERIFY(timer.elapsed() < 1500);
+    QVERIFY(!QFile::exists(cacheDir + "/slow.ui"));
+}
+
+void tst_NetworkPrefetch::cleanupTestCase()
+{
+    // let the stand in finish its delayed answers before the directory goes away
+    QTest::qWait(2500);
+    QDir::setCurrent(QDir::rootPath());
+    QDir(baseDir).removeRecursively();
+}
+
+QTEST_MAIN(tst_NetworkPrefetch)
+#include "tst_networkprefetch.moc"
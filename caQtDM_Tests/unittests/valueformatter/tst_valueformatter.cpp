@@ -0,0 +1,342 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+/*
+ * compares ValueFormatter with printf and with the expected engineering and sexagesimal texts,
+ * and measures the fixed point fast path against snprintf "%.Nf":
+ *
+ *   tst_valueformatter                  all comparisons and benchmarks
+ *   tst_valueformatter -iterations 1000 benchmarks with a fixed number of iterations
+ */
+
+#include <QtTest>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "valueformatter.h"
+
+#define BUFSIZE 64
+#define BENCHVALUES 1000
+
+class tst_ValueFormatter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void fixedMatchesPrintf_data();
+    void fixedMatchesPrintf();
+    void fixedSweep();
+    void compactMatchesPrintf();
+    void integers_data();
+    void integers();
+    void engineering_data();
+    void engineering();
+    void engineeringSweep();
+    void sexagesimal_data();
+    void sexagesimal();
+    void smallBuffer();
+
+    void benchFixed_data();
+    void benchFixed();
+    void benchPrintf_data();
+    void benchPrintf();
+    void benchEngineering();
+    void benchSexagesimal();
+
+private:
+    QVector<double> values;
+};
+
+static QString formatted(ValueFormatter::Kind kind, int precision, double value, bool longIntegers = false)
+{
+    ValueFormatter formatter;
+    char buf[BUFSIZE];
+    formatter.setFormat(kind, precision);
+    int len = formatter.format(value, longIntegers, buf, BUFSIZE);
+    if(len != (int) strlen(buf)) return QString("length %1 for %2").arg(len).arg(buf);
+    return QString(buf);
+}
+
+static QString printed(const char *format, int precision, double value)
+{
+    char buf[BUFSIZE];
+    snprintf(buf, BUFSIZE, format, precision, value);
+    return QString(buf);
+}
+
+/* deterministic values over many magnitudes, with both signs */
+static double sweepValue(unsigned int &seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    double mantissa = (double) (seed >> 8) / (double) (1u << 24);
+    seed = seed * 1103515245u + 12345u;
+    int exponent = (int) ((seed >> 16) % 24) - 12;
+    double value = mantissa * pow(10.0, exponent);
+    return (seed & 0x8000) ? -value : value;
+}
+
+void tst_ValueFormatter::initTestCase()
+{
+    unsigned int seed = 4711;
+    for(int i=0; i < BENCHVALUES; i++) values.append(sweepValue(seed) * 1.0e-6);
+}
+
+void tst_ValueFormatter::fixedMatchesPrintf_data()
+{
+    QTest::addColumn<double>("value");
+    QTest::addColumn<int>("precision");
+
+    QTest::newRow("zero") << 0.0 << 3;
+    QTest::newRow("minus zero") << -0.0 << 2;
+    QTest::newRow("minus zero p0") << -0.0 << 0;
+    QTest::newRow("negative to zero") << -0.0004 << 3;
+    QTest::newRow("tie 0.125") << 0.125 << 2;
+    QTest::newRow("tie 0.375") << 0.375 << 2;
+    QTest::newRow("tie 2.5") << 2.5 << 0;
+    QTest::newRow("tie 3.5") << 3.5 << 0;
+    QTest::newRow("tie -0.5") << -0.5 << 0;
+    QTest::newRow("near tie 1.005") << 1.005 << 2;
+    QTest::newRow("near tie 2.675") << 2.675 << 2;
+    QTest::newRow("carry 9.9999") << 9.9999 << 3;
+    QTest::newRow("carry -99.995") << -99.995 << 2;
+    QTest::newRow("small") << 1.0e-7 << 9;
+    QTest::newRow("pi p9") << 3.14159265358979 << 9;
+    QTest::newRow("pi p12") << 3.14159265358979 << 12;
+    QTest::newRow("limit") << 999999.9999 << 6;
+    QTest::newRow("large") << 1.0e13 << 2;
+    QTest::newRow("huge") << -1.0e300 << 1;
+    QTest::newRow("infinity") << (double) INFINITY << 2;
+    QTest::newRow("minus infinity") << (double) -INFINITY << 2;
+}
+
+void tst_ValueFormatter::fixedMatchesPrintf()
+{
+    QFETCH(double, value);
+    QFETCH(int, precision);
+    QCOMPARE(formatted(ValueFormatter::Fixed, precision, value), printed("%.*f", precision, value));
+}
+
+void tst_ValueFormatter::fixedSweep()
+{
+    unsigned int seed = 12345;
+    for(int i=0; i < 200000; i++) {
+        double value = sweepValue(seed);
+        int precision = i % 10;
+        // values rounded to the precision give exact ties at every step
+        if(i % 3 == 0) value = floor(value * pow(10.0, precision + 1)) / pow(10.0, precision + 1);
+        QString ours = formatted(ValueFormatter::Fixed, precision, value);
+        QString reference = printed("%.*f", precision, value);
+        if(ours != reference) {
+            QFAIL(qPrintable(QString("%1 with precision %2: %3 instead of %4").arg(value, 0, 'g', 17).arg(precision).arg(ours).arg(reference)));
+        }
+    }
+}
+
+void tst_ValueFormatter::compactMatchesPrintf()
+{
+    unsigned int seed = 815;
+    for(int i=0; i < 50000; i++) {
+        double value = sweepValue(seed);
+        int precision = i % 6;
+        bool fixed = (value < 1.e4 && value > 1.e-4) || (value > -1.e4 && value < -1.e-4) || value == 0.0;
+        QString reference = printed(fixed ? "%.*f" : "%.*e", precision, value);
+        QCOMPARE(formatted(ValueFormatter::Compact, precision, value), reference);
+    }
+}
+
+void tst_ValueFormatter::integers_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<double>("value");
+    QTest::addColumn<bool>("longIntegers");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("truncated") << (int) ValueFormatter::Truncated << -12.9 << false << "-12";
+    QTest::newRow("truncated long") << (int) ValueFormatter::Truncated << -5.0e12 << true << "-5000000000000";
+    QTest::newRow("unsigned") << (int) ValueFormatter::UTruncated << 4000000000.0 << false << "4000000000";
+    QTest::newRow("hex") << (int) ValueFormatter::Hexadecimal << 255.7 << false << "0xff";
+    QTest::newRow("hex negative") << (int) ValueFormatter::Hexadecimal << -1.0 << false << "0xffffffff";
+    QTest::newRow("hex long") << (int) ValueFormatter::Hexadecimal << 1099511627776.0 << true << "0x10000000000";
+    QTest::newRow("octal") << (int) ValueFormatter::Octal << 8.0 << false << "O10";
+    QTest::newRow("octal zero") << (int) ValueFormatter::Octal << 0.0 << false << "O0";
+}
+
+void tst_ValueFormatter::integers()
+{
+    QFETCH(int, kind);
+    QFETCH(double, value);
+    QFETCH(bool, longIntegers);
+    QFETCH(QString, expected);
+    QCOMPARE(formatted((ValueFormatter::Kind) kind, 0, value, longIntegers), expected);
+}
+
+void tst_ValueFormatter::engineering_data()
+{
+    QTest::addColumn<double>("value");
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("kilo") << 12345.678 << 2 << "12.35e+03";
+    QTest::newRow("micro") << 0.000123 << 3 << "123.000e-06";
+    QTest::newRow("unit") << 1.0 << 2 << "1.00e+00";
+    QTest::newRow("zero") << 0.0 << 2 << "0.00e+00";
+    QTest::newRow("negative") << -1500.0 << 1 << "-1.5e+03";
+    QTest::newRow("rounds up to the next exponent") << 999.9996 << 3 << "1.000e+03";
+    QTest::newRow("stays below") << 999.9994 << 3 << "999.999e+00";
+    QTest::newRow("milli") << 0.001 << 0 << "1e-03";
+    QTest::newRow("giga") << 4.2e9 << 1 << "4.2e+09";
+}
+
+void tst_ValueFormatter::engineering()
+{
+    QFETCH(double, value);
+    QFETCH(int, precision);
+    QFETCH(QString, expected);
+    QCOMPARE(formatted(ValueFormatter::Engineering, precision, value), expected);
+}
+
+/* mantissa from 1 to below 1000, exponent a multiple of three, and the text reads back as the value */
+void tst_ValueFormatter::engineeringSweep()
+{
+    unsigned int seed = 2718;
+    for(int i=0; i < 50000; i++) {
+        double value = sweepValue(seed);
+        if(value == 0.0) continue;
+        int precision = 3 + i % 4;
+        QString text = formatted(ValueFormatter::Engineering, precision, value);
+        int e = text.indexOf('e');
+        QVERIFY2(e > 0, qPrintable(text));
+        double mantissa = fabs(text.left(e).toDouble());
+        int exponent = text.mid(e + 1).toInt();
+        QVERIFY2(exponent % 3 == 0, qPrintable(text));
+        QVERIFY2(mantissa >= 1.0 && mantissa < 1000.0, qPrintable(text));
+        double back = text.toDouble();
+        QVERIFY2(fabs(back - value) <= fabs(value) * 1.0e-3, qPrintable(QString("%1 for %2").arg(text).arg(value, 0, 'g', 17)));
+    }
+}
+
+void tst_ValueFormatter::sexagesimal_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<double>("value");
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("degrees") << (int) ValueFormatter::Sexagesimal << 12.5 << 0 << "13";
+    QTest::newRow("minutes") << (int) ValueFormatter::Sexagesimal << 12.5 << 1 << "12:30";
+    QTest::newRow("seconds") << (int) ValueFormatter::Sexagesimal << 12.5 << 2 << "12:30:00";
+    QTest::newRow("decimals") << (int) ValueFormatter::Sexagesimal << 1.2345 << 4 << "1:14:04.20";
+    QTest::newRow("negative") << (int) ValueFormatter::Sexagesimal << -0.5 << 2 << "-0:30:00";
+    QTest::newRow("rounds to zero") << (int) ValueFormatter::Sexagesimal << -0.0001 << 1 << "0:00";
+    QTest::newRow("carry") << (int) ValueFormatter::Sexagesimal << 1.99999 << 2 << "2:00:00";
+    QTest::newRow("hms") << (int) ValueFormatter::SexagesimalHMS << M_PI << 2 << "12:00:00";
+    QTest::newRow("dms") << (int) ValueFormatter::SexagesimalDMS << M_PI / 2.0 << 3 << "90:00:00.0";
+}
+
+void tst_ValueFormatter::sexagesimal()
+{
+    QFETCH(int, kind);
+    QFETCH(double, value);
+    QFETCH(int, precision);
+    QFETCH(QString, expected);
+    QCOMPARE(formatted((ValueFormatter::Kind) kind, precision, value), expected);
+}
+
+void tst_ValueFormatter::smallBuffer()
+{
+    ValueFormatter formatter;
+    char buf[8];
+    formatter.setFormat(ValueFormatter::Fixed, 2);
+    int len = formatter.format(123456789.0, false, buf, sizeof(buf));
+    QCOMPARE(len, 7);
+    QCOMPARE(QString(buf), QString("1234567"));
+}
+
+void tst_ValueFormatter::benchFixed_data()
+{
+    QTest::addColumn<int>("precision");
+    QTest::newRow("p0") << 0;
+    QTest::newRow("p3") << 3;
+    QTest::newRow("p6") << 6;
+    QTest::newRow("p9") << 9;
+}
+
+void tst_ValueFormatter::benchFixed()
+{
+    QFETCH(int, precision);
+    ValueFormatter formatter;
+    char buf[BUFSIZE];
+    int total = 0;
+    formatter.setFormat(ValueFormatter::Fixed, precision);
+    QBENCHMARK {
+        for(int i=0; i < BENCHVALUES; i++) total += formatter.format(values.at(i), false, buf, BUFSIZE);
+    }
+    QVERIFY(total > 0);
+}
+
+void tst_ValueFormatter::benchPrintf_data()
+{
+    benchFixed_data();
+}
+
+void tst_ValueFormatter::benchPrintf()
+{
+    QFETCH(int, precision);
+    char buf[BUFSIZE];
+    int total = 0;
+    QBENCHMARK {
+        for(int i=0; i < BENCHVALUES; i++) total += snprintf(buf, BUFSIZE, "%.*f", precision, values.at(i));
+    }
+    QVERIFY(total > 0);
+}
+
+void tst_ValueFormatter::benchEngineering()
+{
+    ValueFormatter formatter;
+    char buf[BUFSIZE];
+    int total = 0;
+    formatter.setFormat(ValueFormatter::Engineering, 3);
+    QBENCHMARK {
+        for(int i=0; i < BENCHVALUES; i++) total += formatter.format(values.at(i), false, buf, BUFSIZE);
+    }
+    QVERIFY(total > 0);
+}
+
+void tst_ValueFormatter::benchSexagesimal()
+{
+    ValueFormatter formatter;
+    char buf[BUFSIZE];
+    int total = 0;
+    formatter.setFormat(ValueFormatter::Sexagesimal, 4);
+    QBENCHMARK {
+        for(int i=0; i < BENCHVALUES; i++) total += formatter.format(values.at(i) * 1.0e6, false, buf, BUFSIZE);
+    }
+    QVERIFY(total > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_ValueFormatter)
+#include "tst_valueformatter.moc"
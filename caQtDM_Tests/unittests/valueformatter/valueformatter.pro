@@ -0,0 +1,18 @@
+# comparison of ValueFormatter with printf and benchmark of its fixed point path, built on its own:
+#   qmake valueformatter.pro && make && ./tst_valueformatter
+
+TEMPLATE = app
+TARGET = tst_valueformatter
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+contains(QT_MAJOR_VERSION, 4) {
+   CONFIG += qtestlib
+} else {
+   QT += widgets testlib
+}
+
+CONTROLS = ../../../caQtDM_QtControls/src
+INCLUDEPATH += $$CONTROLS
+
+SOURCES += tst_valueformatter.cpp $$CONTROLS/valueformatter.cpp
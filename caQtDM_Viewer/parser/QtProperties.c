@@ -38,8 +38,6 @@
 #define DEFAULT_FORMAT_WIDTH 6
 #define DEFAULT_FORMAT_PRECISION 2
 
-zOrder zorder[10000];
-int zindex=0;
 
 /*
 static void uppercase(char *str)
@@ -154,11 +152,12 @@ void Qt_writeOpenTag(char *tag, char *typ, char *value)
 
 void Qt_writeCloseTag(char *tag, char *value, int visibilityStatic)
 {
-    if(!strcmp(tag, "widget") && strstr(value, "ca")) {
-        strcpy(zorder[zindex].z, value);
-        zorder[zindex].vis = visibilityStatic;
-        zorder[zindex].indx = zindex;
-        zindex++;
+    if(!strcmp(tag, "widget") && strstr(value, "ca") && parserStatePtr->zindex < MAXZORDER) {
+        zOrder *z = &parserStatePtr->zorder[parserStatePtr->zindex];
+        strcpy(z->z, value);
+        z->vis = visibilityStatic;
+        z->indx = parserStatePtr->zindex;
+        parserStatePtr->zindex++;
     }
     C_writeCloseTag(myParserPtr, tag);
 }
@@ -27,6 +27,8 @@
 #ifndef QTPROPERTIES_H
 #define QTPROPERTIES_H
 
+#include "parser.h"
+
 typedef struct myParser myParser;
 
 typedef char string40[40];
@@ -41,7 +43,8 @@ typedef struct _zOrder {
 
 #define UNUSED(x) (void)(x)
 
-extern myParser* myParserPtr;
+/* the writer of the running conversion */
+#define myParserPtr (parserStatePtr->parser)
 extern myParser* C_Parser(myParser* p, char *strng);
 extern myParser* C_writeOpenTag(myParser* p, char *type, char *cls, char *name );
 extern myParser* C_writeCloseTag(myParser* p, char *type);
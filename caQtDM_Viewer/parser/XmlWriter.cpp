@@ -43,7 +43,6 @@ XmlWriter::XmlWriter( QIODevice *device, QTextCodec *codec )
 
 XmlWriter::~XmlWriter()
 {
-    qDebug() << "xml destructor";
     if ( autoNewLine && !atBeginningOfLine )
 	out << endl;
 }
@@ -0,0 +1,316 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include "parser.h"
+#include "myParser.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QSemaphore>
+#include <QTextStream>
+
+extern "C" int generateFlatFile;
+extern "C" int generateDeviceOnMenus;
+extern "C" int expandText;
+extern "C" int legendsForStripplot;
+
+static QString jsonString(const QString &str)
+{
+    QString s = str;
+    s.replace("\\", "\\\\");
+    s.replace("\"", "\\\"");
+    s.replace("\n", "\\n");
+    s.replace("\t", "\\t");
+    return "\"" + s + "\"";
+}
+
+typedef struct _conversionResult {
+    QString inputFile;
+    QString outputFile;
+    QString status;      // converted, skipped or failed
+    QString message;
+    qint64 msecs;
+} conversionResult;
+
+/*
+ * a conversion gets its own thread, the thread local parser state starts fresh for every file
+ */
+class conversionThread : public QThread
+{
+public:
+    conversionThread(conversionResult *result, QSemaphore *semaphore) : thisResult(result), freeSlots(semaphore) {}
+
+protected:
+    void run() {
+        QElapsedTimer timer;
+        timer.start();
+        if(adlConverter::convertFile(thisResult->inputFile, thisResult->outputFile, false, thisResult->message)) {
+            thisResult->status = "converted";
+        } else {
+            thisResult->status = "failed";
+        }
+        thisResult->msecs = timer.elapsed();
+        freeSlots->release();
+    }
+
+private:
+    conversionResult *thisResult;
+    QSemaphore *freeSlots;
+};
+
+/*
+ * converts all adl files of a directory tree
+ */
+static int convertTree(const QString &bulkDir, const QString &outDir, const QString &summaryFile, int parallel, bool force)
+{
+    QList<conversionResult> results;
+    QDir inputDir(bulkDir);
+    QElapsedTimer total;
+    total.start();
+
+    QDirIterator it(bulkDir, QStringList("*.adl"), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        conversionResult result;
+        result.inputFile = it.next();
+        result.msecs = 0;
+
+        QString relative = inputDir.relativeFilePath(result.inputFile);
+        relative.chop(4);
+        relative.append(".ui");
+        if(outDir.length() > 0) {
+            result.outputFile = outDir + "/" + relative;
+        } else {
+            result.outputFile = bulkDir + "/" + relative;
+        }
+        results.append(result);
+    }
+
+    printf("adl2ui -- %d files found in %s, %d conversions in parallel\n", results.count(), bulkDir.toLatin1().constData(), parallel);
+
+    QSemaphore freeSlots(parallel);
+    QList<conversionThread *> threads;
+    for(int i=0; i < results.count(); i++) {
+        conversionResult &result = results[i];
+        if(!force && adlConverter::isUpToDate(result.inputFile, result.outputFile)) {
+            result.status = "skipped";
+            continue;
+        }
+        QDir().mkpath(QFileInfo(result.outputFile).absolutePath());
+
+        freeSlots.acquire();
+        // get rid of the threads that are done
+        for(int j = threads.count() - 1; j >= 0; j--) {
+            if(threads.at(j)->isFinished()) {
+                threads.at(j)->wait();
+                delete threads.takeAt(j);
+            }
+        }
+        conversionThread *thread = new conversionThread(&result, &freeSlots);
+        threads.append(thread);
+        thread->start();
+    }
+    foreach(conversionThread *thread, threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    int converted = 0, skipped = 0, failed = 0;
+    for(int i=0; i < results.count(); i++) {
+        if(results.at(i).status == "converted") converted++;
+        else if(results.at(i).status == "skipped") skipped++;
+        else {
+            failed++;
+            printf("adl2ui -- failed: %s %s\n", results.at(i).inputFile.toLatin1().constData(), results.at(i).message.toLatin1().constData());
+        }
+    }
+    printf("adl2ui -- %d converted, %d up to date, %d failed in %.1f s\n", converted, skipped, failed, total.elapsed() / 1000.0);
+
+    // machine readable summary
+    QFile file(summaryFile);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        printf("adl2ui -- could not write summary to %s\n", summaryFile.toLatin1().constData());
+    } else {
+        QTextStream out(&file);
+        out << "{\n";
+        out << "  \"directory\": " << jsonString(bulkDir) << ",\n";
+        out << "  \"converted\": " << converted << ",\n";
+        out << "  \"skipped\": " << skipped << ",\n";
+        out << "  \"failed\": " << failed << ",\n";
+        out << "  \"msecs\": " << total.elapsed() << ",\n";
+        out << "  \"files\": [\n";
+        for(int i=0; i < results.count(); i++) {
+            const conversionResult &result = results.at(i);
+            out << "    {\"input\": " << jsonString(result.inputFile) << ", \"output\": " << jsonString(result.outputFile)
+                << ", \"status\": " << jsonString(result.status) << ", \"msecs\": " << result.msecs;
+            if(result.message.length() > 0) out << ", \"message\": " << jsonString(result.message);
+            out << "}" << (i < results.count() - 1 ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        file.close();
+        printf("adl2ui -- summary written to %s\n", summaryFile.toLatin1().constData());
+    }
+
+    return (failed > 0) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int	in, numargs;
+    char inFile[80] = "";
+    QString bulkDir, outDir, summaryFile;
+    int parallel = QThread::idealThreadCount();
+    bool force = false;
+    generateFlatFile = false;
+    generateDeviceOnMenus = false;
+    expandText = false;
+    legendsForStripplot = true;
+
+    for (numargs = argc, in = 1; in < numargs; in++) {
+        if ( strcmp (argv[in], "-flat" ) == 0 ) {
+            in++;
+            generateFlatFile = true;
+        }
+        if ( strcmp (argv[in], "-deviceonmenu" ) == 0 ) {
+            in++;
+            generateDeviceOnMenus = true;
+        }
+        if ( strcmp (argv[in], "-nolegends" ) == 0 ) {
+            in++;
+            legendsForStripplot = false;
+        }
+        if ( strcmp (argv[in], "-expandtext" ) == 0 ) {
+            in++;
+            expandText= true;
+        }
+        if ( strcmp (argv[in], "-v" ) == 0 ) {
+            printf("adl2ui version %s for %s\n", BUILDVERSION, BUILDARCH);
+            exit(0);
+        }
+        if(!strcmp(argv[in],"-help") || !strcmp(argv[in],"-h") || !strcmp(argv[in],"-?")) {
+            in++;
+            printf("Usage:\n adl2ui [options] file\n");
+            printf("       adl2ui [options] -bulk directory [-outdir directory] [-j n] [-summary file] [-force]\n");
+            printf("[-flat] :        flat file will be generated, includes are integrated\n");
+            printf("[-nolegends] :   no legends will be generated for the stripplots\n");
+            printf("[-deviceonmenu] : part of pv will be used for the label of menu\n");
+            printf("[-expandtext] : when textlabels do not fit, try this option\n");
+            printf("[-bulk] : all adl files of the directory tree are converted, up to date ui files are skipped\n");
+            printf("[-outdir] : the ui files of -bulk are written into this tree instead of next to the adl files\n");
+            printf("[-j] : number of parallel conversions for -bulk\n");
+            printf("[-summary] : json summary of -bulk, default adl2ui_summary.json\n");
+            printf("[-force] : -bulk converts also the up to date files\n");
+            exit(1);
+        }
+        if ((strcmp (argv[in], "-bulk" ) == 0) && (in + 1 < numargs)) {
+            bulkDir = argv[++in];
+            continue;
+        }
+        if ((strcmp (argv[in], "-outdir" ) == 0) && (in + 1 < numargs)) {
+            outDir = argv[++in];
+            continue;
+        }
+        if ((strcmp (argv[in], "-summary" ) == 0) && (in + 1 < numargs)) {
+            summaryFile = argv[++in];
+            continue;
+        }
+        if ((strcmp (argv[in], "-j" ) == 0) && (in + 1 < numargs)) {
+            parallel = qMax(1, atoi(argv[++in]));
+            continue;
+        }
+        if ( strcmp (argv[in], "-force" ) == 0 ) {
+            force = true;
+            continue;
+        }
+        if (strncmp (argv[in], "-" , 1) == 0) {
+            /* unknown application argument */
+            printf("adl2ui -- Argument %d = [%s] is unknown! ",in,argv[in]);
+            printf("possible are: '-flat and '-deviceonmenu' and '-nolegends' and '-v' and '-bulk'\n");
+            exit(-1);
+        } else {
+            printf("adl2ui -- file = <%s>\n", argv[in]);
+            qstrncpy(inFile, argv[in], sizeof(inFile));
+        }
+    }
+
+    if(generateFlatFile) printf("adl2ui -- a flat file will be generated\n");
+    if(generateDeviceOnMenus)printf("adl2ui -- device name will be put on menus\n");
+    if(!legendsForStripplot)printf("adl2ui -- legends will not be set for stripplot\n");
+    if(expandText)printf("adl2ui -- try to adjust lenght of labels thta do not fit\n");
+
+    // bulk conversion of a directory tree
+    if(bulkDir.length() > 0) {
+        if(!QFileInfo(bulkDir).isDir()) {
+            qDebug() << "adl2ui -- sorry, directory" << bulkDir << "does not exist";
+            exit(-1);
+        }
+        if(summaryFile.length() < 1) summaryFile = "adl2ui_summary.json";
+        return convertTree(bulkDir, outDir, summaryFile, parallel, force);
+    }
+
+    // input and out files
+    QString inputFile = inFile;
+    if(inputFile.size() < 1) {
+        qDebug() << "adl2ui -- sorry: no input file";
+        exit(-1);
+    }
+
+    QString openFile1, openFile2;
+    QString outputFile;
+
+    int found = inputFile.lastIndexOf(".adl");
+    if (found != -1) {
+        openFile1 = inputFile.mid(0, found);
+    } else {
+        openFile1 = inputFile;
+    }
+
+    openFile2 = openFile1;
+
+    outputFile = openFile1.append(".ui");
+    inputFile = openFile2.append(".adl");
+
+    // when file exists open it
+    QFileInfo fi(inputFile);
+    if(!fi.exists()) {
+        qDebug() << "adl2ui -- sorry, file" << inFile << "does not exist";
+        exit(-1);
+    }
+
+    //get rid of path, we want to generate where we are
+    outputFile = outputFile.section('/',-1);
+
+    QString message;
+    if(!adlConverter::convertFile(inputFile, outputFile, true, message)) {
+        qDebug() << message << "file:" << inputFile;
+    }
+
+    return 0;
+}
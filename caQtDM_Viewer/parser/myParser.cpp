@@ -28,10 +28,17 @@
 #include <iostream>
 #include <qfile.h>
 #include "XmlWriter.h"
+#include "myParser.h"
 #include <QFileDialog>
 #include "dmsearchfile.h"
 #include <QDebug>
 #include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QSet>
+#include <QHash>
+#include <QMutex>
+#include <QBuffer>
 
 
 extern "C" TOKEN parseAndAppendDisplayList(DisplayInfo *displayInfo, FrameOffset *offset, char *firstToken, TOKEN firstTokenType);
@@ -40,7 +47,6 @@ extern "C" void parseFile(DisplayInfo *displayInfo);
 extern "C" void *parseDisplay(DisplayInfo *displayInfo);
 extern "C" DlColormap *parseColormap(DisplayInfo *displayInfo, FILE *filePtr);
 extern "C" void Qt_writeZorder();
-extern "C" int parsingCompositeFile;
 extern "C" int generateFlatFile;
 extern "C" int generateDeviceOnMenus;
 extern "C" int expandText;
@@ -53,66 +59,37 @@ typedef struct _zOrder {
     string40 z;
 } zOrder;
 
-extern "C" zOrder zorder[1000];
-extern "C" int zindex;
-extern "C" char filePrefix[128];
-
-class myParser {
-
-public:
-
-    myParser ();
-    void openFile(char *outFile);
-    void closeFile();
-    void writeProperty(const QString& name, const QString& type, const QString& value );
-    void writeOpenProperty(const QString& name);
-    void writeTaggedString(const QString& type, const QString& value );
-    void writeCloseProperty();
-    void writeStyleSheet(int r, int g, int b);
-
-    void writeOpenTag(const QString& type, const QString& cls = "", const QString& name = "");
-    void writeCloseTag(const QString& type);
-    XmlWriter *xw;
-    myParser *adlParser;
-    QFile *file;
-    QString StyleSheet;
-    void test();
-    void Init(myParser* adlParser);
-    void writeMessage(char *mess);
-
-private:
-
-};
-
-// pointer used by external C
-extern "C" {
-	myParser* myParserPtr;
-}
 // constructor
 myParser::myParser () {
+    xw = (XmlWriter *) 0;
+    verbose = true;
+}
+
+myParser::~myParser () {
+    delete xw;
 }
 
 
-void myParser::openFile(char *outFile)
+bool myParser::openFile(QIODevice *output)
 {
     dmsearchFile *s = new dmsearchFile("stylesheet.qss");
     QString fileNameFound = s->findFile();
     if(fileNameFound.isNull()) {
-        printf("adl2ui -- file <stylesheet.qss> could not be loaded, is 'CAQTDM_DISPLAY_PATH' <%s> defined?\n", s->displayPath().toLatin1().constData());
-        printf("adl2ui -- could be a problem!\n");
+        if(verbose) printf("adl2ui -- file <stylesheet.qss> could not be loaded, is 'CAQTDM_DISPLAY_PATH' <%s> defined?\n", s->displayPath().toLatin1().constData());
+        if(verbose) printf("adl2ui -- could be a problem!\n");
     } else {
         QFile file(fileNameFound);
         file.open(QFile::ReadOnly);
         StyleSheet = QLatin1String(file.readAll());
-        printf("adl2ui -- file <stylesheet.qss> found and will be integrated in the resulting ui file\n");
-        printf("adl2ui -- if you do not want any styles, redefine CAQTDM_DISPLAY_PATH\n");
+        if(verbose) {
+            printf("adl2ui -- file <stylesheet.qss> found and will be integrated in the resulting ui file\n");
+            printf("adl2ui -- if you do not want any styles, redefine CAQTDM_DISPLAY_PATH\n");
+        }
         file.close();
     }
+    delete s;
 
-    file = new QFile(outFile);
-    if (!file->open(QIODevice::WriteOnly | QIODevice::Text)) exit(0);
-
-    xw = new XmlWriter(file);
+    xw = new XmlWriter(output);
 
     xw->setAutoNewLine(true);
 
@@ -120,6 +97,7 @@ void myParser::openFile(char *outFile)
     xw->newLine();
     xw->writeTaggedString( "class", "MainWindow" );
     xw->writeOpenTag("widget", AttrMap("class", "QMainWindow"), AttrMap("name", "MainWindow"));
+    return true;
 }
 
 void myParser::writeStyleSheet(int r, int g, int b)
@@ -148,8 +126,8 @@ void myParser::closeFile()
     QVector<zOrder>::iterator it;
 
     // create a vector with the order we had when parsing
-    for(int i=0; i<zindex; i++) {
-        myvector.append(zorder[i]);
+    for(int i=0; i<parserStatePtr->zindex; i++) {
+        myvector.append(parserStatePtr->zorder[i]);
     }
     // sort according to the static elements
     qStableSort(myvector.begin(), myvector.end(), compareFunc);
@@ -161,7 +139,8 @@ void myParser::closeFile()
     xw->writeCloseTag( "widget");
     xw->writeCloseTag( "widget");
     xw->writeRaw( "</ui>");
-    file->close();
+    delete xw;
+    xw = (XmlWriter *) 0;
 }
 
 void myParser::writeProperty(const QString& name, const QString& type, const QString& value )
@@ -202,7 +181,7 @@ void myParser::writeCloseTag(const QString& type)
 
 void myParser::Init(myParser* adlParser)
 {
-    myParserPtr = adlParser;
+    parserStatePtr->parser = adlParser;
 }
 
 void myParser::writeMessage(char *mess) {
@@ -260,156 +239,220 @@ extern "C" myParser* C_writeStyleSheet(myParser* p, int r, int g, int b)
 }
 
 /*
- *
+ * converts one adl file into an ui file; the parser state is allocated here for this conversion
+ * and only a pointer to it is kept per thread
  */
-class myParser;
-
-int main(int argc, char *argv[])
+bool adlConverter::convertFile(const QString &inputFile, QIODevice *output, bool verbose, QString &message)
 {
-    int	in, numargs;
-    char inFile[80] = "";
-    generateFlatFile = false;
-    parsingCompositeFile = false;
-    generateDeviceOnMenus = false;
-    expandText = false;
-    legendsForStripplot = true;
-
     char token[MAX_TOKEN_LENGTH];
     TOKEN tokenType;
 
-    for (numargs = argc, in = 1; in < numargs; in++) {
-        if ( strcmp (argv[in], "-flat" ) == 0 ) {
-            in++;
-            generateFlatFile = true;
-        }
-        if ( strcmp (argv[in], "-deviceonmenu" ) == 0 ) {
-            in++;
-            generateDeviceOnMenus = true;
-        }
-        if ( strcmp (argv[in], "-nolegends" ) == 0 ) {
-            in++;
-            legendsForStripplot = false;
-        }
-        if ( strcmp (argv[in], "-expandtext" ) == 0 ) {
-            in++;
-            expandText= true;
-        }
-        if ( strcmp (argv[in], "-v" ) == 0 ) {
-            printf("adl2ui version %s for %s\n", BUILDVERSION, BUILDARCH);
-            exit(0);
-        }
-        if(!strcmp(argv[in],"-help") || !strcmp(argv[in],"-h") || !strcmp(argv[in],"-?")) {
-            in++;
-            printf("Usage:\n adl2ui [options] file\n");
-            printf("[-flat] :        flat file will be generated, includes are integrated\n");
-            printf("[-nolegends] :   no legends will be generated for the stripplots\n");
-            printf("[-deviceonmenu] : part of pv will be used for the label of menu\n");
-            printf("[-expandtext] : when textlabels do not fit, try this option\n");
-            exit(1);
-        }
-        if (strncmp (argv[in], "-" , 1) == 0) {
-            /* unknown application argument */
-            printf("adl2ui -- Argument %d = [%s] is unknown! ",in,argv[in]);
-            printf("possible are: '-flat and '-deviceonmenu' and '-nolegends' and '-v'\n");
-            exit(-1);
-        } else {
-            printf("adl2ui -- file = <%s>\n", argv[in]);
-            strcpy(inFile, argv[in]);
-        }
-    }
-
-    if(generateFlatFile) printf("adl2ui -- a flat file will be generated\n");
-    if(generateDeviceOnMenus)printf("adl2ui -- device name will be put on menus\n");
-    if(!legendsForStripplot)printf("adl2ui -- legends will not be set for stripplot\n");
-    if(expandText)printf("adl2ui -- try to adjust lenght of labels thta do not fit\n");
-
-    // input and out files
-    QString inputFile = inFile;
-    if(inputFile.size() < 1) {
-        qDebug() << "adl2ui -- sorry: no input file";
-        exit(-1);
-    }
-
-    QString openFile1, openFile2;
-    QString outputFile;
+    QFileInfo fi(inputFile);
 
-    int found = inputFile.lastIndexOf(".adl");
-    if (found != -1) {
-        openFile1 = inputFile.mid(0, found);
-    } else {
-        openFile1 = inputFile;
+    // open input file
+    FILE *filePtr = fopen(inputFile.toLatin1().data(), "r");
+    if(filePtr == (FILE *) 0) {
+        message = "could not open input file";
+        return false;
     }
 
-    openFile2 = openFile1;
-
-    outputFile = openFile1.append(".ui");
-    inputFile = openFile2.append(".adl");
-
-    // when file exists open it
-    QFileInfo fi(inputFile);
-    if(!fi.exists()) {
-        qDebug() << "adl2ui -- sorry, file" << inFile << "does not exist";
-        exit(-1);
-    }
+    parserState *state = (parserState *) calloc(1, sizeof(parserState));
+    state->zorder = (zOrder *) calloc(MAXZORDER, sizeof(zOrder));
+    setParserState(state);
 
     // get path for composite file parsing
     //qDebug() << fi.absolutePath();
-    strcpy(filePrefix, fi.absolutePath().toLatin1().data());
+    qstrncpy(state->filePrefix, fi.absolutePath().toLatin1().data(), sizeof(state->filePrefix));
 
     // init adlParser
     myParser *adlParser = new myParser;
+    adlParser->verbose = verbose;
     adlParser->Init(adlParser);
 
-    //get rid of path, we want to generate where we are
-    outputFile = outputFile.section('/',-1);
-    adlParser->openFile(outputFile.toLatin1().data());
+    adlParser->openFile(output);
 
-    // open input file
-    FILE *filePtr = fopen(inputFile.toLatin1().data(), "r");
     FrameOffset offset;
 
     DisplayInfo *cdi = (DisplayInfo *) malloc(sizeof (DisplayInfo));
+    memset(cdi, 0, sizeof (DisplayInfo));
     offset.frameX = 0;
     offset.frameY = 0;
     cdi->filePtr = filePtr;
 
+    bool success = false;
+
     // start parsing
     tokenType = getToken(cdi, token);
     if (tokenType == T_WORD && !strcmp(token, "file")) {
         parseFile(cdi);
+
+        // continue parsing
+        tokenType = getToken(cdi, token);
+        if (tokenType == T_WORD && !strcmp(token, "display")) {
+            parseDisplay(cdi);
+
+            // Read the colormap if there.  Will also create cdi->dlColormap.
+            success = true;
+            tokenType = getToken(cdi, token);
+            if (tokenType == T_WORD && (!strcmp(token, "color map") || !strcmp(token, "<<color map>>"))) {
+                cdi->dlColormap = parseColormap(cdi, cdi->filePtr);
+                if (cdi->dlColormap) {
+                    tokenType = getToken(cdi, token);
+                } else {
+                    message = "Invalid .adl file (Cannot parse colormap file)";
+                    success = false;
+                }
+            }
+        } else {
+            message = "dmDisplayListParse: Invalid .adl file (Second block is not display block)";
+        }
     } else {
-        qDebug() << "dmDisplayListParse: Invalid .adl file (First block is not file block) file: " <<  inputFile;
-        return 0;
-    }
-    // continue parsing
-    tokenType = getToken(cdi, token);
-    if (tokenType == T_WORD && !strcmp(token, "display")) {
-        parseDisplay(cdi);
-    } else {
-        qDebug() << "dmDisplayListParse: Invalid .adl file (Second block is not display block) " << inputFile;
-        return 0;
+        message = "dmDisplayListParse: Invalid .adl file (First block is not file block)";
     }
 
-    // Read the colormap if there.  Will also create cdi->dlColormap.
-    tokenType = getToken(cdi, token);
-    if (tokenType == T_WORD && (!strcmp(token, "color map") || !strcmp(token, "<<color map>>"))) {
-        cdi->dlColormap = parseColormap(cdi, cdi->filePtr);
-        if (cdi->dlColormap) {
+    if(success) {
+        // Proceed with parsing
+        while (parseAndAppendDisplayList(cdi, &offset, token, tokenType) != T_EOF) {
             tokenType = getToken(cdi, token);
-        } else {
-            printf("Invalid .adl file (Cannot parse colormap file: %s\n", inFile);
-            return 0;
         }
     }
+    // finish the xml
+    adlParser->closeFile();
 
-    // Proceed with parsing
-    while (parseAndAppendDisplayList(cdi, &offset, token, tokenType) != T_EOF) {
-        tokenType = getToken(cdi, token);
+    fclose(cdi->filePtr);
+    if(cdi->dlColormap) free(cdi->dlColormap);
+    free(cdi);
+    delete adlParser;
+    parserStatePtr->parser = (myParser *) 0;
+
+    setParserState((parserState *) 0);
+    free(state->zorder);
+    free(state);
+
+    return success;
+}
+
+/*
+ * composite files referenced by an adl file
+ */
+static QStringList compositeFilesOf(const QString &inputFile, const QString &prefix)
+{
+    QStringList files;
+    QFile file(inputFile);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) return files;
+
+    while(!file.atEnd()) {
+        QString line = QString::fromLatin1(file.readLine());
+        int pos = line.indexOf("\"composite file\"");
+        if(pos < 0) continue;
+        int start = line.indexOf('"', line.indexOf('=', pos));
+        int end = line.indexOf('"', start + 1);
+        if(start < 0 || end < 0) continue;
+        QString name = line.mid(start + 1, end - start - 1).section(';', 0, 0).trimmed();
+        if(name.length() > 0) files.append(prefix + "/" + name);
     }
+    file.close();
+    return files;
+}
 
-    // close output file
-    adlParser->closeFile();
+/*
+ * converts an adl file into an ui file, a failed conversion does not leave a partial ui file
+ */
+bool adlConverter::convertFile(const QString &inputFile, const QString &outputFile, bool verbose, QString &message)
+{
+    QFile file(outputFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        message = "could not open output file";
+        return false;
+    }
+    bool success = convertFile(inputFile, &file, verbose, message);
+    file.close();
+    if(!success) file.remove();
+    return success;
+}
 
-    return 0;
+/*
+ * all composite files an adl file depends on, composite files are relative to the directory of the top file
+ */
+QStringList adlConverter::compositeFiles(const QString &inputFile)
+{
+    QString prefix = QFileInfo(inputFile).absolutePath();
+    QStringList files(inputFile);
+    QStringList dependencies;
+    QSet<QString> seen;
+    seen.insert(inputFile);
+    while(!files.isEmpty()) {
+        foreach(QString file, compositeFilesOf(files.takeFirst(), prefix)) {
+            if(seen.contains(file)) continue;
+            seen.insert(file);
+            dependencies.append(file);
+            files.append(file);
+        }
+    }
+    return dependencies;
 }
 
+/*
+ * an output is up to date when it is newer than its input and than all composite files used by the input
+ */
+bool adlConverter::isUpToDate(const QString &inputFile, const QString &outputFile)
+{
+    QFileInfo out(outputFile);
+    if(!out.exists()) return false;
+    QDateTime built = out.lastModified();
+
+    QStringList files(inputFile);
+    files.append(compositeFiles(inputFile));
+    foreach(QString file, files) {
+        QFileInfo fi(file);
+        if(!fi.exists() || fi.lastModified() > built) return false;
+    }
+    return true;
+}
+
+/*
+ * conversions done in memory are kept together with the modification times of their files
+ */
+typedef struct _adlCacheEntry {
+    QByteArray ui;
+    QHash<QString, QDateTime> modified;
+} adlCacheEntry;
+
+static QMutex adlCacheMutex;
+static QHash<QString, adlCacheEntry> adlCache;
+
+/*
+ * returns the ui description of an adl file, converted in memory when the adl file or one of its composite files changed
+ */
+QByteArray adlConverter::uiFromAdl(const QString &inputFile, QString &message)
+{
+    QString key = QFileInfo(inputFile).absoluteFilePath();
+    QStringList files(key);
+    files.append(compositeFiles(key));
+
+    QMutexLocker locker(&adlCacheMutex);
+    QHash<QString, adlCacheEntry>::const_iterator it = adlCache.constFind(key);
+    if(it != adlCache.constEnd()) {
+        bool valid = (it.value().modified.count() == files.count());
+        foreach(QString file, files) {
+            if(!valid) break;
+            valid = (it.value().modified.value(file) == QFileInfo(file).lastModified());
+        }
+        if(valid) return it.value().ui;
+    }
+
+    adlCacheEntry entry;
+    foreach(QString file, files) entry.modified.insert(file, QFileInfo(file).lastModified());
+
+    QBuffer buffer(&entry.ui);
+    buffer.open(QIODevice::WriteOnly);
+    bool success = convertFile(key, &buffer, false, message);
+    buffer.close();
+    if(!success) {
+        adlCache.remove(key);
+        return QByteArray();
+    }
+
+    adlCache.insert(key, entry);
+    return entry.ui;
+}
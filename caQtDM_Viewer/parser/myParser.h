@@ -23,14 +23,55 @@
  *    anton.mezger@psi.ch
  */
 
+#ifndef MYPARSER_H
+#define MYPARSER_H
 
-#include <qfile.h>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QIODevice>
 #include "XmlWriter.h"
 
-using namespace std;
-
 class myParser {
 
 public:
-  XmlWriter *xw;
+
+    myParser ();
+    ~myParser ();
+    bool openFile(QIODevice *output);
+    void closeFile();
+    void writeProperty(const QString& name, const QString& type, const QString& value );
+    void writeOpenProperty(const QString& name);
+    void writeTaggedString(const QString& type, const QString& value );
+    void writeCloseProperty();
+    void writeStyleSheet(int r, int g, int b);
+
+    void writeOpenTag(const QString& type, const QString& cls = "", const QString& name = "");
+    void writeCloseTag(const QString& type);
+    XmlWriter *xw;
+    myParser *adlParser;
+    QString StyleSheet;
+    void test();
+    void Init(myParser* adlParser);
+    void writeMessage(char *mess);
+    bool verbose;
+
+private:
+
 };
+
+/*
+ * MEDM adl to ui conversion, used by adl2ui and for loading adl files directly into caQtDM
+ */
+class adlConverter {
+
+public:
+
+    static bool convertFile(const QString &inputFile, QIODevice *output, bool verbose, QString &message);
+    static bool convertFile(const QString &inputFile, const QString &outputFile, bool verbose, QString &message);
+    static QStringList compositeFiles(const QString &inputFile);
+    static bool isUpToDate(const QString &inputFile, const QString &outputFile);
+    static QByteArray uiFromAdl(const QString &inputFile, QString &message);
+};
+
+#endif
@@ -33,13 +33,11 @@
 #include "parser.h"
 #include "QtProperties.h"
 
-int parsingCompositeFile;
-int generateFlatFile;
-int generateDeviceOnMenus;
-int expandText;
-int legendsForStripplot;
+int generateFlatFile = False;
+int generateDeviceOnMenus = False;
+int expandText = False;
+int legendsForStripplot = True;
 
-char filePrefix[128] = "";
 static  string40 formatTable[] = { "decimal", "exponential", "engr_notation", "compact", "truncated",
                                    "hexadecimal", "octal", "string",
                                    "sexagesimal", "sexagesimal-hms", "sexagesimal-dms"};
@@ -257,16 +255,17 @@ int parseDelimited(char *s, string40 items[], int nbItems, char token)
 {
     int i, cnt;
     char * pch;
+    char *savePtr;
     char ctoken[2];
     memcpy(ctoken, &token, 1);
     ctoken[1] ='\0';
     for (i=0; i< (int) strlen(s); i++) if(s[i] < ' ') s[i] = '\0';
     cnt = 0;
-    pch = strtok (s, ctoken);
+    pch = strtok_r (s, ctoken, &savePtr);
     while (pch != NULL)
     {
         strcpy(items[cnt], pch);
-        pch = strtok (NULL, ctoken);
+        pch = strtok_r (NULL, ctoken, &savePtr);
         if(cnt++ >= nbItems) break;
     }
     return cnt;
@@ -305,7 +304,7 @@ void parseAndSkip(DisplayInfo *displayInfo)
 NameValueTable *generateNameValueTable(char *argsString, int *numNameValues)
 {
     char *copyOfArgsString,  *name, *value;
-    char *s1;
+    char *s1, *savePtr;
     char nameEntry[80], valueEntry[80];
     int i, j, tableIndex, numPairs, numEntries;
     NameValueTable *nameTable;
@@ -340,8 +339,8 @@ NameValueTable *generateNameValueTable(char *argsString, int *numNameValues)
             } else {
                 s1 = NULL;
             }
-            name = strtok(s1,"=");
-            value = strtok(NULL,",");
+            name = strtok_r(s1,"=", &savePtr);
+            value = strtok_r(NULL,",", &savePtr);
             if(name != NULL && value != NULL) {
                 /* found legitimate name/value pair, put in table */
                 j = 0;
@@ -1289,9 +1288,9 @@ void *parseCartesianPlot(DisplayInfo *displayInfo, FrameOffset * offset)
     int countDone = False;
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_CARTESIANPLOT];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caCartesianPlot_%d", number++);
+    sprintf(widgetName, "caCartesianPlot_%d", (*number)++);
     Qt_writeOpenTag("widget", "caCartesianPlot", widgetName);
 
     do {
@@ -1477,10 +1476,10 @@ void *parseRelatedDisplay(DisplayInfo *displayInfo, FrameOffset * offset)
     char argus[LONGSTRING]  = "\0";
     char remos[LONGSTRING]  = "\0";
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_RELATEDDISPLAY];
     int clr = 0;
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caRelatedDisplay_%d", number++);
+    sprintf(widgetName, "caRelatedDisplay_%d", (*number)++);
     Qt_writeOpenTag("widget", "caRelatedDisplay", widgetName);
 
     do {
@@ -1639,9 +1638,9 @@ void *parseShellCommand(DisplayInfo *displayInfo, FrameOffset * offset)
 
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_SHELLCOMMAND];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caShellCommand_%d", number++);
+    sprintf(widgetName, "caShellCommand_%d", (*number)++);
     Qt_writeOpenTag("widget", "caShellCommand", widgetName);
 
     do {
@@ -1724,12 +1723,12 @@ void *parseMeter(DisplayInfo *displayInfo, FrameOffset * offset)
     char COLORMODE[MAX_TOKEN_LENGTH] = "static";
     TOKEN tokenType;
     int nestingLevel = 0;
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_CIRCULARGAUGE];
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caCircularGauge_%d", number++);
+    sprintf(widgetName, "caCircularGauge_%d", (*number)++);
     Qt_writeOpenTag("widget", "caCircularGauge", widgetName);
 
     do {
@@ -1790,9 +1789,9 @@ void *parseByte( DisplayInfo *displayInfo, FrameOffset * offset) {
     int startBit = 15;
     int endBit = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_BYTE];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caByte_%d", number++);
+    sprintf(widgetName, "caByte_%d", (*number)++);
     Qt_writeOpenTag("widget", "caByte", widgetName);
 
     do {
@@ -1888,9 +1887,9 @@ void *parseStripChart(DisplayInfo *displayInfo, FrameOffset * offset)
     int penNumber;
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_STRIPPLOT];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caStripPlot_%d", number++);
+    sprintf(widgetName, "caStripPlot_%d", (*number)++);
     Qt_writeOpenTag("widget", "caStripPlot", widgetName);
 
     do {
@@ -1973,9 +1972,9 @@ void *parseTextUpdate(DisplayInfo *displayInfo, FrameOffset * offset)
     int i= 0, format=0;
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_LINEEDIT];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caLineEdit_%d", number++);
+    sprintf(widgetName, "caLineEdit_%d", (*number)++);
     Qt_writeOpenTag("widget", "caLineEdit", widgetName);
 
     do {
@@ -2072,9 +2071,9 @@ void *parseChoiceButton(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_CHOICE];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caChoice_%d", number++);
+    sprintf(widgetName, "caChoice_%d", (*number)++);
     Qt_writeOpenTag("widget", "caChoice", widgetName);
 
     do {
@@ -2130,9 +2129,9 @@ void *parseMessageButton(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_MESSAGEBUTTON];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caMessageButton_%d", number++);
+    sprintf(widgetName, "caMessageButton_%d", (*number)++);
     Qt_writeOpenTag("widget", "caMessageButton", widgetName);
 
     do {
@@ -2192,9 +2191,9 @@ void *parseMenu(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_MENU];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caMenu_%d", number++);
+    sprintf(widgetName, "caMenu_%d", (*number)++);
     Qt_writeOpenTag("widget", "caMenu", widgetName);
 
     do {
@@ -2245,9 +2244,9 @@ void *parseTextEntry(DisplayInfo *displayInfo, FrameOffset * offset)
     int i= 0, format=0;
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_TEXTENTRY];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caTextEntry_%d", number++);
+    sprintf(widgetName, "caTextEntry_%d", (*number)++);
     Qt_writeOpenTag("widget", "caTextEntry", widgetName);
 
     do {
@@ -2329,9 +2328,9 @@ void *parseValuator(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_SLIDER];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caSlider_%d", number++);
+    sprintf(widgetName, "caSlider_%d", (*number)++);
     Qt_writeOpenTag("widget", "caSlider", widgetName);
 
     do {
@@ -2502,9 +2501,9 @@ void *parseImage(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_IMAGE];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caImage_%d", number++);
+    sprintf(widgetName, "caImage_%d", (*number)++);
     Qt_writeOpenTag("widget", "caImage", widgetName);
 
     do {
@@ -2565,7 +2564,7 @@ static int getWidthFromIncludeFile(DisplayInfo *displayInfo, char *filename,
     savedVersionNumber = displayInfo->versionNumber;
 
     displayInfo->filePtr = filePtr;
-    parsingCompositeFile = True;
+    parserStatePtr->parsingCompositeFile = True;
 
     // Read the display block
     tokenType=getToken(displayInfo,token);
@@ -2640,7 +2639,7 @@ static void compositeFileParse(DisplayInfo *displayInfo, char *filename, DlObjec
     }
 
     // filename
-    strcpy(newFileName, filePrefix);
+    strcpy(newFileName, parserStatePtr->filePrefix);
     strcat(newFileName, "/");
     strcat(newFileName, filename);
 
@@ -2701,7 +2700,7 @@ static void compositeFileParse(DisplayInfo *displayInfo, char *filename, DlObjec
         return;
     }
 
-    parsingCompositeFile = True;
+    parserStatePtr->parsingCompositeFile = True;
 
     displayInfo->filePtr = filePtr;
     // Only do this if there is a macro string, otherwise use the  existing macros
@@ -2756,7 +2755,7 @@ RETURN:
         displayInfo->nameValueTable = savedNameValueTable;
         displayInfo->numNameValues = savedNumNameValues;
     }
-    parsingCompositeFile = False;
+    parserStatePtr->parsingCompositeFile = False;
     fclose(filePtr);
 }
 
@@ -2771,7 +2770,7 @@ void *parseComposite(DisplayInfo *displayInfo, FrameOffset *offset)
     int visibilityStatic = 0;
     int includeSet = False;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_INCLUDE];
     char widgetName[MAX_ASCII];
     FrameOffset *frameoffset;
     FrameOffset *actoffset;
@@ -2825,7 +2824,7 @@ void *parseComposite(DisplayInfo *displayInfo, FrameOffset *offset)
                 if(!generateFlatFile) {
                     includeSet = True;
 
-                    sprintf(widgetName, "caInclude_%d", number++);
+                    sprintf(widgetName, "caInclude_%d", (*number)++);
                     Qt_writeOpenTag("widget", "caInclude", widgetName);
 
                     newoffset->frameX = object->x;
@@ -2835,7 +2834,7 @@ void *parseComposite(DisplayInfo *displayInfo, FrameOffset *offset)
                     // will be a caFrame
                 } else {
 
-                    sprintf(widgetName, "caFrame_%d", number++);
+                    sprintf(widgetName, "caFrame_%d", (*number)++);
                     Qt_writeOpenTag("widget", "caFrame", widgetName);
 
                     newoffset->frameX = 0;
@@ -2852,7 +2851,7 @@ void *parseComposite(DisplayInfo *displayInfo, FrameOffset *offset)
 
             } else if(!strcmp(token,"children")) {
 				FrameOffset *newoffset;
-                sprintf(widgetName, "caFrame_%d", number++);
+                sprintf(widgetName, "caFrame_%d", (*number)++);
                 Qt_writeOpenTag("widget", "caFrame", widgetName);
 
                 newoffset = (FrameOffset *)malloc(sizeof(FrameOffset));
@@ -2942,9 +2941,9 @@ void *parseWheelSwitch(DisplayInfo *displayInfo, FrameOffset * offset)
     int visibilityStatic = 2; // top layer
     int formatFound=False;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_NUMERIC];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caNumeric_%d", number++);
+    sprintf(widgetName, "caNumeric_%d", (*number)++);
     Qt_writeOpenTag("widget", "caNumeric", widgetName);
 
     do {
@@ -3003,9 +3002,9 @@ void *parsePolygon(DisplayInfo *displayInfo, FrameOffset * offset)
     int visibilityStatic = 0;
     int offsetX=0, offsetY=0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_POLYGON];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caPolygon_%d", number++);
+    sprintf(widgetName, "caPolygon_%d", (*number)++);
     Qt_writeOpenTag("widget", "caPolyLine", widgetName);
 
     do {
@@ -3056,9 +3055,9 @@ void *parseRectangle(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_RECTANGLE];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caRectangle_%d", number++);
+    sprintf(widgetName, "caRectangle_%d", (*number)++);
     Qt_writeOpenTag("widget", "caGraphics", widgetName);
 
     Qt_handleString("form", "enum", "caGraphics::Rectangle");
@@ -3102,9 +3101,9 @@ void *parseOval(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_GRAPHICS];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caGraphics_%d", number++);
+    sprintf(widgetName, "caGraphics_%d", (*number)++);
     Qt_writeOpenTag("widget", "caGraphics", widgetName);
 
     Qt_handleString("form", "enum", "caGraphics::Circle");
@@ -3151,10 +3150,10 @@ void *parseArc(DisplayInfo *displayInfo, FrameOffset * offset)
     int startAngle = 0;
     int spanAngle = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_ARC];
     char widgetName[MAX_ASCII];
 
-    sprintf(widgetName, "caArc_%d", number++);
+    sprintf(widgetName, "caArc_%d", (*number)++);
     Qt_writeOpenTag("widget", "caGraphics", widgetName);
 
     Qt_handleString("form", "enum", "caGraphics::Arc");
@@ -3219,9 +3218,9 @@ void *parseText(DisplayInfo *displayInfo, FrameOffset * offset)
     int visibilityStatic = 0;
     unsigned int newWidth = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_LABEL];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caLabel_%d", number++);
+    sprintf(widgetName, "caLabel_%d", (*number)++);
     Qt_writeOpenTag("widget", "caLabel", widgetName);
 
     Qt_handleString("frameShape", "enum", "QFrame::NoFrame");
@@ -3344,9 +3343,9 @@ void *parsePolyline(DisplayInfo *displayInfo, FrameOffset * offset)
     int offsetX=0, offsetY=0;
     int visibilityStatic = 0;
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_POLYLINE];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caPolyLine_%d", number++);
+    sprintf(widgetName, "caPolyLine_%d", (*number)++);
     Qt_writeOpenTag("widget", "caPolyLine", widgetName);
 
     do {
@@ -3395,9 +3394,9 @@ void *parseBar(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_THERMO];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caThermo_%d", number++);
+    sprintf(widgetName, "caThermo_%d", (*number)++);
     Qt_writeOpenTag("widget", "caThermo", widgetName);
 
     do {
@@ -3505,9 +3504,9 @@ void *parseIndicator(DisplayInfo *displayInfo, FrameOffset * offset)
     DlObject object={0,0,0,0};
     int visibilityStatic = 2; // top layer
 	char pipeWidth[10];
-    static int number = 0;
+    int *number = &parserStatePtr->widgetCounters[COUNTER_THERMOM];
     char widgetName[MAX_ASCII];
-    sprintf(widgetName, "caThermoM_%d", number++);
+    sprintf(widgetName, "caThermoM_%d", (*number)++);
     Qt_writeOpenTag("widget", "caThermo", widgetName);
 
     do {
@@ -3626,7 +3625,7 @@ TOKEN getToken(DisplayInfo *displayInfo, char *word)
      case '$' : c=getc(filePtr);
                 // only do macro substitution if in execute mode or parsing a composite file
 
-                if((parsingCompositeFile) && c == '(' ) {
+                if((parserStatePtr->parsingCompositeFile) && c == '(' ) {
       state = INMACRO;
   } else {
       *w++ = '$';
@@ -3715,17 +3714,30 @@ void *getNextElement(DisplayInfo *pDI, char *token, FrameOffset *offset) {
     return 0;
 }
 
+/* the state of the conversion running in this thread */
+THREADLOCAL parserState *parserStatePtr = (parserState *) 0;
+
+/* a new conversion starts in this thread with its own state */
+void setParserState(parserState *state)
+{
+    parserStatePtr = state;
+    if(state == (parserState *) 0) return;
+    state->veryFirst = True;
+    state->parsingCompositeFile = False;
+    state->zindex = 0;
+    memset(state->widgetCounters, 0, sizeof(state->widgetCounters));
+}
+
 TOKEN parseAndAppendDisplayList(DisplayInfo *displayInfo, FrameOffset *offset, char *firstToken, TOKEN firstTokenType)
 {
     TOKEN tokenType;
     char token[MAX_TOKEN_LENGTH];
     int nestingLevel = 0;
     int first = 1;
-    static int veryFirst = True;
     int bclr = 0;
 
-    if(veryFirst) {
-        veryFirst = False;
+    if(parserStatePtr->veryFirst) {
+        parserStatePtr->veryFirst = False;
         bclr = displayInfo->drawingAreaBackgroundColor;
 
         Qt_writeStyleSheet(displayInfo->dlColormap->dl_color[bclr].r,
@@ -119,6 +119,58 @@ typedef enum
 #define MAX_SHELL_COMMANDS      16
 #define SC_DEFAULT_UNITS    SECONDS
 
+/* only the pointer to the state of the running conversion is kept per thread */
+#if defined(_MSC_VER)
+#define THREADLOCAL __declspec(thread)
+#define strtok_r strtok_s
+#else
+#define THREADLOCAL __thread
+#endif
+
+/* counters for the widget names of each widget class */
+enum {
+    COUNTER_CARTESIANPLOT = 0,
+    COUNTER_RELATEDDISPLAY,
+    COUNTER_SHELLCOMMAND,
+    COUNTER_CIRCULARGAUGE,
+    COUNTER_BYTE,
+    COUNTER_STRIPPLOT,
+    COUNTER_LINEEDIT,
+    COUNTER_CHOICE,
+    COUNTER_MESSAGEBUTTON,
+    COUNTER_MENU,
+    COUNTER_TEXTENTRY,
+    COUNTER_SLIDER,
+    COUNTER_IMAGE,
+    COUNTER_INCLUDE,
+    COUNTER_NUMERIC,
+    COUNTER_POLYGON,
+    COUNTER_RECTANGLE,
+    COUNTER_GRAPHICS,
+    COUNTER_ARC,
+    COUNTER_LABEL,
+    COUNTER_POLYLINE,
+    COUNTER_THERMO,
+    COUNTER_THERMOM,
+    PARSER_COUNTERS
+};
+
+#define MAXZORDER 10000
+
+/* the state of one conversion, owned by the converter, so that files can be converted in parallel */
+typedef struct _parserState {
+    struct myParser *parser;            /* writer of the ui file */
+    struct _zOrder *zorder;             /* MAXZORDER entries */
+    int zindex;
+    int parsingCompositeFile;
+    int veryFirst;
+    char filePrefix[128];
+    int widgetCounters[PARSER_COUNTERS];
+} parserState;
+
+extern THREADLOCAL parserState *parserStatePtr;
+void setParserState(parserState *state);
+
 #define True (1==1)
 #define False !True
 #define Boolean unsigned int
@@ -16,7 +16,7 @@ HEADERS += XmlWriter.h parser.h \
     myParser.h \
     QtProperties.h \
     dmsearchfile.h
-SOURCES += myParser.cpp XmlWriter.cpp parser.c \
+SOURCES += adl2ui.cpp myParser.cpp XmlWriter.cpp parser.c \
     QtProperties.c \
     dmsearchfile.cpp
 
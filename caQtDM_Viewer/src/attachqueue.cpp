@@ -0,0 +1,299 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <string.h>
+#include "attachqueue.h"
+
+// identifies this queue layout in the shared memory
+#define ATTACHQUEUE_MAGIC 0x63615132
+
+// a record is a length and a state followed by the message, aligned to 8 bytes
+#define RECORD_HEADER 8
+#define RECORD_EMPTY 0
+#define RECORD_COMMITTED 1
+#define RECORD_PADDING 2
+
+// a record still empty after this time belongs to a producer that died while writing it
+#define STUCKRECORD_TIMEOUT 5000
+
+static inline int recordSize(int length)
+{
+    return (RECORD_HEADER + length + 7) & ~7;
+}
+
+static inline int atomicLoad(int *value)
+{
+    QBasicAtomicInt *atomic = reinterpret_cast<QBasicAtomicInt *>(value);
+#if QT_VERSION >= 0x050000
+    return atomic->loadAcquire();
+#else
+    return atomic->fetchAndAddOrdered(0);
+#endif
+}
+
+static inline void atomicStore(int *value, int newValue)
+{
+    QBasicAtomicInt *atomic = reinterpret_cast<QBasicAtomicInt *>(value);
+#if QT_VERSION >= 0x050000
+    atomic->storeRelease(newValue);
+#else
+    atomic->fetchAndStoreOrdered(newValue);
+#endif
+}
+
+static inline bool atomicTestAndSet(int *value, int expected, int newValue)
+{
+    return reinterpret_cast<QBasicAtomicInt *>(value)->testAndSetOrdered(expected, newValue);
+}
+
+AttachQueue::AttachQueue(QSharedMemory *memory, const QString &key)
+{
+    sharedMemory = memory;
+    semaphoreKey = key + ":wakeup";
+    semaphore = new QSystemSemaphore(semaphoreKey, 0, QSystemSemaphore::Open);
+    stuckTail = stuckHead = 0;
+    stuckTimer.invalidate();
+}
+
+AttachQueue::~AttachQueue()
+{
+    delete semaphore;
+}
+
+int AttachQueue::memorySize()
+{
+    return sizeof(queueHeader) + QueueSize;
+}
+
+AttachQueue::queueHeader *AttachQueue::header()
+{
+    return (queueHeader *) sharedMemory->data();
+}
+
+char *AttachQueue::ring()
+{
+    return ((char *) sharedMemory->data()) + sizeof(queueHeader);
+}
+
+bool AttachQueue::isValid()
+{
+    if(!sharedMemory->isAttached() || sharedMemory->size() < memorySize()) return false;
+    return header()->magic == ATTACHQUEUE_MAGIC && header()->capacity == QueueSize;
+}
+
+/**
+ * called by the creator of the shared memory only
+ */
+void AttachQueue::initialize()
+{
+    if(!sharedMemory->isAttached()) return;
+    memset(sharedMemory->data(), 0, memorySize());
+    header()->capacity = QueueSize;
+    atomicStore(&header()->magic, ATTACHQUEUE_MAGIC);
+
+    // the creator owns the semaphore, start without pending wakeups
+    delete semaphore;
+    semaphore = new QSystemSemaphore(semaphoreKey, 0, QSystemSemaphore::Create);
+}
+
+bool AttachQueue::tryEnqueue(const QByteArray &message, unsigned int *end)
+{
+    queueHeader *h = header();
+    int need = recordSize(message.size());
+    int head, pad;
+
+    // reserve space, a record does not wrap around the end of the ring
+    while(true) {
+        head = atomicLoad(&h->head);
+        unsigned int tail = (unsigned int) atomicLoad(&h->tail);
+        int offset = (int) ((unsigned int) head % QueueSize);
+        pad = (QueueSize - offset < need) ? QueueSize - offset : 0;
+        if(((unsigned int) head + pad + need) - tail > (unsigned int) QueueSize) return false;
+        if(atomicTestAndSet(&h->head, head, (int) ((unsigned int) head + pad + need))) break;
+    }
+
+    if(pad > 0) {
+        char *record = ring() + ((unsigned int) head % QueueSize);
+        *((int *) record) = pad - RECORD_HEADER;
+        atomicStore((int *) (record + 4), RECORD_PADDING);
+    }
+
+    char *record = ring() + (((unsigned int) head + pad) % QueueSize);
+    *((int *) record) = message.size();
+    memcpy(record + RECORD_HEADER, message.constData(), message.size());
+    atomicStore((int *) (record + 4), RECORD_COMMITTED);
+    *end = (unsigned int) head + pad + need;
+    return true;
+}
+
+static void shortSleep()
+{
+    QMutex mutex;
+    QWaitCondition waitCondition;
+    mutex.lock();
+    waitCondition.wait(&mutex, 10);
+    mutex.unlock();
+}
+
+/**
+ * queues a message and wakes up the consumer; when the queue stays full during timeout ms, false is returned
+ */
+bool AttachQueue::send(const QByteArray &message, int timeout)
+{
+    if(!isValid() || message.size() > MaxMessageSize) return false;
+
+    unsigned int end;
+    QElapsedTimer timer;
+    timer.start();
+    while(!tryEnqueue(message, &end)) {
+        if(timer.elapsed() > timeout) {
+            QBasicAtomicInt *overflows = reinterpret_cast<QBasicAtomicInt *>(&header()->overflows);
+            overflows->fetchAndAddOrdered(1);
+            return false;
+        }
+        // give the consumer some time
+        shortSleep();
+    }
+    semaphore->release();
+
+    // on unix the release of a QSystemSemaphore is undone when this process exits; a sender that
+    // exits right away would take its wakeup back, so stay until the consumer has taken the message.
+    // When it does not within timeout ms, the message stays queued for the polling of the consumer
+    timer.start();
+    while((int) ((unsigned int) atomicLoad(&header()->tail) - end) < 0 && timer.elapsed() <= timeout) {
+        shortSleep();
+    }
+    return true;
+}
+
+/**
+ * takes the next message, only one consumer may call this
+ */
+bool AttachQueue::receive(QByteArray &message)
+{
+    if(!isValid()) return false;
+    queueHeader *h = header();
+
+    while(true) {
+        unsigned int tail = (unsigned int) atomicLoad(&h->tail);
+        unsigned int head = (unsigned int) atomicLoad(&h->head);
+        if(tail == head) return false;
+
+        char *record = ring() + (tail % QueueSize);
+        int state = atomicLoad((int *) (record + 4));
+        if(state == RECORD_EMPTY) {               // reserved, but not yet written
+            if(dropStuckRecords(tail)) continue;
+            return false;
+        }
+        stuckTimer.invalidate();
+        if(state != RECORD_COMMITTED && state != RECORD_PADDING) return false;
+
+        // the record has to lie between tail and head and may not wrap around the end of the ring
+        int length = *((int *) record);
+        if(length < 0 || length > QueueSize - RECORD_HEADER) return false;
+        int size = recordSize(length);
+        if((unsigned int) size > head - tail || (tail % QueueSize) + size > (unsigned int) QueueSize) return false;
+        if(state == RECORD_COMMITTED) message = QByteArray(record + RECORD_HEADER, length);
+
+        // the whole record is cleared, a header written later on this place must not see old bytes
+        memset(record, 0, size);
+        atomicStore(&h->tail, (int) (tail + size));
+        if(state == RECORD_COMMITTED) return true;
+    }
+}
+
+/**
+ * a producer that dies between its reservation and its commit leaves an empty record at the tail,
+ * its length is not known; when the tail stays there for STUCKRECORD_TIMEOUT ms, everything reserved
+ * up to the head seen at the first detection is dropped. Live producers of those records had far more
+ * time than needed to finish, records reserved later are kept; the drop is counted as an overflow
+ */
+bool AttachQueue::dropStuckRecords(unsigned int tail)
+{
+    queueHeader *h = header();
+
+    if(!stuckTimer.isValid() || stuckTail != tail) {
+        stuckTail = tail;
+        stuckHead = (unsigned int) atomicLoad(&h->head);
+        stuckTimer.start();
+        return false;
+    }
+    if(stuckTimer.elapsed() < STUCKRECORD_TIMEOUT) return false;
+    stuckTimer.invalidate();
+
+    // clear the dropped range, it may wrap around the end of the ring
+    unsigned int size = stuckHead - tail;
+    unsigned int offset = tail % QueueSize;
+    if(size == 0 || size > (unsigned int) QueueSize) return false;
+    unsigned int first = qMin(size, (unsigned int) QueueSize - offset);
+    memset(ring() + offset, 0, first);
+    if(size > first) memset(ring(), 0, size - first);
+
+    atomicStore(&h->tail, (int) stuckHead);
+    QBasicAtomicInt *overflows = reinterpret_cast<QBasicAtomicInt *>(&h->overflows);
+    overflows->fetchAndAddOrdered(1);
+    return true;
+}
+
+int AttachQueue::overflows()
+{
+    if(!isValid()) return 0;
+    return atomicLoad(&header()->overflows);
+}
+
+void AttachQueue::wait()
+{
+    semaphore->acquire();
+}
+
+void AttachQueue::wakeup()
+{
+    semaphore->release();
+}
+
+AttachQueueListener::AttachQueueListener(AttachQueue *queue, QObject *parent) : QThread(parent)
+{
+    thisQueue = queue;
+    running = true;
+}
+
+void AttachQueueListener::stop()
+{
+    running = false;
+    thisQueue->wakeup();
+    wait();
+}
+
+void AttachQueueListener::run()
+{
+    while(running) {
+        thisQueue->wait();
+        if(running) emit messagesAvailable();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *  This file is part of the caQtDM Framework, developed at the Paul Scherrer Institut,
+ *  Villigen, Switzerland
+ *
+ *  The caQtDM Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The caQtDM Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with the caQtDM Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Copyright (c) 2010 - 2014
+ *
+ *  Author:
+ *    Anton Mezger
+ *  Contact details:
+ *    anton.mezger@psi.ch
+ */
+
+#ifndef ATTACHQUEUE_H
+#define ATTACHQUEUE_H
+
+#include <QSharedMemory>
+#include <QSystemSemaphore>
+#include <QThread>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+/*
+ * multi producer, single consumer queue of variable length messages in shared memory;
+ * producers reserve space with an atomic head, the consumer frees it with an atomic tail
+ * and sleeps on a system semaphore that producers release after writing a message
+ */
+class AttachQueue
+{
+public:
+    enum {QueueSize = 262144, MaxMessageSize = 65536};
+
+    AttachQueue(QSharedMemory *memory, const QString &key);
+    ~AttachQueue();
+
+    static int memorySize();
+    bool isValid();
+    void initialize();
+    bool send(const QByteArray &message, int timeout = 2000);
+    bool receive(QByteArray &message);
+    int overflows();
+    void wait();
+    void wakeup();
+
+private:
+    typedef struct _queueHeader {
+        int magic;
+        int capacity;
+        int head;       // bytes reserved by producers
+        int tail;       // bytes freed by the consumer
+        int overflows;  // messages that did not fit
+        int reserved;
+    } queueHeader;
+
+    bool tryEnqueue(const QByteArray &message, unsigned int *end);
+    bool dropStuckRecords(unsigned int tail);
+    queueHeader *header();
+    char *ring();
+
+    QSharedMemory *sharedMemory;
+    QSystemSemaphore *semaphore;
+    QString semaphoreKey;
+
+    // consumer side, a reserved record that never gets committed
+    unsigned int stuckTail;
+    unsigned int stuckHead;
+    QElapsedTimer stuckTimer;
+};
+
+/*
+ * waits on the queue semaphore and signals the gui thread
+ */
+class AttachQueueListener : public QThread
+{
+    Q_OBJECT
+
+public:
+    AttachQueueListener(AttachQueue *queue, QObject *parent = 0);
+    void stop();
+
+signals:
+    void messagesAvailable();
+
+protected:
+    void run();
+
+private:
+    AttachQueue *thisQueue;
+    volatile bool running;
+};
+
+#endif
@@ -212,6 +212,9 @@ int main(int argc, char *argv[])
                    "  [-cs defaultcontrolsystempluginname]\n"
                    "  [-option \"xxx=aaa,yyy=bbb, ...\"] options for cs plugins,\n"
                    "  \t e.g. -option \"updatetype=direct\" will set the updatetype to Direct\n"
+                   "  \t framerate=<Hz> limits the repaints of each display (default 50, 0 = no limit)\n"
+                   "  \t framestatistics=true prints frame rates and paint times every 5 seconds\n"
+                   "  \t updatestatistics=true shows the widget update time of each class in the message window\n"
                    "  \t options for bsread:\n "
                    "  \t\t bsmodulo,bsoffset,\n"
                    "  \t\t bsinconsistency(drop|keep-as-is|adjust-individual|adjust-global),\n"
@@ -33,6 +33,7 @@ bool HTTPCONFIGURATOR = false;
   #pragma comment (lib, "Psapi.lib")
 #endif
 #include "searchfile.h"
+#include "imageframecache.h"
 
 #include <QtGui>
 
@@ -203,6 +204,10 @@ FileOpenWindow::FileOpenWindow(QMainWindow* parent,  QString filename, QString m
 
     caQtDM_TimeOutEnabled = false;
 
+    attachQueue = (AttachQueue *) 0;
+    attachListener = (AttachQueueListener *) 0;
+    attachOverflows = 0;
+
     qDebug() <<  "caQtDM -- desktop size:" << qApp->desktop()->size();
 
     // Set Window Title without the whole path
@@ -327,30 +332,39 @@ FileOpenWindow::FileOpenWindow(QMainWindow* parent,  QString filename, QString m
             message.append(";");
             message.append(lastResizing);
             qDebug() << "send a message with file, macro and geometry to it and exit "<< message;
-            sendMessage(message);
+            attachQueue = new AttachQueue(&sharedMemory, uniqueKey);
+            bool sent = sendMessage(message);
+            if(!sent) {
+                if(!attachQueue->isValid()) {
+                    qDebug() << "caQtDM -- the running instance uses an incompatible message queue, request not passed";
+                } else {
+                    qDebug() << "caQtDM -- message queue of the running instance is full, request not passed";
+                }
+            }
+            delete attachQueue;
+            attachQueue = (AttachQueue *) 0;
             sharedMemory.detach();
-            qApp->exit(0);  // does not work here
-            exit(0);
+            qApp->exit(sent ? 0 : 1);  // does not work here
+            exit(sent ? 0 : 1);
         } else {
             qDebug() << "caQtDM -- another instance of caQtDM detected, but no attach specified ==> standalone";
         }
     // memory to be created
     } else {
         _isRunning = false;
-        // create shared memory with a default value to note that no message is available.
-        if (!sharedMemory.create(BlopSize * RingSize + 2 * sizeof(uint))) {
+        // create shared memory with an empty message queue
+        if (!sharedMemory.create(AttachQueue::memorySize())) {
             qDebug() << "caQtDM -- Unable to create shared memory:" << sharedMemory.errorString();
         } else {
-            int size =  BlopSize * RingSize + 2 * sizeof(uint);
-            QByteArray byteArray(size, '\0');
-            qDebug() << "caQtDM -- created shared memory with" << BlopSize * RingSize + 2 * sizeof(uint) << "bytes";
+            qDebug() << "caQtDM -- created shared memory with" << AttachQueue::memorySize() << "bytes";
+            attachQueue = new AttachQueue(&sharedMemory, uniqueKey);
             sharedMemory.lock();
-            char *to = (char*)sharedMemory.data();
-            const char *from = byteArray.data();
-            memcpy(to, from, qMin(sharedMemory.size(), byteArray.size()));
-            MSQ_init();
+            attachQueue->initialize();
             sharedMemory.unlock();
-            // start checking for messages of other instances.
+            // messages of other instances are signalled by the listener, the timer only catches lost wakeups
+            attachListener = new AttachQueueListener(attachQueue, this);
+            connect(attachListener, SIGNAL(messagesAvailable()), this, SLOT(checkForMessage()), Qt::QueuedConnection);
+            attachListener->start();
             timer = new QTimer(this);
             connect(timer, SIGNAL(timeout()), this, SLOT(checkForMessage()));
             timer->start(1000);
@@ -672,8 +686,6 @@ void FileOpenWindow::timerEvent(QTimerEvent *event)
     char asc[MAX_STRING_LENGTH];
     int countPV=0;
     int countNotConnected=0;
-    float highCount = 0.0;
-    QString highPV;
     int countDisplayed = 0;
     static int printIt = 0;
     static int timeout = 0;
@@ -684,6 +696,7 @@ void FileOpenWindow::timerEvent(QTimerEvent *event)
         if(caQtDM_TimeLeft <= 0) {
             QList<CaQtDM_Lib *> all = this->findChildren<CaQtDM_Lib *>();
             foreach(QWidget* widget, all) widget->close();
+            stopAttachListener();
             if (sharedMemory.isAttached()) sharedMemory.detach();
             qApp->exit(0);
         }
@@ -720,17 +733,11 @@ void FileOpenWindow::timerEvent(QTimerEvent *event)
         char msg[MAX_STRING_LENGTH];
         msg[0] = '\0';
 
-        for (int i=0; i < mutexKnobData->GetMutexKnobDataSize(); i++) {
-            knobData *kPtr = mutexKnobData->GetMutexKnobDataPtr(i);
-            if(kPtr->index != -1) {
-                if(!kPtr->edata.connected) {
-                    countNotConnected++;
-                } else {
-                    if(kPtr->edata.displayCount > 0) countDisplayed++;
-                }
-                countPV++;
-            }
-        }
+        knobStatistics statistics;
+        mutexKnobData->getStatistics(statistics);
+        countPV = statistics.countPV;
+        countNotConnected = statistics.countNotConnected;
+        countDisplayed = statistics.countDisplayed;
 
         if(caQtDM_TimeOutEnabled) {
             char asc1[50];
@@ -742,14 +749,55 @@ void FileOpenWindow::timerEvent(QTimerEvent *event)
             strcat(asc, asc1);
         }
 
-        highCount = mutexKnobData->getHighestCountPV(highPV);
-        if(highCount != 0.0) {
+        if(statistics.highestCountPerSecond != 0.0) {
             snprintf(msg, MAX_STRING_LENGTH, "%s - PV=%d (%d NC), %d Monitors/s, %d Displays/s, highest=%s with %.1f Monitors/s ", asc, countPV, countNotConnected,
-                      mutexKnobData->getMonitorsPerSecond(), mutexKnobData->getDisplaysPerSecond(), qasc(highPV), highCount);
+                      statistics.monitorsPerSecond, statistics.displaysPerSecond, qasc(statistics.highestPV), statistics.highestCountPerSecond);
         } else {
             strcpy(msg, asc);
         }
-        statusBar()->showMessage(msg);
+
+        // statistics provided by the plugins
+        QString statusMessage(msg);
+        if(statistics.pluginMonitorsPerSecond.count() > 1) {
+            QStringList rates;
+            QMapIterator<QString, int> i(statistics.pluginMonitorsPerSecond);
+            while (i.hasNext()) {
+                i.next();
+                if(i.value() > 0) rates.append(QString("%1 %2/s").arg(i.key()).arg(i.value()));
+            }
+            if(rates.count() > 1) statusMessage.append("(" + rates.join(", ") + ")");
+        }
+
+        // the widget classes that took most of the update time
+        if(!statistics.classUpdateMsPerSecond.isEmpty()) {
+            QMultiMap<float, QString> byCost;
+            QMapIterator<QString, float> i(statistics.classUpdateMsPerSecond);
+            while (i.hasNext()) {
+                i.next();
+                if(i.value() >= 0.1) byCost.insert(i.value(), i.key());
+            }
+            QStringList costs;
+            QMapIterator<float, QString> j(byCost);
+            j.toBack();
+            while (j.hasPrevious() && costs.count() < 3) {
+                j.previous();
+                costs.append(QString("%1 %2ms/s (%3/s)").arg(j.value()).arg(j.key(), 0, 'f', 1).arg(statistics.classUpdatesPerSecond.value(j.value())));
+            }
+            if(!costs.isEmpty()) statusMessage.append(", updates: " + costs.join(", "));
+        }
+        if(!interfaces.isEmpty()) {
+            QMapIterator<QString, ControlsInterface *> i(interfaces);
+            while (i.hasNext()) {
+                i.next();
+                QString statistics;
+                ControlsInterface *plugininterface = i.value();
+                if(plugininterface != (ControlsInterface *) 0 && plugininterface->pvGetStatistics(statistics)) {
+                    statusMessage.append(", ");
+                    statusMessage.append(statistics);
+                }
+            }
+        }
+        statusBar()->showMessage(statusMessage);
     }
 
     // we wanted a print, do it when acquired, then exit
@@ -795,6 +843,7 @@ void FileOpenWindow::timerEvent(QTimerEvent *event)
     // we want to ask with timeout if the application has to be closed. 23-jan-2013 no yust exit (in case of tablet do not exit)
 #ifndef MOBILE
     if(this->findChildren<CaQtDM_Lib *>().count() <= 0 && userClose) {
+        stopAttachListener();
         if (sharedMemory.isAttached()) sharedMemory.detach();
         qApp->exit(0);
     } else if(this->findChildren<CaQtDM_Lib *>().count() > 0) {
@@ -1046,9 +1095,23 @@ void FileOpenWindow::Callback_OpenNewFile(const QString& inputFile, const QStrin
     if(filefunction.lastInfo().length() > 0) messageWindow->postMsgEvent(QtWarningMsg, (char*) qasc(filefunction.lastInfo()));
     if(filefunction.lastError().length() > 0)  messageWindow->postMsgEvent(QtCriticalMsg, (char*) qasc(filefunction.lastError()));
 
+    // and fetch what this file includes in parallel, so that the includes do not download one after the other
+    filefunction.prefetchDependencies(FileName);
+    if(filefunction.lastInfo().length() > 0) messageWindow->postMsgEvent(QtWarningMsg, (char*) qasc(filefunction.lastInfo()));
+    if(filefunction.lastError().length() > 0)  messageWindow->postMsgEvent(QtCriticalMsg, (char*) qasc(filefunction.lastError()));
+
     // open file
     searchFile *s = new searchFile(FileName);
     QString fileNameFound = s->findFile();
+
+    // no ui file, then a MEDM file will be converted in memory when loading
+    if(fileNameFound.isNull() && found3 == -1) {
+        QString adlName = FileName;
+        adlName.chop(3);
+        searchFile adl(adlName.append(".adl"));
+        fileNameFound = adl.findFile();
+    }
+
     if(fileNameFound.isNull()) {
         QString message = QString(FileName);
         message.append(" does not exist");
@@ -1144,6 +1207,7 @@ void FileOpenWindow::Callback_ActionExit()
         }
 
 // detach shared memory, delete pv container
+        stopAttachListener();
         if (sharedMemory.isAttached()) sharedMemory.detach();
         qApp->exit(0);
         //exit(0);
@@ -1207,6 +1271,9 @@ void FileOpenWindow::Callback_ActionReload()
     // block processing during reload
     mutexKnobData->BlockProcessing(true);
 
+    // images are decoded again from their files
+    ImageFrameCache::clear();
+
     // go through all windows, close them and reload them from files
     QList<QWidget *> all = this->findChildren<QWidget *>();
     foreach(QWidget* widget, all) {
@@ -1234,23 +1301,28 @@ void FileOpenWindow::Callback_ActionDirect() {
 
 void FileOpenWindow::checkForMessage()
 {
-     _blop element;
-
-    // check and remove message in shared memory
-    sharedMemory.lock();
-    element = MSQ_deQueue();
-    sharedMemory.unlock();
-    if(element.blop[0] == '\0') {
-        //qDebug() << "queue was empty, so do nothing";
-        return;  // no message, quit
-    }
-    QString message = QString::fromUtf8(element.blop); // get and split message
-    QStringList vars = message.split(";");
+    QByteArray element;
+
+    if(attachQueue == (AttachQueue *) 0) return;
 
-    //qDebug() << "received message=" << message;
-    //qDebug() << "vars" << vars.count() <<  vars;
+    // drain all messages that were queued by other instances
+    while(attachQueue->receive(element)) {
+        QString message = QString::fromUtf8(element.constData(), element.size()); // get and split message
+        QStringList vars = message.split(";");
 
-    if(vars.count() == 4) emit Callback_OpenNewFile(vars.at(0), vars.at(1), vars.at(2), vars.at(3));
+        //qDebug() << "received message=" << message;
+        //qDebug() << "vars" << vars.count() <<  vars;
+
+        if(vars.count() == 4) emit Callback_OpenNewFile(vars.at(0), vars.at(1), vars.at(2), vars.at(3));
+    }
+
+    int overflows = attachQueue->overflows();
+    if(overflows != attachOverflows) {
+        char asc[MAX_STRING_LENGTH];
+        snprintf(asc, MAX_STRING_LENGTH, "%d attach requests were lost, message queue was full or a sender died while queuing", overflows - attachOverflows);
+        messageWindow->postMsgEvent(QtWarningMsg, asc);
+        attachOverflows = overflows;
+    }
 }
 
 bool FileOpenWindow::isRunning()
@@ -1260,16 +1332,17 @@ bool FileOpenWindow::isRunning()
 
 bool FileOpenWindow::sendMessage(const QString &message)
 {
-    _blop element;
-    if (!_isRunning) return false;
-    QByteArray byteArray(message.toUtf8());
-    byteArray.append('\0');
-    const char *from = byteArray.data();
-    memcpy(element.blop, from, byteArray.size());
-    sharedMemory.lock();
-    MSQ_enQueue(element);
-    sharedMemory.unlock();
-    return true;
+    if (!_isRunning || attachQueue == (AttachQueue *) 0) return false;
+    return attachQueue->send(message.toUtf8());
+}
+
+void FileOpenWindow::stopAttachListener()
+{
+    if(attachListener != (AttachQueueListener *) 0) {
+        attachListener->stop();
+        delete attachListener;
+        attachListener = (AttachQueueListener *) 0;
+    }
 }
 
 /**
@@ -1333,18 +1406,13 @@ void FileOpenWindow::fillPVtable(int &countPV, int &countNotConnected, int &coun
         pvTable->setAlternatingRowColors(true);
     }
 
-    for (int i=0; i < mutexKnobData->GetMutexKnobDataSize(); i++) {
-        knobData *kPtr = mutexKnobData->GetMutexKnobDataPtr(i);
-        if(kPtr->index != -1) {
-            if(!kPtr->edata.connected) {
-                countNotConnected++;
-            } else {
-                if(kPtr->edata.displayCount > 0) countDisplayed++;
-            }
-            countPV++;
-        }
-    }
+    knobStatistics statistics;
+    mutexKnobData->getStatistics(statistics);
+    countPV += statistics.countPV;
+    countNotConnected += statistics.countNotConnected;
+    countDisplayed += statistics.countDisplayed;
 
+    // only the table needs the knobs themselves
     if(pvTable != (QTableWidget*) 0) {
         pvTable->setRowCount(countNotConnected);
         count = 0;
@@ -1352,6 +1420,8 @@ void FileOpenWindow::fillPVtable(int &countPV, int &countNotConnected, int &coun
             knobData *kPtr = mutexKnobData->GetMutexKnobDataPtr(i);
             if(kPtr->index != -1) {
                 if(!kPtr->edata.connected) {
+                    // channels may have disconnected since the statistics were taken
+                    if(count >= pvTable->rowCount()) pvTable->setRowCount(count + 1);
                     pvTable->setItem(count,0, new QTableWidgetItem(kPtr->pv));
                     pvTable->setItem(count,1, new QTableWidgetItem(kPtr->dispName));
                     pvTable->setItem(count,2, new QTableWidgetItem(kPtr->pluginName));
@@ -1360,6 +1430,7 @@ void FileOpenWindow::fillPVtable(int &countPV, int &countNotConnected, int &coun
                 }
             }
         }
+        pvTable->setRowCount(count);
         pvTable->resizeColumnsToContents();
         pvTable->horizontalHeader()->setStretchLastSection(true);
     }
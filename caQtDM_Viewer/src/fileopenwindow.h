@@ -55,6 +55,7 @@
 #include "mutexKnobData.h"
 #include "caqtdm_lib.h"
 #include "ui_main.h"
+#include "attachqueue.h"
 #include <stdio.h>
 
 #include "epicsExternals.h"
@@ -62,12 +63,6 @@
     int setenv(const char *name, const char *value, int overwrite);
 #endif
 
-#define RingSize 50
-#define BlopSize 4096
-    struct _blop {
-        char blop[BlopSize];
-    };
-
 #ifdef linux
 #  include <unistd.h>
 #endif
@@ -114,106 +109,6 @@
      void parseConfigFile(const QString &filename, QList<QString> &urls, QList<QString> &files);
      void saveConfigFile(const QString &filename, QList<QString> &urls, QList<QString> &files);
 
-
-     void MSQ_getPtrs(int &front, int &rear) {
-             if (!sharedMemory.isAttached()) return;
-             int *ptr1 = (int*) sharedMemory.data();
-             front = *ptr1;
-             int *ptr2 = ptr1 + 1;
-             rear = *ptr2;
-         }
-
-         void MSQ_setPtrs(int front, int rear) {
-             if (!sharedMemory.isAttached()) return;
-             int *ptr1 = (int*) sharedMemory.data();
-             *ptr1 = front;
-             int *ptr2 = ptr1 + 1;
-             *ptr2 = rear;
-         }
-
-         void MSQ_init() {
-             MSQ_setPtrs(-1, -1);
-         }
-
-         bool MSQ_isFull() {
-             MSQ_getPtrs(front, rear);
-
-             if(front == 0 && rear == RingSize - 1){
-                 return true;
-             }
-             if(front == rear + 1) {
-                 return true;
-             }
-             return false;
-         }
-
-         bool MSQ_isEmpty() {
-             MSQ_getPtrs(front, rear);
-
-             if(front == -1) return true;
-             else return false;
-         }
-
-         void MSQ_enQueue(_blop element) {
-             MSQ_getPtrs(front, rear);
-
-             if(MSQ_isFull()){
-                 qDebug() << "caQtDM -- attach queue is full";
-             } else {
-                 if(front == -1) front = 0;
-                 rear = (rear + 1) % RingSize;
-                 char *ptr = (char*) (((char*) sharedMemory.data()) + (rear * BlopSize) + 2*sizeof(int));
-                 memcpy((char*) ptr, &element.blop[0], BlopSize);
-                 //qDebug() << "Inserted @" << rear;
-                 MSQ_setPtrs(front, rear);
-             }
-             return;
-         }
-
-         _blop MSQ_deQueue() {
-             _blop element;
-
-             MSQ_getPtrs(front, rear);
-             //qDebug() << front << rear;
-
-             if(MSQ_isEmpty()){
-                 return(empty);
-             } else {
-                 char *ptr = (char*) (((char*) sharedMemory.data()) + (front * BlopSize) + 2*sizeof(int));
-                 memcpy(element.blop, (char*) ptr, BlopSize);
-                 if(front == rear) {
-                     front = -1;
-                     rear = -1;
-                 }
-                 else {
-                     front=(front+1) % RingSize;
-                 }
-                 MSQ_setPtrs(front, rear);
-                 return(element);
-             }
-         }
-
-         void MSQ_display()
-         {
-             int i = 0;
-
-             if(MSQ_isEmpty()) {
-                 qDebug() << "Empty Queue";
-             } else {
-
-                 MSQ_getPtrs(front, rear);
-
-                 qDebug() << "Front -> " << front;
-                 for(i=front; i!=rear;i=(i+1) % RingSize ) {
-                     char *ptr = (char*) (((char*) sharedMemory.data()) + (i * BlopSize) + 2 * sizeof(int));
-                     qDebug() << i << ptr;
-                 }
-                 char *ptr = (char*) (((char*) sharedMemory.data()) + (i * BlopSize) + 2 * sizeof(int));
-                 qDebug() << i << ptr;
-                 qDebug() << "Rear -> " << rear;
-             }
-         }
-
  private slots:
      void Callback_ActionTimed();
      void Callback_ActionDirect();
@@ -241,6 +136,7 @@ public slots:
              QFile::remove(lastFile);
          }
 #endif
+         stopAttachListener();
          sharedMemory.detach();
      }
      void nextWindow();
@@ -262,6 +158,7 @@ private:
      void FlushAllInterfaces();
      void TerminateAllInterfaces();
      void reload(QWidget *w);
+     void stopAttachListener();
      QMainWindow *lastWindow;
      QString lastMacro, lastFile, lastGeometry, lastResizing;
      Ui::MainWindow ui;
@@ -297,9 +194,10 @@ private:
      bool caQtDM_TimeOutEnabled;
 
      QMutex mutex;
-     int front;
-     int rear;
-     _blop empty;
+
+     AttachQueue *attachQueue;
+     AttachQueueListener *attachListener;
+     int attachOverflows;
  };
 
  #endif